@@ -0,0 +1,87 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// shared helpers for the headless benchmarks
+
+class BenchTimer
+{
+public:
+    BenchTimer() { Reset(); }
+
+    inline void Reset() { Start = std::chrono::high_resolution_clock::now(); }
+
+    inline double ElapsedMs() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+    }
+
+private:
+    std::chrono::high_resolution_clock::time_point Start;
+};
+
+// one measurement, compare looks at the time per item so different run lengths still line up
+struct BenchResult
+{
+    std::string Name;
+    size_t Count = 0;
+    double Ms = 0;
+
+    inline double GetNsPerItem() const { return Count > 0 ? Ms * 1000000.0 / double(Count) : 0; }
+};
+
+// results that suites want kept, written out as JSON and checked against a saved baseline
+namespace BenchReport
+{
+    void Add(const char* name, size_t count, double ms);
+    const std::vector<BenchResult>& GetResults();
+
+    bool WriteJson(const char* fileName);
+
+    // reads back what WriteJson wrote
+    bool ReadJson(const char* fileName, std::vector<BenchResult>& results);
+
+    // prints every result next to its baseline, returns how many got slower by more than the threshold (0.1 is 10%)
+    int Compare(const std::vector<BenchResult>& baseline, double threshold);
+}
+
+void RunEcsBench(size_t maxCount);
+void RunSpatialIndexBench();
+void RunLightClusterBench();
+void RunMeshCacheBench();
+void RunMeshOptimizerBench();
+void RunShapePretransformBench();
+void RunWorldSnapshotBench();
+void RunWorldStreamingBench();
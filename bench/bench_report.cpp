@@ -0,0 +1,143 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace BenchReport
+{
+    std::vector<BenchResult> Results;
+
+    void Add(const char* name, size_t count, double ms)
+    {
+        BenchResult result;
+        result.Name = name;
+        result.Count = count;
+        result.Ms = ms;
+        Results.push_back(result);
+    }
+
+    const std::vector<BenchResult>& GetResults()
+    {
+        return Results;
+    }
+
+    bool WriteJson(const char* fileName)
+    {
+        FILE* file = fopen(fileName, "w");
+        if (file == nullptr)
+            return false;
+
+        // one result per line, ReadJson depends on it
+        fprintf(file, "{\n  \"results\": [\n");
+        for (size_t i = 0; i < Results.size(); i++)
+        {
+            const BenchResult& result = Results[i];
+            fprintf(file, "    { \"name\": \"%s\", \"count\": %zu, \"ms\": %.6f, \"ns_per_item\": %.3f }%s\n",
+                result.Name.c_str(), result.Count, result.Ms, result.GetNsPerItem(), (i + 1 < Results.size()) ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+
+        return fclose(file) == 0;
+    }
+
+    bool ReadJson(const char* fileName, std::vector<BenchResult>& results)
+    {
+        FILE* file = fopen(fileName, "r");
+        if (file == nullptr)
+            return false;
+
+        char line[512];
+        while (fgets(line, sizeof(line), file) != nullptr)
+        {
+            const char* start = strstr(line, "{ \"name\"");
+            if (start == nullptr)
+                continue;
+
+            char name[128] = { 0 };
+            size_t count = 0;
+            double ms = 0;
+            if (sscanf(start, "{ \"name\": \"%127[^\"]\", \"count\": %zu, \"ms\": %lf", name, &count, &ms) != 3)
+                continue;
+
+            BenchResult result;
+            result.Name = name;
+            result.Count = count;
+            result.Ms = ms;
+            results.push_back(result);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    int Compare(const std::vector<BenchResult>& baseline, double threshold)
+    {
+        int regressions = 0;
+
+        printf("Against the baseline, more than %.0f%% slower is flagged\n", threshold * 100);
+        for (const BenchResult& result : Results)
+        {
+            const BenchResult* base = nullptr;
+            for (const BenchResult& candidate : baseline)
+            {
+                if (candidate.Name == result.Name && candidate.Count == result.Count)
+                {
+                    base = &candidate;
+                    break;
+                }
+            }
+
+            if (base == nullptr || base->GetNsPerItem() <= 0)
+            {
+                printf("%-24s %8zu | %10.2f ns/item | not in the baseline\n", result.Name.c_str(), result.Count, result.GetNsPerItem());
+                continue;
+            }
+
+            double ratio = result.GetNsPerItem() / base->GetNsPerItem();
+            const char* verdict = "";
+            if (ratio > 1 + threshold)
+            {
+                verdict = " REGRESSION";
+                regressions++;
+            }
+            else if (ratio < 1 - threshold)
+            {
+                verdict = " faster";
+            }
+
+            printf("%-24s %8zu | %10.2f ns/item | baseline %10.2f | %+6.1f%%%s\n",
+                result.Name.c_str(), result.Count, result.GetNsPerItem(), base->GetNsPerItem(), (ratio - 1) * 100, verdict);
+        }
+
+        return regressions;
+    }
+}
@@ -0,0 +1,279 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "bench.h"
+
+#include "automover_component.h"
+#include "automover_system.h"
+#include "color_component.h"
+#include "transform_component.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // small counts repeat until they have covered about this many items, the best run is kept
+    constexpr size_t ItemsPerCase = 1000000;
+    constexpr int MinRepeats = 3;
+
+    constexpr int HierarchyDepths[] = { 1, 4, 16, 64 };
+
+    // keeps loops that only read from being optimized out
+    volatile uintptr_t Sink = 0;
+
+    int GetRepeats(size_t count)
+    {
+        return int(std::max(size_t(MinRepeats), ItemsPerCase / count));
+    }
+
+    // best of the repeats, setup and teardown are not timed
+    template<class SetupFunc, class WorkFunc, class TeardownFunc>
+    double Measure(size_t count, SetupFunc setup, WorkFunc work, TeardownFunc teardown)
+    {
+        double best = 0;
+        int repeats = GetRepeats(count);
+        for (int i = 0; i < repeats; i++)
+        {
+            setup();
+
+            BenchTimer timer;
+            work();
+            double ms = timer.ElapsedMs();
+
+            teardown();
+
+            if (i == 0 || ms < best)
+                best = ms;
+        }
+        return best;
+    }
+
+    void Report(const char* name, size_t count, double ms)
+    {
+        BenchReport::Add(name, count, ms);
+        printf("%-24s %8zu | %10.3f ms | %8.2f ns/item\n", name, count, ms, ms * 1000000.0 / double(count));
+    }
+
+    std::vector<uint64_t> Entities;
+    std::vector<TransformComponent*> Transforms;
+
+    void CreateEntities(size_t count)
+    {
+        Entities.resize(count);
+        for (uint64_t& entity : Entities)
+            entity = EntityManger::CreateEntity();
+    }
+
+    void ReleaseEntities()
+    {
+        for (uint64_t entity : Entities)
+            EntityManger::ReleaseEntity(entity);
+
+        Entities.clear();
+    }
+
+    void CreateTransforms(size_t count)
+    {
+        CreateEntities(count);
+
+        Transforms.resize(count);
+        for (size_t i = 0; i < count; i++)
+            Transforms[i] = ComponentManager::AddComponent<TransformComponent>(Entities[i]);
+    }
+
+    void DestroyEntities()
+    {
+        for (uint64_t entity : Entities)
+            ComponentManager::RemoveEntity(entity);
+
+        ReleaseEntities();
+        Transforms.clear();
+    }
+
+    void RunEntities(size_t count)
+    {
+        Report("entity_create", count, Measure(count, [] {}, [count] { CreateEntities(count); }, ReleaseEntities));
+        Report("entity_release", count, Measure(count, [count] { CreateEntities(count); }, ReleaseEntities, [] {}));
+    }
+
+    void RunComponents(size_t count)
+    {
+        Report("component_add", count, Measure(count,
+            [count] { CreateEntities(count); },
+            [count]
+            {
+                Transforms.resize(count);
+                for (size_t i = 0; i < count; i++)
+                    Transforms[i] = ComponentManager::AddComponent<TransformComponent>(Entities[i]);
+            },
+            DestroyEntities));
+
+        Report("component_get", count, Measure(count,
+            [count] { CreateTransforms(count); },
+            []
+            {
+                uintptr_t sum = 0;
+                for (uint64_t entity : Entities)
+                    sum += uintptr_t(ComponentManager::GetComponent<TransformComponent>(entity));
+                Sink = sum;
+            },
+            DestroyEntities));
+
+        Report("component_remove", count, Measure(count,
+            [count] { CreateTransforms(count); },
+            []
+            {
+                for (TransformComponent* transform : Transforms)
+                    ComponentManager::RemoveComponent<TransformComponent>(transform);
+            },
+            DestroyEntities));
+
+        Report("for_each_entity", count, Measure(count,
+            [count] { CreateTransforms(count); },
+            []
+            {
+                uintptr_t sum = 0;
+                ComponentManager::DoForEachEntity<TransformComponent>([&sum](TransformComponent* transform) { sum += transform->EntityId; });
+                Sink = sum;
+            },
+            DestroyEntities));
+
+        // the world a removal sees in the sample, a transform and a color on every entity
+        Report("remove_entity", count, Measure(count,
+            [count]
+            {
+                CreateTransforms(count);
+                for (TransformComponent* transform : Transforms)
+                    ComponentManager::AddComponent<ColorComponent>(transform);
+            },
+            []
+            {
+                for (uint64_t entity : Entities)
+                    ComponentManager::RemoveEntity(entity);
+            },
+            DestroyEntities));
+    }
+
+    void RunMovers(size_t count)
+    {
+        std::vector<AutoMoverComponent*> movers;
+
+        // movers are moved by AutoMoverSystem, ComponentManager::Update only runs components that ask for it
+        Report("mover_update", count, Measure(count,
+            [count, &movers]
+            {
+                CreateTransforms(count);
+
+                movers.resize(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    movers[i] = ComponentManager::AddComponent<AutoMoverComponent>(Transforms[i]);
+                    movers[i]->AngularSpeed.z = 90;
+                    movers[i]->LinearSpeed.y = 1;
+                }
+            },
+            []
+            {
+                ComponentManager::Update();
+                AutoMoverSystem::Update(1.0f / 60.0f);
+            },
+            [&movers]
+            {
+                // the system's packed list swaps the last mover into a removed slot, taking the first then the rest from the back
+                // finds every mover at the front so the teardown stays linear
+                if (!movers.empty())
+                    ComponentManager::RemoveComponent<AutoMoverComponent>(movers[0]);
+                for (size_t i = movers.size(); i-- > 1;)
+                    ComponentManager::RemoveComponent<AutoMoverComponent>(movers[i]);
+
+                movers.clear();
+                DestroyEntities();
+            }));
+    }
+
+    // chains of a fixed depth, every root moves and then every world matrix is refreshed parents first
+    void RunHierarchy(size_t count, int depth)
+    {
+        std::string name = "hierarchy_depth_" + std::to_string(depth);
+
+        Report(name.c_str(), count, Measure(count,
+            [count, depth]
+            {
+                CreateTransforms(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (i % depth != 0)
+                        Transforms[i - 1]->AddChild(Transforms[i]);
+                }
+
+                TransformHierarchy::Compact();
+            },
+            [count, depth]
+            {
+                for (size_t i = 0; i < count; i += depth)
+                    Transforms[i]->SetPosition(float(i), 1, 0);
+
+                uintptr_t versions = 0;
+                for (size_t i = 0; i < count; i += depth)
+                {
+                    for (TransformComponent* transform : Transforms[i]->GetSubtree())
+                    {
+                        transform->GetWorldMatrix();
+                        versions += transform->GetWorldVersion();
+                    }
+                }
+                Sink = versions;
+            },
+            DestroyEntities));
+    }
+}
+
+void RunEcsBench(size_t maxCount)
+{
+    printf("ECS core operations, best of several runs\n");
+
+    // the mover system only sees movers added after its setup
+    AutoMoverSystem::Setup();
+
+    for (size_t count : { size_t(1000), size_t(10000), size_t(100000), size_t(1000000) })
+    {
+        if (count > maxCount)
+            break;
+
+        RunEntities(count);
+        RunComponents(count);
+        RunMovers(count);
+
+        for (int depth : HierarchyDepths)
+            RunHierarchy(count, depth);
+    }
+}
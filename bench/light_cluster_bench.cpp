@@ -0,0 +1,141 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include "light_clusters.h"
+
+#include "raymath.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr int BinFrames = 50;
+
+    constexpr int CheckPoints = 2000;
+
+    // every light that reaches a point in view has to be in that point's cluster, or shading would drop it
+    size_t CountMissedLights(const LightClusterGrid& grid, const Camera3D& camera, float aspect, const std::vector<ClusterLight>& lights, std::mt19937& rng)
+    {
+        Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+        float tanHalfY = tanf(camera.fovy * 0.5f * DEG2RAD);
+        float tanHalfX = tanHalfY * aspect;
+
+        std::vector<Vector3> centers;
+        for (const ClusterLight& light : lights)
+            centers.push_back(Vector3Transform(light.Position, view));
+
+        std::uniform_real_distribution<float> ndc(-0.999f, 0.999f);
+        std::uniform_real_distribution<float> depth(0.1f, 300.0f);
+
+        const std::vector<uint32_t>& table = grid.GetClusterTable();
+        const std::vector<uint32_t>& indices = grid.GetLightIndices();
+
+        size_t missed = 0;
+        for (int i = 0; i < CheckPoints; i++)
+        {
+            float x = ndc(rng), y = ndc(rng), d = depth(rng);
+            Vector3 point = { x * d * tanHalfX, y * d * tanHalfY, -d };
+
+            int tileX = int((x + 1) * 0.5f * grid.GetTilesX());
+            int tileY = int((y + 1) * 0.5f * grid.GetTilesY());
+            size_t cluster = grid.GetClusterIndex(tileX, tileY, grid.GetSlice(d));
+
+            std::vector<bool> listed(lights.size(), false);
+            for (uint32_t j = 0; j < table[cluster * 2 + 1]; j++)
+                listed[indices[table[cluster * 2] + j]] = true;
+
+            for (size_t light = 0; light < lights.size(); light++)
+            {
+                if (!listed[light] && Vector3Distance(point, centers[light]) < lights[light].Radius)
+                    missed++;
+            }
+        }
+
+        return missed;
+    }
+
+    void RunSize(size_t count)
+    {
+        std::mt19937 rng(1234);
+
+        // lights spread over a ground plane like the sample scene, the camera looks across it
+        std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> height(0.0f, 20.0f);
+        std::uniform_real_distribution<float> radius(3.0f, 15.0f);
+
+        std::vector<ClusterLight> lights(count);
+        for (ClusterLight& light : lights)
+        {
+            light.Position = Vector3{ position(rng), position(rng), height(rng) };
+            light.Radius = radius(rng);
+        }
+
+        Camera3D camera = { 0 };
+        camera.position = Vector3{ 0, -220, 40 };
+        camera.target = Vector3{ 0, 0, 0 };
+        camera.up = Vector3{ 0, 0, 1 };
+        camera.fovy = 45;
+
+        LightClusterGrid grid;
+        grid.Setup();
+        grid.SetView(camera, 16.0f / 9.0f, 1.0f, 1000.0f);
+        grid.Bin(lights);
+
+        BenchTimer timer;
+        for (int frame = 0; frame < BinFrames; frame++)
+        {
+            // a small orbit so the view matrix changes but the projection does not
+            float angle = frame * 0.01f;
+            camera.position = Vector3{ sinf(angle) * 220, -cosf(angle) * 220, 40 };
+            grid.SetView(camera, 16.0f / 9.0f, 1.0f, 1000.0f);
+            grid.Bin(lights);
+        }
+        double binMs = timer.ElapsedMs() / BinFrames;
+
+        BenchReport::Add("light_bin", count, binMs);
+
+        size_t assignments = grid.GetLightIndices().size();
+        size_t missed = CountMissedLights(grid, camera, 16.0f / 9.0f, lights, rng);
+
+        printf("%8zu | bin %8.3f ms/frame | %zu clusters | %8zu assignments | max %4u per cluster | %zu missed at %d sample points\n",
+            count, binMs, grid.GetClusterCount(), assignments, grid.GetMaxLightsPerCluster(), missed, CheckPoints);
+    }
+}
+
+void RunLightClusterBench()
+{
+    printf("LightClusterGrid point light binning cost\n");
+
+    for (size_t count : { size_t(1000), size_t(10000) })
+        RunSize(count);
+}
@@ -0,0 +1,150 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// usage: bench [suite] [--json FILE] [--compare BASELINE] [--threshold PERCENT] [--max N]
+// --compare exits with 1 when any result is slower than the baseline by more than the threshold, 20% by default
+
+namespace
+{
+    size_t MaxCount = 1000000;
+
+    struct Suite
+    {
+        const char* Name;
+        void (*Run)();
+    };
+
+    const Suite Suites[] =
+    {
+        { "ecs", [] { RunEcsBench(MaxCount); } },
+        { "spatial", RunSpatialIndexBench },
+        { "lights", RunLightClusterBench },
+        { "meshcache", RunMeshCacheBench },
+        { "meshopt", RunMeshOptimizerBench },
+        { "pretransform", RunShapePretransformBench },
+        { "snapshot", RunWorldSnapshotBench },
+        { "streaming", RunWorldStreamingBench },
+    };
+
+    const Suite* FindSuite(const char* name)
+    {
+        for (const Suite& suite : Suites)
+        {
+            if (strcmp(suite.Name, name) == 0)
+                return &suite;
+        }
+        return nullptr;
+    }
+
+    int Usage(const char* error)
+    {
+        if (error != nullptr)
+            printf("%s\n", error);
+
+        printf("usage: bench [suite] [--json FILE] [--compare BASELINE] [--threshold PERCENT] [--max N]\n");
+        printf("suites:");
+        for (const Suite& suite : Suites)
+            printf(" %s", suite.Name);
+        printf("\n");
+
+        return error != nullptr ? 1 : 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // optionally run a single suite by name
+    const Suite* only = nullptr;
+    const char* jsonFile = nullptr;
+    const char* baselineFile = nullptr;
+    double threshold = 0.2;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+            return Usage(nullptr);
+
+        if (arg[0] == '-')
+        {
+            bool known = strcmp(arg, "--json") == 0 || strcmp(arg, "--compare") == 0 || strcmp(arg, "--threshold") == 0 || strcmp(arg, "--max") == 0;
+            if (!known)
+                return Usage((std::string("unknown option ") + arg).c_str());
+
+            if (i + 1 >= argc)
+                return Usage((std::string(arg) + " needs a value").c_str());
+
+            const char* value = argv[++i];
+            if (strcmp(arg, "--json") == 0)
+                jsonFile = value;
+            else if (strcmp(arg, "--compare") == 0)
+                baselineFile = value;
+            else if (strcmp(arg, "--threshold") == 0)
+                threshold = atof(value) / 100.0;
+            else
+                MaxCount = size_t(atoll(value));
+
+            continue;
+        }
+
+        if (only != nullptr)
+            return Usage("only one suite can be named");
+
+        only = FindSuite(arg);
+        if (only == nullptr)
+            return Usage((std::string("unknown suite ") + arg).c_str());
+    }
+
+    // read before running so a bad path doesn't waste the run
+    std::vector<BenchResult> baseline;
+    if (baselineFile != nullptr && !BenchReport::ReadJson(baselineFile, baseline))
+    {
+        printf("could not read the baseline %s\n", baselineFile);
+        return 1;
+    }
+
+    for (const Suite& suite : Suites)
+    {
+        if (only == nullptr || only == &suite)
+            suite.Run();
+    }
+
+    if (jsonFile != nullptr && !BenchReport::WriteJson(jsonFile))
+        printf("could not write %s\n", jsonFile);
+
+    if (baselineFile != nullptr && BenchReport::Compare(baseline, threshold) > 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include "mesh_cache.h"
+#include "mesh_files.h"
+#include "mesh_optimizer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string>
+
+namespace
+{
+    // a heightfield written out as obj text, standing in for a large imported model
+    bool WriteGridObj(const char* fileName, int cells)
+    {
+        FILE* file = fopen(fileName, "w");
+        if (file == nullptr)
+            return false;
+
+        int side = cells + 1;
+        for (int y = 0; y < side; y++)
+        {
+            for (int x = 0; x < side; x++)
+                fprintf(file, "v %f %f %f\n", float(x), float(y), sinf(x * 0.1f) * cosf(y * 0.1f));
+        }
+
+        for (int y = 0; y < side; y++)
+        {
+            for (int x = 0; x < side; x++)
+                fprintf(file, "vt %f %f\n", float(x) / cells, float(y) / cells);
+        }
+
+        fprintf(file, "vn 0 0 1\n");
+
+        for (int y = 0; y < cells; y++)
+        {
+            for (int x = 0; x < cells; x++)
+            {
+                int corner = y * side + x + 1;
+                fprintf(file, "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n", corner, corner, corner + 1, corner + 1, corner + side + 1, corner + side + 1, corner + side, corner + side);
+            }
+        }
+
+        return fclose(file) == 0;
+    }
+
+    // keeps the touch loop from being optimized out
+    volatile float TouchSink = 0;
+
+    // what the first use of the data costs once it has to come in from the mapping
+    float TouchMesh(const Mesh& mesh)
+    {
+        float sum = 0;
+        for (int i = 0; i < mesh.vertexCount * 3; i += 3)
+            sum += mesh.vertices[i] + mesh.normals[i];
+
+        return sum;
+    }
+
+    void RunSize(int cells)
+    {
+        std::string fileName = "mesh_cache_bench_" + std::to_string(cells) + ".obj";
+        std::string cacheName = MeshCache::GetCachePath(fileName.c_str());
+        remove(cacheName.c_str());
+
+        if (!WriteGridObj(fileName.c_str(), cells))
+        {
+            printf("could not write %s\n", fileName.c_str());
+            return;
+        }
+
+        Mesh mesh = { 0 };
+
+        BenchTimer timer;
+        bool parsed = MeshFiles::LoadMeshData(fileName.c_str(), mesh, false);
+        double coldMs = timer.ElapsedMs();
+
+        if (!parsed)
+        {
+            printf("could not parse %s\n", fileName.c_str());
+            remove(fileName.c_str());
+            return;
+        }
+
+        int triangles = mesh.triangleCount;
+        MeshFiles::UnloadMeshData(mesh);
+
+        // the first cached load misses and writes the cache file
+        timer.Reset();
+        MeshFiles::LoadMeshData(fileName.c_str(), mesh, true);
+        double writeMs = timer.ElapsedMs();
+        MeshFiles::UnloadMeshData(mesh);
+
+        timer.Reset();
+        bool mapped = MeshFiles::LoadMeshData(fileName.c_str(), mesh, true) && MeshCache::IsMapped(mesh);
+        double cachedMs = timer.ElapsedMs();
+
+        timer.Reset();
+        TouchSink = TouchMesh(mesh);
+        double touchMs = timer.ElapsedMs();
+
+        // the cached load above also reads and hashes the source to validate the cache, this is the mapping alone
+        uint64_t contentHash = 0;
+        {
+            unsigned int size = 0;
+            unsigned char* data = LoadFileData(fileName.c_str(), &size);
+            contentHash = MeshCache::HashBytes(data, size);
+            contentHash = MeshCache::HashBytes(&MeshOptimizer::Version, sizeof(MeshOptimizer::Version), contentHash);
+            UnloadFileData(data);
+        }
+        MeshFiles::UnloadMeshData(mesh);
+
+        timer.Reset();
+        MeshCache::Map(cacheName.c_str(), contentHash, mesh);
+        double mapMs = timer.ElapsedMs();
+        MeshFiles::UnloadMeshData(mesh);
+
+        BenchReport::Add("mesh_obj_parse", triangles, coldMs);
+        BenchReport::Add("mesh_cache_write", triangles, writeMs);
+        BenchReport::Add("mesh_cache_load", triangles, cachedMs);
+        BenchReport::Add("mesh_cache_map", triangles, mapMs);
+        BenchReport::Add("mesh_first_touch", triangles, touchMs);
+
+        printf("%9d tris | cold parse %9.2f ms | parse + write cache %9.2f ms | cached %8.2f ms (%s, map alone %.3f ms) + first touch %7.2f ms | %.1fx\n",
+            triangles, coldMs, writeMs, cachedMs, mapped ? "mapped" : "not mapped", mapMs, touchMs, coldMs / (cachedMs + touchMs));
+
+        remove(fileName.c_str());
+        remove(cacheName.c_str());
+    }
+}
+
+void RunMeshCacheBench()
+{
+    printf("Mesh startup cost, obj parsing against the mapped binary cache\n");
+
+    for (int cells : { 128, 512, 1024 })
+        RunSize(cells);
+}
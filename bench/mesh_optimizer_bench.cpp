@@ -0,0 +1,177 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include "mesh_files.h"
+#include "mesh_optimizer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // an indexed heightfield in row order, the way a generator would emit it
+    void BuildGrid(Mesh& mesh, int side, bool shuffle)
+    {
+        mesh = Mesh{ 0 };
+        mesh.vertexCount = side * side;
+        mesh.triangleCount = (side - 1) * (side - 1) * 2;
+        mesh.vertices = static_cast<float*>(RL_MALLOC(sizeof(float) * 3 * mesh.vertexCount));
+        mesh.normals = static_cast<float*>(RL_MALLOC(sizeof(float) * 3 * mesh.vertexCount));
+        mesh.indices = static_cast<unsigned short*>(RL_MALLOC(sizeof(unsigned short) * 3 * mesh.triangleCount));
+
+        for (int y = 0; y < side; y++)
+        {
+            for (int x = 0; x < side; x++)
+            {
+                int v = y * side + x;
+                float height = sinf(x * 0.1f) * cosf(y * 0.1f);
+
+                mesh.vertices[v * 3 + 0] = float(x);
+                mesh.vertices[v * 3 + 1] = height;
+                mesh.vertices[v * 3 + 2] = float(y);
+
+                float length = sqrtf(1.0f + height * height);
+                mesh.normals[v * 3 + 0] = -height / length;
+                mesh.normals[v * 3 + 1] = 1.0f / length;
+                mesh.normals[v * 3 + 2] = 0;
+            }
+        }
+
+        std::vector<int> order((side - 1) * (side - 1));
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = int(i);
+
+        // stands in for an exporter that writes faces in no useful order
+        if (shuffle)
+        {
+            std::mt19937 rng(1234);
+            std::shuffle(order.begin(), order.end(), rng);
+        }
+
+        unsigned short* index = mesh.indices;
+        for (int cell : order)
+        {
+            int x = cell % (side - 1);
+            int y = cell / (side - 1);
+            unsigned short corner = (unsigned short)(y * side + x);
+
+            *index++ = corner;
+            *index++ = (unsigned short)(corner + side);
+            *index++ = (unsigned short)(corner + 1);
+
+            *index++ = (unsigned short)(corner + 1);
+            *index++ = (unsigned short)(corner + side);
+            *index++ = (unsigned short)(corner + side + 1);
+        }
+    }
+
+    // triangle soup straight from the obj parser, as the importer sees it
+    bool BuildObj(Mesh& mesh, int cells)
+    {
+        std::string text;
+        char line[128];
+
+        int side = cells + 1;
+        for (int y = 0; y < side; y++)
+        {
+            for (int x = 0; x < side; x++)
+            {
+                snprintf(line, sizeof(line), "v %d %f %d\nvn 0 1 0\n", x, sinf(x * 0.1f) * cosf(y * 0.1f), y);
+                text += line;
+            }
+        }
+
+        for (int y = 0; y < cells; y++)
+        {
+            for (int x = 0; x < cells; x++)
+            {
+                int corner = y * side + x + 1;
+                snprintf(line, sizeof(line), "f %d//%d %d//%d %d//%d %d//%d\n", corner, corner, corner + side, corner + side,
+                    corner + side + 1, corner + side + 1, corner + 1, corner + 1);
+                text += line;
+            }
+        }
+
+        mesh = Mesh{ 0 };
+        return MeshFiles::ParseObj(text.c_str(), text.size(), mesh);
+    }
+
+    // optimizes in place and frees the mesh, the key names the result in the bench report
+    void Report(const char* name, const char* key, Mesh& mesh)
+    {
+        MeshOptimizer::Report report;
+
+        BenchTimer timer;
+        MeshOptimizer::Optimize(mesh, MeshOptimizer::Options(), &report);
+        double optimizeMs = timer.ElapsedMs();
+        BenchReport::Add(key, size_t(report.Before.TriangleCount), optimizeMs);
+
+        printf("%-20s | %6d tris | ACMR %.3f -> %.3f | ATVR %.3f -> %.3f | verts %6d -> %6d | %7.2f ms%s\n", name, report.Before.TriangleCount,
+            report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR, report.Before.VertexCount, report.After.VertexCount,
+            optimizeMs, report.Indexed ? "" : " (not indexed)");
+
+        MeshOptimizer::QuantizedMesh quantized;
+        MeshOptimizer::QuantizeError error;
+        MeshOptimizer::Quantize(mesh, quantized, &error);
+
+        size_t floatBytes = size_t(mesh.vertexCount) * sizeof(float) * ((mesh.normals != nullptr) ? 6 : 3);
+        if (mesh.indices != nullptr)
+            floatBytes += size_t(mesh.triangleCount) * 3 * sizeof(unsigned short);
+
+        printf("%-20s | quantized %8zu -> %8zu bytes | max position error %.5f | max normal error %.2f deg\n", "",
+            floatBytes, quantized.GetBytes(), error.MaxPositionError, error.MaxNormalErrorDegrees);
+
+        MeshFiles::UnloadMeshData(mesh);
+    }
+}
+
+void RunMeshOptimizerBench()
+{
+    printf("Post transform cache misses before and after import optimization (FIFO %d)\n", MeshOptimizer::DefaultCacheSize);
+
+    Mesh mesh;
+
+    BuildGrid(mesh, 250, false);
+    Report("grid, row order", "meshopt_grid_rows", mesh);
+
+    BuildGrid(mesh, 250, true);
+    Report("grid, shuffled", "meshopt_grid_shuffled", mesh);
+
+    if (BuildObj(mesh, 128))
+        Report("obj, triangle soup", "meshopt_obj_u16", mesh);
+
+    if (BuildObj(mesh, 256))
+        Report("obj, too big for u16", "meshopt_obj_u32", mesh);
+}
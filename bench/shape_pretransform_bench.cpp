@@ -0,0 +1,166 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include "shape_batch_builder.h"
+
+#include "raymath.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // the unit cube raylib generates, 24 vertices and 36 indices
+    void BuildUnitBox(std::vector<float>& vertices, std::vector<float>& normals, std::vector<unsigned short>& indices, Mesh& mesh)
+    {
+        const Vector3 faceNormals[6] = { { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, -1, 0 }, { 1, 0, 0 }, { -1, 0, 0 } };
+
+        for (const Vector3& normal : faceNormals)
+        {
+            // two axes across the face
+            Vector3 u = (fabsf(normal.y) > 0) ? Vector3{ 1, 0, 0 } : Vector3{ 0, 1, 0 };
+            Vector3 v = Vector3CrossProduct(normal, u);
+
+            unsigned short first = (unsigned short)(vertices.size() / 3);
+            for (int corner = 0; corner < 4; corner++)
+            {
+                float su = (corner == 1 || corner == 2) ? 0.5f : -0.5f;
+                float sv = (corner >= 2) ? 0.5f : -0.5f;
+                Vector3 position = Vector3Add(Vector3Scale(normal, 0.5f), Vector3Add(Vector3Scale(u, su), Vector3Scale(v, sv)));
+
+                vertices.insert(vertices.end(), { position.x, position.y, position.z });
+                normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+            }
+
+            indices.insert(indices.end(), { first, (unsigned short)(first + 1), (unsigned short)(first + 2), first, (unsigned short)(first + 2), (unsigned short)(first + 3) });
+        }
+
+        mesh = Mesh{ 0 };
+        mesh.vertexCount = int(vertices.size() / 3);
+        mesh.triangleCount = int(indices.size() / 3);
+        mesh.vertices = vertices.data();
+        mesh.normals = normals.data();
+        mesh.indices = indices.data();
+    }
+
+    // what pre-transforming costs with the raymath helpers, one vertex at a time
+    void AppendScalar(const Mesh& unitMesh, const ShapeInstance* instances, size_t count, std::vector<float>& positions, std::vector<float>& normals, std::vector<Color>& colors)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const float* m = instances[i].Transform;
+            Matrix world = { m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15] };
+            Matrix normalMatrix = MatrixTranspose(MatrixInvert(world));
+
+            for (int corner = 0; corner < unitMesh.triangleCount * 3; corner++)
+            {
+                int v = unitMesh.indices[corner];
+
+                Vector3 position = Vector3Transform(Vector3{ unitMesh.vertices[v * 3 + 0], unitMesh.vertices[v * 3 + 1], unitMesh.vertices[v * 3 + 2] }, world);
+                Vector3 normal = Vector3Normalize(Vector3Transform(Vector3{ unitMesh.normals[v * 3 + 0], unitMesh.normals[v * 3 + 1], unitMesh.normals[v * 3 + 2] }, normalMatrix));
+
+                positions.insert(positions.end(), { position.x, position.y, position.z });
+                normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+                colors.push_back(instances[i].Tint);
+            }
+        }
+    }
+
+    void RunSize(const Mesh& unitMesh, size_t count)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-100, 100);
+        std::uniform_real_distribution<float> scale(0.25f, 2.0f);
+        std::uniform_real_distribution<float> angle(0, PI * 2);
+
+        std::vector<ShapeInstance> instances(count);
+        for (ShapeInstance& instance : instances)
+        {
+            Matrix world = MatrixMultiply(MatrixMultiply(MatrixScale(scale(rng), scale(rng), scale(rng)), MatrixRotate(Vector3Normalize(Vector3{ position(rng), position(rng), position(rng) }), angle(rng))),
+                MatrixTranslate(position(rng), position(rng), position(rng)));
+
+            float16 transform = MatrixToFloatV(world);
+            std::copy(transform.v, transform.v + 16, instance.Transform);
+            instance.Tint = Color{ uint8_t(rng()), uint8_t(rng()), uint8_t(rng()), 255 };
+        }
+
+        ShapeVertexStream stream;
+
+        // the first pass sizes the buffers, like the first frame would
+        stream.Append(unitMesh, instances.data(), count);
+
+        BenchTimer timer;
+        stream.Clear();
+        stream.Append(unitMesh, instances.data(), count);
+        double simdMs = timer.ElapsedMs();
+
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<Color> colors;
+        positions.reserve(size_t(stream.GetVertexCount()) * 3);
+        normals.reserve(size_t(stream.GetVertexCount()) * 3);
+        colors.reserve(size_t(stream.GetVertexCount()));
+
+        timer.Reset();
+        AppendScalar(unitMesh, instances.data(), count, positions, normals, colors);
+        double scalarMs = timer.ElapsedMs();
+
+        float positionError = 0;
+        float normalError = 0;
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            positionError = fmaxf(positionError, fabsf(positions[i] - stream.GetPositions()[i]));
+            normalError = fmaxf(normalError, fabsf(normals[i] - stream.GetNormals()[i]));
+        }
+
+        BenchReport::Add("pretransform_sse", count, simdMs);
+        BenchReport::Add("pretransform_scalar", count, scalarMs);
+
+        double verticesPerSecond = double(stream.GetVertexCount()) / (simdMs / 1000.0);
+        printf("%8zu boxes | %9d vertices | SSE %8.2f ms (%.0f M verts/s) | scalar %8.2f ms | %.1fx | max error position %.5f normal %.5f\n",
+            count, stream.GetVertexCount(), simdMs, verticesPerSecond / 1e6, scalarMs, scalarMs / simdMs, positionError, normalError);
+    }
+}
+
+void RunShapePretransformBench()
+{
+    printf("CPU pre-transform of unit shapes into a streaming vertex buffer\n");
+
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<unsigned short> indices;
+    Mesh box;
+    BuildUnitBox(vertices, normals, indices, box);
+
+    for (size_t count : { size_t(1000), size_t(10000), size_t(100000) })
+        RunSize(box, count);
+}
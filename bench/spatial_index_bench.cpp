@@ -0,0 +1,178 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include "dynamic_bvh.h"
+
+#include "raymath.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int UpdateFrames = 10;
+    constexpr int QueryCount = 1000;
+    constexpr int FrustumQueryCount = 100;
+
+    struct BenchObject
+    {
+        Vector3 Position;
+        float HalfSize;
+        int32_t Proxy;
+    };
+
+    BoundingBox GetBox(const BenchObject& object)
+    {
+        Vector3 half = { object.HalfSize, object.HalfSize, object.HalfSize };
+        return BoundingBox{ Vector3Subtract(object.Position, half), Vector3Add(object.Position, half) };
+    }
+
+    void RunSize(size_t count)
+    {
+        std::mt19937 rng(1234);
+
+        // keep the density the same at every size
+        float extent = cbrtf(float(count)) * 4.0f;
+        std::uniform_real_distribution<float> position(-extent * 0.5f, extent * 0.5f);
+        std::uniform_real_distribution<float> size(0.25f, 1.0f);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        std::vector<BenchObject> objects(count);
+        for (BenchObject& object : objects)
+        {
+            object.Position = Vector3{ position(rng), position(rng), position(rng) };
+            object.HalfSize = size(rng);
+        }
+
+        DynamicBVH tree;
+
+        BenchTimer timer;
+        for (size_t i = 0; i < count; i++)
+            objects[i].Proxy = tree.CreateProxy(GetBox(objects[i]), i);
+        double buildMs = timer.ElapsedMs();
+
+        // each frame 10% of the objects drift a little and 1% teleport
+        size_t treeChanges = 0;
+        timer.Reset();
+        for (int frame = 0; frame < UpdateFrames; frame++)
+        {
+            for (size_t i = frame % 10; i < count; i += 10)
+            {
+                BenchObject& object = objects[i];
+                if (i % 100 == 0)
+                    object.Position = Vector3{ position(rng), position(rng), position(rng) };
+                else
+                    object.Position = Vector3Add(object.Position, Vector3{ unit(rng) * 0.2f, unit(rng) * 0.2f, unit(rng) * 0.2f });
+
+                if (tree.MoveProxy(object.Proxy, GetBox(object)))
+                    treeChanges++;
+            }
+        }
+        double updateMs = timer.ElapsedMs() / UpdateFrames;
+
+        std::vector<uint64_t> results;
+        size_t resultCount = 0;
+
+        timer.Reset();
+        for (int i = 0; i < QueryCount; i++)
+        {
+            Vector3 center = { position(rng), position(rng), position(rng) };
+            results.clear();
+            tree.QueryBox(BoundingBox{ Vector3SubtractValue(center, 10), Vector3AddValue(center, 10) }, results);
+            resultCount += results.size();
+        }
+        double boxUs = timer.ElapsedMs() * 1000.0 / QueryCount;
+        double boxResults = double(resultCount) / QueryCount;
+
+        resultCount = 0;
+        timer.Reset();
+        for (int i = 0; i < QueryCount; i++)
+        {
+            results.clear();
+            tree.QuerySphere(Vector3{ position(rng), position(rng), position(rng) }, 10, results);
+            resultCount += results.size();
+        }
+        double sphereUs = timer.ElapsedMs() * 1000.0 / QueryCount;
+        double sphereResults = double(resultCount) / QueryCount;
+
+        resultCount = 0;
+        timer.Reset();
+        for (int i = 0; i < FrustumQueryCount; i++)
+        {
+            Camera3D camera = { 0 };
+            camera.position = Vector3{ position(rng), position(rng), position(rng) };
+            camera.target = Vector3Add(camera.position, Vector3{ unit(rng), unit(rng), unit(rng) });
+            camera.up = Vector3{ 0, 0, 1 };
+            camera.fovy = 45;
+
+            results.clear();
+            tree.QueryFrustum(FrustumFromCamera(camera, 16.0f / 9.0f, 0.01f, 100.0f), results);
+            resultCount += results.size();
+        }
+        double frustumUs = timer.ElapsedMs() * 1000.0 / FrustumQueryCount;
+        double frustumResults = double(resultCount) / FrustumQueryCount;
+
+        size_t hits = 0;
+        timer.Reset();
+        for (int i = 0; i < QueryCount; i++)
+        {
+            Ray ray = { Vector3{ position(rng), position(rng), position(rng) }, Vector3Normalize(Vector3{ unit(rng), unit(rng), unit(rng) }) };
+
+            DynamicBVH::RayHit hit;
+            if (tree.RayCastClosest(ray, extent, hit))
+                hits++;
+        }
+        double rayUs = timer.ElapsedMs() * 1000.0 / QueryCount;
+
+        // building and updating per object in the tree, the queries per query with the tree size in the name
+        std::string treeSize = std::to_string(count);
+        BenchReport::Add("bvh_build", count, buildMs);
+        BenchReport::Add("bvh_update", count, updateMs);
+        BenchReport::Add(("bvh_box_query_" + treeSize).c_str(), QueryCount, boxUs * QueryCount / 1000.0);
+        BenchReport::Add(("bvh_sphere_query_" + treeSize).c_str(), QueryCount, sphereUs * QueryCount / 1000.0);
+        BenchReport::Add(("bvh_frustum_query_" + treeSize).c_str(), FrustumQueryCount, frustumUs * FrustumQueryCount / 1000.0);
+        BenchReport::Add(("bvh_ray_cast_" + treeSize).c_str(), QueryCount, rayUs * QueryCount / 1000.0);
+
+        printf("%8zu | build %9.2f ms | update %8.3f ms/frame (%zu tree changes) | height %d\n", count, buildMs, updateMs, treeChanges / UpdateFrames, tree.GetHeight());
+        printf("         | box %8.2f us (%.1f) | sphere %8.2f us (%.1f) | frustum %8.2f us (%.1f) | ray %6.2f us (%zu hits)\n",
+            boxUs, boxResults, sphereUs, sphereResults, frustumUs, frustumResults, rayUs, hits);
+    }
+}
+
+void RunSpatialIndexBench()
+{
+    printf("DynamicBVH update and query cost\n");
+
+    for (size_t count : { size_t(10000), size_t(100000), size_t(1000000) })
+        RunSize(count);
+}
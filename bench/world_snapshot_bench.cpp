@@ -0,0 +1,147 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "bench.h"
+
+#include "world_snapshot.h"
+
+#include "automover_component.h"
+#include "color_component.h"
+#include "drawable_component.h"
+#include "transform_component.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // groups of four, a root with three children, every entity drawn as a colored shape and one in eight moving
+    std::vector<uint64_t> BuildWorld(size_t count)
+    {
+        std::vector<uint64_t> entities;
+        entities.reserve(count);
+
+        TransformComponent* root = nullptr;
+        for (size_t i = 0; i < count; i++)
+        {
+            TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+            transform->SetPosition(float(i % 1000), float(i / 1000), 0);
+            entities.push_back(transform->EntityId);
+
+            if (i % 4 == 0)
+                root = transform;
+            else
+                root->AddChild(transform);
+
+            ShapeComponent* shape = ComponentManager::AddComponent<ShapeComponent>(transform);
+            shape->ObjectShape = DrawShape(i % 4);
+            shape->ObjectSize = Vector3{ 1, 0.5f, 0.25f };
+            shape->MustGetComponent<ColorComponent>()->SetColor(Color{ uint8_t(i), uint8_t(i >> 8), uint8_t(i >> 16), 255 });
+
+            if (i % 8 == 0)
+                ComponentManager::AddComponent<AutoMoverComponent>(transform)->AngularSpeed.y = 90;
+        }
+
+        return entities;
+    }
+
+    void DestroyWorld(const std::vector<uint64_t>& entities)
+    {
+        for (uint64_t entity : entities)
+        {
+            ComponentManager::RemoveEntity(entity);
+            EntityManger::ReleaseEntity(entity);
+        }
+    }
+
+    void RunSize(size_t count)
+    {
+        std::string fileName = "world_snapshot_bench_" + std::to_string(count) + ".snapshot";
+
+        BenchTimer timer;
+        std::vector<uint64_t> entities = BuildWorld(count);
+        double buildMs = timer.ElapsedMs();
+
+        WorldSnapshot::Stats saved;
+        timer.Reset();
+        bool written = WorldSnapshot::Save(fileName.c_str(), &saved);
+        double saveMs = timer.ElapsedMs();
+
+        if (!written)
+        {
+            printf("could not write %s\n", fileName.c_str());
+            DestroyWorld(entities);
+            return;
+        }
+
+        // the map and validate step on its own, what a background thread would do
+        WorldSnapshot::Loader loader;
+        timer.Reset();
+        bool opened = loader.Open(fileName.c_str());
+        double openMs = timer.ElapsedMs();
+
+        WorldSnapshot::Stats loaded;
+        std::vector<uint64_t> loadedIds;
+        timer.Reset();
+        if (opened)
+        {
+            loader.Instantiate();
+            loaded = loader.GetStats();
+            loadedIds = loader.GetEntityIds();
+        }
+        double loadMs = timer.ElapsedMs();
+        loader.Close();
+
+        // the loaded copy lives next to the original, ids are handed out fresh so the two never collide
+        timer.Reset();
+        DestroyWorld(entities);
+        double destroyMs = timer.ElapsedMs();
+
+        BenchReport::Add("snapshot_build", count, buildMs);
+        BenchReport::Add("snapshot_save", count, saveMs);
+        BenchReport::Add("snapshot_open", count, openMs);
+        BenchReport::Add("snapshot_instantiate", count, loadMs);
+        BenchReport::Add("snapshot_destroy", count, destroyMs);
+
+        printf("%8zu entities | build by code %8.1f ms | save %7.1f ms | %6.1f MB (%.0f bytes/entity) | open %6.3f ms | instantiate %8.1f ms (%zu entities, %zu components%s) | destroy %7.1f ms\n",
+            count, buildMs, saveMs, saved.Bytes / (1024.0 * 1024.0), double(saved.Bytes) / count, openMs, loadMs, loaded.Entities, loaded.Components,
+            (loaded.Entities == saved.Entities && loaded.Components == saved.Components) ? "" : ", MISMATCH", destroyMs);
+
+        DestroyWorld(loadedIds);
+        remove(fileName.c_str());
+    }
+}
+
+void RunWorldSnapshotBench()
+{
+    printf("World snapshot save and load against building the same world in code\n");
+
+    for (size_t count : { size_t(10000), size_t(100000), size_t(1000000) })
+        RunSize(count);
+}
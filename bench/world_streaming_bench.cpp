@@ -0,0 +1,159 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "bench.h"
+
+#include "async_loader.h"
+#include "world_streaming.h"
+
+#include "color_component.h"
+#include "drawable_component.h"
+#include "transform_component.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr float CellSize = 16;
+    constexpr int CellsPerSide = 32;
+    constexpr int TreesPerCellSide = 16;
+
+    // the same two entity trees as the sample's forest, written out as cells and removed again
+    void WriteForest(const char* basePath)
+    {
+        std::vector<uint64_t> roots;
+        float spacing = CellSize / TreesPerCellSide;
+        for (int y = 0; y < CellsPerSide * TreesPerCellSide; y++)
+        {
+            for (int x = 0; x < CellsPerSide * TreesPerCellSide; x++)
+            {
+                TransformComponent* trunk = ComponentManager::AddComponent<TransformComponent>();
+                trunk->SetPosition((x + 0.5f) * spacing, (y + 0.5f) * spacing, 1);
+                ShapeComponent* shape = ComponentManager::AddComponent<ShapeComponent>(trunk);
+                shape->MustGetComponent<ColorComponent>()->SetColor(BROWN);
+
+                TransformComponent* crown = ComponentManager::AddComponent<TransformComponent>();
+                crown->SetPosition(0, 0, 1.5f);
+                trunk->AddChild(crown);
+                shape = ComponentManager::AddComponent<ShapeComponent>(crown);
+                shape->ObjectShape = DrawShape::Sphere;
+                shape->MustGetComponent<ColorComponent>()->SetColor(GREEN);
+
+                roots.push_back(trunk->EntityId);
+            }
+        }
+
+        WorldStreaming::SaveCells(basePath, CellSize, roots);
+
+        std::vector<uint64_t> entities;
+        for (uint64_t root : roots)
+        {
+            for (TransformComponent* node : ComponentManager::GetComponent<TransformComponent>(root)->GetSubtree())
+                entities.push_back(node->EntityId);
+        }
+        WorldStreaming::DestroyEntities(entities);
+    }
+
+    // flies a camera corner to corner at a cell every few frames and times each streaming update
+    // the report gets the total over all frames, the worst frame is too noisy to compare
+    void RunFlight(const char* basePath, size_t budget, const char* label, const char* key)
+    {
+        WorldStreaming::Setup(basePath);
+        WorldStreaming::SetFrameBudget(budget);
+
+        TransformComponent* camera = ComponentManager::AddComponent<TransformComponent>();
+
+        constexpr int framesPerCell = 8;
+        constexpr int frames = CellsPerSide * framesPerCell;
+
+        double totalMs = 0;
+        double worstMs = 0;
+        size_t peakEntities = 0;
+
+        for (int frame = 0; frame < frames; frame++)
+        {
+            float distance = (float(frame) / framesPerCell) * CellSize;
+            camera->SetPosition(distance, distance, 10);
+
+            BenchTimer timer;
+            AsyncLoader::Update();
+            WorldStreaming::Update(camera->EntityId);
+            double ms = timer.ElapsedMs();
+
+            totalMs += ms;
+            worstMs = std::max(worstMs, ms);
+            peakEntities = std::max(peakEntities, WorldStreaming::GetStats().Entities);
+
+            // stands in for the rest of the frame, the loader thread gets to open cells meanwhile
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+
+        BenchReport::Add(key, frames, totalMs);
+
+        printf("%-22s | %4d frames | average %6.3f ms | worst %7.3f ms | peak %6d entities streamed in\n",
+            label, frames, totalMs / frames, worstMs, int(peakEntities));
+
+        WorldStreaming::Shutdown();
+        ComponentManager::RemoveEntity(camera->EntityId);
+        EntityManger::ReleaseEntity(camera->EntityId);
+    }
+}
+
+void RunWorldStreamingBench()
+{
+    printf("World streaming, a camera flying across %dx%d cells of %d entities each\n", CellsPerSide, CellsPerSide, TreesPerCellSide * TreesPerCellSide * 2);
+
+    const char* basePath = "world_streaming_bench";
+    WriteForest(basePath);
+
+    AsyncLoader::Setup(1);
+
+    RunFlight(basePath, size_t(-1), "whole cells per frame", "streaming_whole_cells");
+    for (size_t budget : { 8000, 2000, 500 })
+    {
+        char label[64];
+        char key[64];
+        snprintf(label, sizeof(label), "budget %d records", int(budget));
+        snprintf(key, sizeof(key), "streaming_budget_%d", int(budget));
+        RunFlight(basePath, budget, label, key);
+    }
+
+    AsyncLoader::Shutdown();
+
+    for (int y = 0; y < CellsPerSide; y++)
+    {
+        for (int x = 0; x < CellsPerSide; x++)
+            remove(TextFormat("%s_%d_%d.snapshot", basePath, x, y));
+    }
+    remove(TextFormat("%s.cells", basePath));
+}
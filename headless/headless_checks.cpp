@@ -0,0 +1,729 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "headless_checks.h"
+
+#include "camera_component.h"
+#include "color_component.h"
+#include "drawable_component.h"
+#include "transform_component.h"
+
+#include "bounds.h"
+#include "fixed_step_runner.h"
+#include "job_system.h"
+#include "occlusion_buffer.h"
+#include "primitive_mesh_cache.h"
+#include "recording_render_backend.h"
+#include "render_commands.h"
+#include "render_system.h"
+#include "resource_manager.h"
+#include "shader_uniform_cache.h"
+#include "shape_batch_builder.h"
+#include "world_snapshot.h"
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+#include <vector>
+
+namespace HeadlessChecks
+{
+    namespace
+    {
+        bool Expect(bool condition, const char* check, const char* what)
+        {
+            if (!condition)
+                printf("headless check %s: %s\n", check, what);
+            return condition;
+        }
+
+        bool SameMatrix(const float* values, const Matrix& expected)
+        {
+            float16 flat = MatrixToFloatV(expected);
+            for (int i = 0; i < 16; i++)
+            {
+                if (fabsf(values[i] - flat.v[i]) > 1e-5f)
+                    return false;
+            }
+            return true;
+        }
+
+        bool SameMatrix(const Matrix& a, const Matrix& b)
+        {
+            return SameMatrix(MatrixToFloatV(a).v, b);
+        }
+
+        bool SameColor(Color a, Color b)
+        {
+            return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+        }
+
+        void RasterizeBounds(OcclusionBuffer& buffer, const BoundingBox& box)
+        {
+            Vector3 corners[8];
+            for (int i = 0; i < 8; i++)
+                corners[i] = Vector3{ (i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z };
+
+            buffer.RasterizeBox(corners);
+        }
+
+        // the eye at the origin looking down +y with z up, 60 degrees high and twice as wide
+        Camera3D GetCheckCamera()
+        {
+            Camera3D camera = { 0 };
+            camera.position = Vector3{ 0, 0, 0 };
+            camera.target = Vector3{ 0, 1, 0 };
+            camera.up = Vector3{ 0, 0, 1 };
+            camera.fovy = 60;
+            return camera;
+        }
+
+        constexpr float CheckAspect = 2.0f;
+        constexpr float CheckNear = 0.1f;
+        constexpr float CheckFar = 100.0f;
+
+        // shapes made for a check, removed again when it ends
+        class CheckScene
+        {
+        public:
+            ~CheckScene()
+            {
+                for (uint64_t entity : Entities)
+                {
+                    ComponentManager::RemoveEntity(entity);
+                    EntityManger::ReleaseEntity(entity);
+                }
+            }
+
+            ShapeComponent* AddShape(DrawShape shape, const Vector3& position, const Vector3& size)
+            {
+                TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+                transform->SetPosition(position.x, position.y, position.z);
+
+                ShapeComponent* drawable = ComponentManager::AddComponent<ShapeComponent>(transform);
+                drawable->ObjectShape = shape;
+                drawable->ObjectSize = size;
+                drawable->MustGetComponent<ColorComponent>()->SetColor(WHITE);
+
+                Entities.push_back(transform->EntityId);
+                Drawables.push_back(drawable);
+                return drawable;
+            }
+
+            // a camera with the default orientation, looking down -y
+            uint64_t AddCamera(const Vector3& position)
+            {
+                TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+                transform->SetPosition(position.x, position.y, position.z);
+                ComponentManager::AddComponent<CameraComponent>(transform);
+
+                Entities.push_back(transform->EntityId);
+                return transform->EntityId;
+            }
+
+            std::vector<Drawable3DComponent*> Drawables;
+
+        private:
+            std::vector<uint64_t> Entities;
+        };
+    }
+
+    bool ShapeBatches()
+    {
+        const char* name = "shape batches";
+        bool ok = true;
+
+        struct ShapeCase
+        {
+            DrawShape Shape;
+            Vector3 Size;
+            uint8_t LOD;
+            uint32_t Material;
+            RenderPipeline Pipeline;
+            Vector3 Position;
+            Color Tint;
+        };
+
+        // boxes of any size share a group, lod, material and pipeline split them
+        // cylinders only share a group when their taper rounds to the same size class
+        const ShapeCase cases[] =
+        {
+            { DrawShape::Box, { 1, 2, 3 }, 0, 0, RenderPipeline::Opaque, { 0, 0, 0 }, RED },
+            { DrawShape::Sphere, { 2, 1, 1 }, 0, 0, RenderPipeline::Opaque, { 5, 0, 0 }, GREEN },
+            { DrawShape::Box, { 4, 4, 4 }, 0, 0, RenderPipeline::Opaque, { 0, 5, 0 }, BLUE },
+            { DrawShape::Box, { 1, 1, 1 }, 1, 0, RenderPipeline::Opaque, { 0, 0, 5 }, WHITE },
+            { DrawShape::Box, { 1, 1, 1 }, 0, 7, RenderPipeline::Opaque, { 1, 1, 1 }, BLACK },
+            { DrawShape::Plane, { 10, 10, 0 }, 0, 0, RenderPipeline::DoubleSided, { 0, 0, -1 }, GRAY },
+            { DrawShape::Cylinder, { 1, 1, 2 }, 0, 0, RenderPipeline::Opaque, { -5, 0, 0 }, YELLOW },
+            { DrawShape::Cylinder, { 2, 2, 6 }, 0, 0, RenderPipeline::Opaque, { -5, 5, 0 }, ORANGE },
+            { DrawShape::Cylinder, { 0, 1, 2 }, 0, 0, RenderPipeline::Opaque, { -5, -5, 0 }, PURPLE },
+            { DrawShape::Box, { 2, 2, 2 }, 0, 0, RenderPipeline::Opaque, { 9, 9, 9 }, Color{ 10, 20, 30, 40 } },
+        };
+        constexpr size_t caseCount = sizeof(cases) / sizeof(cases[0]);
+
+        // box, sphere, box lod 1, box material 7, plane, cylinder, cone
+        constexpr size_t expectedGroups = 7;
+
+        ShapeBatchBuilder builder;
+        Matrix worlds[caseCount];
+        for (size_t i = 0; i < caseCount; i++)
+        {
+            const ShapeCase& shape = cases[i];
+            worlds[i] = MatrixMultiply(MatrixRotateZ(float(i) * 0.3f), MatrixTranslate(shape.Position.x, shape.Position.y, shape.Position.z));
+            builder.Add(shape.Shape, shape.Size, shape.LOD, worlds[i], shape.Tint, shape.Material, shape.Pipeline);
+        }
+        builder.Build();
+
+        const std::vector<ShapeBatchBuilder::Group>& groups = builder.GetGroups();
+        const std::vector<ShapeInstance>& instances = builder.GetInstances();
+
+        ok &= Expect(groups.size() == expectedGroups, name, TextFormat("%d groups, expected %d", int(groups.size()), int(expectedGroups)));
+        ok &= Expect(instances.size() == caseCount, name, TextFormat("%d instances, expected %d", int(instances.size()), int(caseCount)));
+        if (!ok)
+            return false;
+
+        // the groups tile the instance list in order
+        size_t next = 0;
+        for (const ShapeBatchBuilder::Group& group : groups)
+        {
+            ok &= Expect(group.First == next && group.Count > 0, name, "group ranges are not contiguous");
+            next = group.First + group.Count;
+        }
+        ok &= Expect(next == instances.size(), name, "group ranges do not cover every instance");
+
+        // every shape lands in the group with its key, after the ones added before it, with the unit scale folded into its matrix
+        std::vector<size_t> used(groups.size(), 0);
+        for (size_t i = 0; i < caseCount; i++)
+        {
+            const ShapeCase& shape = cases[i];
+            uint16_t sizeClass = ShapeBatch::GetSizeClass(shape.Shape, shape.Size);
+
+            size_t found = groups.size();
+            for (size_t g = 0; g < groups.size(); g++)
+            {
+                const ShapeBatchBuilder::Group& group = groups[g];
+                if (group.Shape == shape.Shape && group.SizeClass == sizeClass && group.LOD == shape.LOD && group.Material == shape.Material && group.Pipeline == shape.Pipeline)
+                    found = g;
+            }
+
+            if (!Expect(found < groups.size(), name, TextFormat("shape %d has no group", int(i))))
+            {
+                ok = false;
+                continue;
+            }
+
+            const ShapeInstance& instance = instances[groups[found].First + used[found]++];
+
+            Vector3 scale = ShapeBatch::GetUnitScale(shape.Shape, shape.Size);
+            Matrix expected = MatrixMultiply(MatrixScale(scale.x, scale.y, scale.z), worlds[i]);
+
+            ok &= Expect(SameMatrix(instance.Transform, expected), name, TextFormat("shape %d has the wrong instance matrix", int(i)));
+            ok &= Expect(SameColor(instance.Tint, shape.Tint), name, TextFormat("shape %d has the wrong tint", int(i)));
+        }
+
+        for (size_t g = 0; g < groups.size(); g++)
+            ok &= Expect(used[g] == groups[g].Count, name, TextFormat("group %d holds %d instances, %d shapes belong in it", int(g), int(groups[g].Count), int(used[g])));
+
+        // a cleared builder starts over
+        builder.Clear();
+        builder.Add(DrawShape::Sphere, Vector3{ 1, 1, 1 }, 0, MatrixIdentity(), WHITE, 0, RenderPipeline::Opaque);
+        builder.Build();
+        ok &= Expect(builder.GetGroups().size() == 1 && builder.GetInstances().size() == 1 && builder.GetGroups()[0].Count == 1, name, "a cleared builder kept old groups or instances");
+
+        return ok;
+    }
+
+    bool Occlusion()
+    {
+        const char* name = "occlusion";
+        bool ok = true;
+
+        OcclusionBuffer buffer;
+        buffer.Setup(256, 128);
+        Matrix viewProjection = GetCameraViewProjection(GetCheckCamera(), CheckAspect, CheckNear, CheckFar);
+
+        // a wall across the view 9 to 10 units out, it covers the middle of the screen but not the sides
+        const BoundingBox wall = { { -10, 9, -10 }, { 10, 10, 10 } };
+
+        const BoundingBox behind = { { -1, 20, -1 }, { 1, 22, 1 } };
+        const BoundingBox pastEdge = { { 15, 20, -1 }, { 30, 22, 1 } };
+        const BoundingBox inFront = { { -1, 4, -1 }, { 1, 5, 1 } };
+        const BoundingBox atEye = { { -1, -1, -1 }, { 1, 1, 1 } };
+
+        buffer.Begin(viewProjection);
+        ok &= Expect(buffer.IsVisible(behind), name, "a box is hidden with no occluders drawn");
+
+        RasterizeBounds(buffer, wall);
+        ok &= Expect(buffer.GetTriangleCount() > 0, name, "the wall drew no triangles");
+        ok &= Expect(!buffer.IsVisible(behind), name, "a box right behind the wall is visible");
+        ok &= Expect(buffer.IsVisible(pastEdge), name, "a box reaching out past the edge of the wall is hidden");
+        ok &= Expect(buffer.IsVisible(inFront), name, "a box in front of the wall is hidden");
+        ok &= Expect(buffer.IsVisible(atEye), name, "a box around the eye is hidden");
+
+        // the same wall stretched back past the eye, only its far face is wholly in front of the near plane
+        // faces crossing it are skipped, the far face alone still hides what is behind it
+        const BoundingBox throughEye = { { -10, -5, -10 }, { 10, 10, 10 } };
+
+        buffer.Begin(viewProjection);
+        RasterizeBounds(buffer, throughEye);
+        ok &= Expect(buffer.GetTriangleCount() == 2, name, TextFormat("an occluder through the near plane drew %d triangles, only its 2 far ones are in front", int(buffer.GetTriangleCount())));
+        ok &= Expect(!buffer.IsVisible(behind), name, "a box behind an occluder through the near plane is visible");
+        ok &= Expect(buffer.IsVisible(pastEdge), name, "a box past an occluder through the near plane is hidden");
+        ok &= Expect(buffer.IsVisible(atEye), name, "a box around the eye is hidden behind an occluder through the near plane");
+
+        // nothing written from the skipped faces can be nearer than the far face at 10 units
+        float nearest = 0;
+        for (int i = 0; i < buffer.GetWidth() * buffer.GetHeight(); i++)
+            nearest = std::max(nearest, buffer.GetDepth()[i]);
+        ok &= Expect(nearest > 0 && nearest <= 0.1f + 1e-4f, name, TextFormat("the nearest depth written is %f, the far face is at 1/10", nearest));
+
+        return ok;
+    }
+
+    bool CommandLists()
+    {
+        const char* name = "command lists";
+        bool ok = true;
+
+        // rows of small boxes and spheres from 10 to 49 units out, more than one extraction job's worth
+        // then shapes behind the eye that the frustum drops, and planes that need the double sided pipeline
+        constexpr int columns = 30;
+        constexpr int rows = 40;
+        constexpr int behindCount = 100;
+        constexpr int planeCount = 10;
+
+        CheckScene scene;
+        for (int i = 0; i < columns * rows; i++)
+            scene.AddShape((i % 3 == 0) ? DrawShape::Sphere : DrawShape::Box, Vector3{ float(i % columns - columns / 2) * 0.5f, 10.0f + float(i / columns), 0 }, Vector3{ 0.2f, 0.2f, 0.2f });
+
+        for (int i = 0; i < behindCount; i++)
+            scene.AddShape(DrawShape::Box, Vector3{ float(i % 10), -10.0f - float(i / 10), 0 }, Vector3{ 0.2f, 0.2f, 0.2f });
+
+        for (int i = 0; i < planeCount; i++)
+            scene.AddShape(DrawShape::Plane, Vector3{ float(i) - 5, 20, -3 }, Vector3{ 1, 1, 0 });
+
+        RenderView view;
+        view.Camera = GetCheckCamera();
+        view.ViewFrustum = FrustumFromCamera(view.Camera, CheckAspect, CheckNear, CheckFar);
+        view.ViewportHeight = 128;
+        view.FarPlane = CheckFar;
+
+        RenderCommands::UpdateTransforms();
+
+        std::vector<RenderCommandList> lists;
+        RenderQueue queue;
+        RenderCommands::Build(view, scene.Drawables, lists);
+        RenderCommands::Merge(lists, queue);
+
+        size_t visible = size_t(columns * rows + planeCount);
+        size_t listed = 0, culled = 0, occluded = 0, perLOD = 0;
+        for (const RenderCommandList& list : lists)
+        {
+            listed += list.Items.size();
+            culled += list.Culled;
+            occluded += list.Occluded;
+            for (size_t count : list.DrawablesPerLOD)
+                perLOD += count;
+        }
+
+        ok &= Expect(lists.size() == JobSystem::GetThreadCount(), name, TextFormat("%d lists for %d threads", int(lists.size()), int(JobSystem::GetThreadCount())));
+        ok &= Expect(listed == visible && queue.Size() == visible, name, TextFormat("%d items in the lists and %d in the queue, expected %d", int(listed), int(queue.Size()), int(visible)));
+        ok &= Expect(culled == behindCount && occluded == 0, name, TextFormat("%d culled and %d occluded, expected %d and 0", int(culled), int(occluded), behindCount));
+        ok &= Expect(perLOD == visible, name, "the per LOD counts do not add up to the items");
+
+        // every visible drawable once and in key order, so the pipeline changes once and each geometry and material run is contiguous and front to back
+        // it stops at the first wrong item
+        std::unordered_set<Drawable3DComponent*> seen;
+        std::unordered_set<uint64_t> closedRuns;
+        const std::vector<DrawItem>& items = queue.GetItems();
+        for (size_t i = 0; i < items.size() && ok; i++)
+        {
+            const DrawItem& item = items[i];
+            ok &= Expect(seen.insert(item.Drawable).second, name, "a drawable is in the queue twice");
+            ok &= Expect(item.Key == DrawKey::Make(item.Drawable->GetPipeline(), item.Drawable->GetGeometryId(), item.Drawable->GetMaterialId(), uint32_t(item.Key & DrawKey::DepthMask)), name, "an item's key does not match its drawable");
+
+            if (i == 0)
+                continue;
+
+            const DrawItem& previous = items[i - 1];
+            ok &= Expect(previous.Key <= item.Key, name, "the queue is not sorted");
+
+            uint64_t run = item.Key >> DrawKey::MaterialShift;
+            uint64_t previousRun = previous.Key >> DrawKey::MaterialShift;
+            if (run != previousRun)
+                ok &= Expect(closedRuns.insert(previousRun).second && closedRuns.count(run) == 0, name, "a geometry and material run is split");
+        }
+
+        if (!items.empty())
+            ok &= Expect(DrawKey::GetPipeline(items.back().Key) == RenderPipeline::DoubleSided && DrawKey::GetPipeline(items.front().Key) == RenderPipeline::Opaque, name, "the planes are not sorted after the opaque shapes");
+
+        // a wall covering the whole view 30 to 31 units out hides every row that is wholly behind it, it is an occluder so it is never hidden itself
+        ShapeComponent* wall = scene.AddShape(DrawShape::Box, Vector3{ 0, 30.5f, 0 }, Vector3{ 100, 1, 100 });
+        wall->Occluder = true;
+
+        OcclusionBuffer buffer;
+        buffer.Setup(256, 128);
+        buffer.Begin(GetCameraViewProjection(view.Camera, CheckAspect, CheckNear, CheckFar));
+
+        Vector3 corners[8];
+        wall->GetWorldCorners(corners);
+        buffer.RasterizeBox(corners);
+        view.Occlusion = &buffer;
+
+        RenderCommands::Build(view, scene.Drawables, lists);
+        RenderCommands::Merge(lists, queue);
+
+        // rows 31 to 49 units out, the wall's front face is at 30
+        size_t hiddenRows = size_t(rows - 21);
+        size_t expectedOccluded = hiddenRows * columns;
+        occluded = 0;
+        for (const RenderCommandList& list : lists)
+            occluded += list.Occluded;
+
+        ok &= Expect(occluded == expectedOccluded, name, TextFormat("%d occluded behind the wall, expected %d", int(occluded), int(expectedOccluded)));
+        ok &= Expect(queue.Size() == visible - expectedOccluded + 1, name, TextFormat("%d items with the wall up, expected %d", int(queue.Size()), int(visible - expectedOccluded + 1)));
+
+        bool wallQueued = false;
+        for (const DrawItem& item : queue.GetItems())
+        {
+            wallQueued |= item.Drawable == wall;
+            ok &= Expect(item.Drawable == wall || item.Drawable->GetWorldBounds().min.y < 30.0f, name, "a drawable behind the wall was queued");
+        }
+        ok &= Expect(wallQueued, name, "the occluder hid itself");
+
+        return ok;
+    }
+
+    bool RecordedFrame()
+    {
+        const char* name = "recorded frame";
+        bool ok = true;
+
+        using CommandType = RecordingRenderBackend::CommandType;
+
+        RecordingRenderBackend backend;
+        backend.SetViewport(1280, 900);
+        RenderBackend::Set(&backend);
+        RenderSystem::Setup();
+
+        // a row of boxes, a row of spheres and a few double sided planes, all near enough for full detail
+        constexpr int boxCount = 12;
+        constexpr int sphereCount = 6;
+        constexpr int planeCount = 3;
+        constexpr int shapeCount = boxCount + sphereCount + planeCount;
+
+        CheckScene scene;
+        uint64_t camera = scene.AddCamera(Vector3{ 0, 50, 0 });
+        for (int i = 0; i < boxCount; i++)
+            scene.AddShape(DrawShape::Box, Vector3{ float(i * 2 - boxCount + 1), 30, 0 }, Vector3{ 1, 1, 1 });
+        for (int i = 0; i < sphereCount; i++)
+            scene.AddShape(DrawShape::Sphere, Vector3{ float(i * 3 - sphereCount), 25, 3 }, Vector3{ 1, 1, 1 });
+        for (int i = 0; i < planeCount; i++)
+            scene.AddShape(DrawShape::Plane, Vector3{ float(i * 5 - 5), 35, -3 }, Vector3{ 4, 4, 0 });
+
+        auto drawFrame = [camera]()
+        {
+            RenderSystem::Begin(camera);
+            RenderSystem::Draw();
+            RenderSystem::End();
+        };
+
+        // instanced, one draw per shape kind, culling goes off for the planes and back on after them
+        drawFrame();
+        const RecordingRenderBackend::FrameStats& instanced = backend.GetLastFrame();
+        const RenderSystem::RenderStats& stats = RenderSystem::GetStats();
+
+        ok &= Expect(stats.Visible == size_t(shapeCount) && stats.DrawablesPerLOD[0] == size_t(shapeCount), name, TextFormat("%d visible and %d at full detail, expected %d", int(stats.Visible), int(stats.DrawablesPerLOD[0]), shapeCount));
+        ok &= Expect(instanced.DrawCalls == 3 && instanced.InstancedDraws == 3 && instanced.Instances == size_t(shapeCount), name,
+            TextFormat("instanced frame made %d draws, %d instanced covering %d shapes, expected 3, 3 and %d", int(instanced.DrawCalls), int(instanced.InstancedDraws), int(instanced.Instances), shapeCount));
+        ok &= Expect(instanced.StateChanges == 2 && stats.PipelineChanges == 2, name, TextFormat("instanced frame made %d state changes, expected 2", int(instanced.StateChanges)));
+        ok &= Expect(instanced.MatrixPushes == 0 && instanced.UniformUploads == 0, name, "instanced frame pushed matrices or uploaded uniforms");
+
+        // the planes are drawn while culling is off
+        const std::vector<RecordingRenderBackend::Command>& commands = backend.GetCommands();
+        int cullingOff = -1, cullingOn = -1, planeGroup = -1;
+        for (size_t i = instanced.FirstCommand; i < instanced.FirstCommand + instanced.Commands; i++)
+        {
+            const RecordingRenderBackend::Command& command = commands[i];
+            if (command.Type == CommandType::SetBackfaceCulling)
+                (command.Flags != 0 ? cullingOn : cullingOff) = int(i);
+            else if (command.Type == CommandType::DrawShapeGroup && command.Variant == uint16_t(DrawShape::Plane))
+                planeGroup = int(i);
+        }
+        ok &= Expect(cullingOff >= 0 && cullingOff < planeGroup && planeGroup < cullingOn, name, "the planes were not drawn between turning culling off and back on");
+
+        // one shape at a time, every shape is its own draw with the same two state changes
+        backend.SetInstancing(false);
+        RenderSystem::SetPretransform(false);
+        drawFrame();
+        const RecordingRenderBackend::FrameStats& single = backend.GetLastFrame();
+
+        ok &= Expect(single.DrawCalls == size_t(shapeCount) && single.InstancedDraws == 0 && backend.CountCommands(CommandType::DrawMesh) == size_t(shapeCount), name,
+            TextFormat("frame without instancing made %d draws, %d instanced, expected %d and 0", int(single.DrawCalls), int(single.InstancedDraws), shapeCount));
+        ok &= Expect(single.StateChanges == 2, name, TextFormat("frame without instancing made %d state changes, expected 2", int(single.StateChanges)));
+
+        RenderSystem::SetPretransform(true);
+
+        // a uniform set to the value it already holds is skipped until the cache is invalidated
+        Shader shader = { 0 };
+        shader.id = 42;
+
+        ShaderUniformCache uniforms;
+        uniforms.Setup(shader);
+        ShaderUniformCache::Handle viewPos = uniforms.Register("viewPos", SHADER_UNIFORM_VEC3);
+        ShaderUniformCache::Handle ambient = uniforms.Register("ambient", SHADER_UNIFORM_VEC4);
+
+        Vector3 position = { 1, 2, 3 };
+        Vector4 color = { 0.1f, 0.1f, 0.1f, 1 };
+
+        backend.BeginView(GetCheckCamera());
+        uniforms.Set(viewPos, &position);
+        uniforms.Set(ambient, &color);
+        uniforms.Set(viewPos, &position);
+        uniforms.Set(ambient, &color);
+        position.x = 5;
+        uniforms.Set(viewPos, &position);
+        uniforms.Invalidate();
+        uniforms.Set(ambient, &color);
+        backend.EndView();
+
+        const RecordingRenderBackend::FrameStats& uploads = backend.GetLastFrame();
+        ok &= Expect(uniforms.GetIssuedUploads() == 4 && uniforms.GetSkippedUploads() == 2, name,
+            TextFormat("the uniform cache sent %d and skipped %d, expected 4 and 2", int(uniforms.GetIssuedUploads()), int(uniforms.GetSkippedUploads())));
+        ok &= Expect(uploads.UniformUploads == 4 && uploads.Commands == 4 + 2, name, TextFormat("%d uniform uploads recorded, expected 4", int(uploads.UniformUploads)));
+
+        // the log keeps which uniform went where
+        if (uploads.Commands == 6)
+        {
+            const RecordingRenderBackend::Command& last = commands[uploads.FirstCommand + 4];
+            ok &= Expect(last.Type == CommandType::SetUniform && last.Resource == shader.id && last.Variant == uint16_t(uniforms.GetLocation(ambient)) &&
+                last.Flags == SHADER_UNIFORM_VEC4 && last.Count == sizeof(Vector4), name, "the last upload was not recorded as the ambient vec4");
+        }
+
+        RenderSystem::Shutdown();
+        RenderBackend::Set(nullptr);
+
+        return ok;
+    }
+
+    bool SharedMaterial()
+    {
+        const char* name = "shared material";
+        bool ok = true;
+
+        // how many references the resource manager holds on the default material
+        auto countReferences = []()
+        {
+            std::vector<ResourceManager::ResourceInfo> info;
+            ResourceManager::GetResourceInfo(info);
+            for (const ResourceManager::ResourceInfo& resource : info)
+            {
+                if (resource.Type == ResourceManager::ResourceType::Material && resource.Key == "default")
+                    return int(resource.RefCount);
+            }
+            return 0;
+        };
+
+        RecordingRenderBackend backend;
+        backend.SetViewport(1280, 900);
+        RenderBackend::Set(&backend);
+        RenderSystem::Setup();
+
+        ResourceManager::MaterialHandle handle = ResourceManager::AcquireDefaultMaterial();
+        int held = countReferences();
+        Color diffuse = ResourceManager::Get(handle)->maps[MAP_DIFFUSE].color;
+
+        CheckScene scene;
+        uint64_t camera = scene.AddCamera(Vector3{ 0, 50, 0 });
+        scene.AddShape(DrawShape::Box, Vector3{ -2, 30, 0 }, Vector3{ 1, 1, 1 })->MustGetComponent<ColorComponent>()->SetColor(RED);
+        scene.AddShape(DrawShape::Sphere, Vector3{ 2, 30, 0 }, Vector3{ 1, 1, 1 })->MustGetComponent<ColorComponent>()->SetColor(BLUE);
+
+        // one shape at a time and then pre-transformed, neither may leave its color on the material meshes share
+        backend.SetInstancing(false);
+        for (bool pretransform : { false, true })
+        {
+            RenderSystem::SetPretransform(pretransform);
+            RenderSystem::Begin(camera);
+            RenderSystem::Draw();
+            RenderSystem::End();
+
+            ok &= Expect(SameColor(ResourceManager::Get(handle)->maps[MAP_DIFFUSE].color, diffuse), name,
+                pretransform ? "pre-transformed shapes changed the default material's color" : "shapes drawn one at a time changed the default material's color");
+        }
+        RenderSystem::SetPretransform(true);
+
+        ok &= Expect(PrimitiveMeshCache::GetMaterial().maps == ResourceManager::Get(handle)->maps, name, "the shape material is not the resource manager's default material");
+        ok &= Expect(countReferences() == held + 1, name, TextFormat("the shape cache holds %d references on the default material, expected 1", countReferences() - held));
+
+        RenderSystem::Shutdown();
+        RenderBackend::Set(nullptr);
+
+        ok &= Expect(countReferences() == held, name, "the shape cache did not release the default material when it was cleared");
+        ResourceManager::Release(handle);
+
+        return ok;
+    }
+
+    bool MatrixBlend()
+    {
+        const char* name = "matrix blend";
+        bool ok = true;
+
+        // a translation under a fixed rotation only moves, the rotation has to come through untouched
+        Matrix rotation = MatrixRotateY(0.7f);
+        Matrix from = MatrixMultiply(rotation, MatrixTranslate(1, 2, 3));
+        Matrix to = MatrixMultiply(rotation, MatrixTranslate(5, 2, -1));
+
+        ok &= Expect(SameMatrix(FixedStepRunner::BlendMatrix(from, to, 0.5f), MatrixMultiply(rotation, MatrixTranslate(3, 2, 1))), name, "a rotated translation did not blend to the midpoint");
+        ok &= Expect(SameMatrix(FixedStepRunner::BlendMatrix(from, to, 0), from), name, "a blend at 0 is not the first matrix");
+        ok &= Expect(SameMatrix(FixedStepRunner::BlendMatrix(from, to, 1), to), name, "a blend at 1 is not the second matrix");
+
+        // turning evenly from 0 to 0.6 around z, halfway is 0.3 and the scale of 2 stays on every axis
+        Matrix start = MatrixMultiply(MatrixScale(2, 2, 2), MatrixMultiply(MatrixRotateZ(0), MatrixTranslate(0, 0, 4)));
+        Matrix end = MatrixMultiply(MatrixScale(2, 2, 2), MatrixMultiply(MatrixRotateZ(0.6f), MatrixTranslate(0, 0, 4)));
+        Matrix expected = MatrixMultiply(MatrixScale(2, 2, 2), MatrixMultiply(MatrixRotateZ(0.3f), MatrixTranslate(0, 0, 4)));
+
+        ok &= Expect(SameMatrix(FixedStepRunner::BlendMatrix(start, end, 0.5f), expected), name, "a scaled rotation did not blend to the middle angle");
+
+        return ok;
+    }
+
+    bool JobRestart()
+    {
+        const char* name = "job restart";
+        bool ok = true;
+
+        // a loop run before the restart, its function is gone by the time the new workers start
+        for (int round = 0; round < 3; round++)
+        {
+            std::atomic<size_t> sum(0);
+            {
+                std::vector<size_t> values(1000);
+                for (size_t i = 0; i < values.size(); i++)
+                    values[i] = i;
+
+                JobSystem::ParallelFor(values.size(), 16, [&values, &sum](size_t begin, size_t end, size_t)
+                    {
+                        for (size_t i = begin; i < end; i++)
+                            sum += values[i];
+                    });
+            }
+
+            ok &= Expect(sum == 999 * 1000 / 2, name, TextFormat("round %d summed to %d", round, int(sum)));
+
+            JobSystem::Shutdown();
+            JobSystem::Setup(3);
+            ok &= Expect(JobSystem::GetThreadCount() == 4, name, TextFormat("round %d restarted with %d threads", round, int(JobSystem::GetThreadCount())));
+        }
+
+        return ok;
+    }
+
+    bool SnapshotParents()
+    {
+        const char* name = "snapshot parents";
+        bool ok = true;
+
+        CheckScene scene;
+        TransformComponent* outside = scene.AddShape(DrawShape::Box, Vector3{ 0, 10, 0 }, Vector3{ 1, 1, 1 })->GetComponent<TransformComponent>();
+        TransformComponent* inside = scene.AddShape(DrawShape::Box, Vector3{ 2, 10, 0 }, Vector3{ 1, 1, 1 })->GetComponent<TransformComponent>();
+        TransformComponent* child = scene.AddShape(DrawShape::Box, Vector3{ 0, 0, 1 }, Vector3{ 1, 1, 1 })->GetComponent<TransformComponent>();
+        TransformComponent* grandChild = scene.AddShape(DrawShape::Box, Vector3{ 0, 0, 1 }, Vector3{ 1, 1, 1 })->GetComponent<TransformComponent>();
+        outside->AddChild(child);
+        inside->AddChild(grandChild);
+
+        // the first child's parent is left out of the file, the second one's goes in with it
+        const char* fileName = "headless_check_parents.snapshot";
+        std::vector<uint64_t> saved = { child->EntityId, inside->EntityId, grandChild->EntityId };
+        ok &= Expect(WorldSnapshot::Save(fileName, saved), name, "the snapshot could not be written");
+
+        std::vector<uint64_t> loaded;
+        ok &= Expect(WorldSnapshot::Load(fileName, nullptr, &loaded) && loaded.size() == saved.size(), name, "the snapshot could not be loaded");
+        remove(fileName);
+
+        if (loaded.size() == saved.size())
+        {
+            TransformComponent* loadedChild = ComponentManager::GetComponent<TransformComponent>(loaded[0]);
+            TransformComponent* loadedInside = ComponentManager::GetComponent<TransformComponent>(loaded[1]);
+            TransformComponent* loadedGrandChild = ComponentManager::GetComponent<TransformComponent>(loaded[2]);
+
+            ok &= Expect(loadedChild != nullptr && loadedChild->GetParent() == outside, name, "a parent outside the snapshot was not linked again");
+            ok &= Expect(loadedGrandChild != nullptr && loadedGrandChild->GetParent() == loadedInside, name, "a parent inside the snapshot was not linked to its loaded copy");
+        }
+
+        for (uint64_t entity : loaded)
+        {
+            ComponentManager::RemoveEntity(entity);
+            EntityManger::ReleaseEntity(entity);
+        }
+
+        return ok;
+    }
+
+    int RunAll()
+    {
+        struct NamedCheck
+        {
+            const char* Name;
+            bool(*Run)();
+        };
+
+        const NamedCheck checks[] =
+        {
+            { "shape batches", ShapeBatches },
+            { "occlusion", Occlusion },
+            { "command lists", CommandLists },
+            { "recorded frame", RecordedFrame },
+            { "shared material", SharedMaterial },
+            { "matrix blend", MatrixBlend },
+            { "job restart", JobRestart },
+            { "snapshot parents", SnapshotParents },
+        };
+
+        // a few workers even on a small machine, so the parallel phases really split the work
+        JobSystem::Setup(3);
+
+        int failed = 0;
+        for (const NamedCheck& check : checks)
+        {
+            bool passed = check.Run();
+            printf("headless check %s: %s\n", check.Name, passed ? "passed" : "FAILED");
+            if (!passed)
+                failed++;
+        }
+
+        JobSystem::Shutdown();
+        return failed;
+    }
+}
@@ -0,0 +1,63 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+// fixed scenes with known answers for the parts of the renderer that run on the CPU
+// each check prints what differed and returns false, headless --check runs them all and fails if any did
+namespace HeadlessChecks
+{
+    // group counts, instance ranges and instance matrices from ShapeBatchBuilder
+    bool ShapeBatches();
+
+    // known occluder layouts through OcclusionBuffer, a box hidden behind a wall, one only partly hidden and an occluder crossing the near plane
+    bool Occlusion();
+
+    // the per thread command lists and the merged queue RenderCommands makes for a scene of shapes, with and without an occluder
+    bool CommandLists();
+
+    // a fixed scene drawn through RenderSystem into RecordingRenderBackend, the draw calls and state changes it records
+    // and the uploads ShaderUniformCache sends or skips
+    bool RecordedFrame();
+
+    // shapes drawing through the resource manager's default material without changing it, and the cache letting go of it on shutdown
+    bool SharedMaterial();
+
+    // FixedStepRunner's blend between two known world matrices
+    bool MatrixBlend();
+
+    // JobSystem torn down and started again still runs every item once
+    bool JobRestart();
+
+    // WorldSnapshot linking saved transforms to a parent inside the file and to one left outside it
+    bool SnapshotParents();
+
+    // returns how many checks failed
+    int RunAll();
+}
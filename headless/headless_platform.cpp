@@ -0,0 +1,343 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "headless_platform.h"
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace HeadlessPlatform
+{
+    double Clock = 0;
+    float FrameTime = 0;
+
+    void AdvanceClock(float seconds)
+    {
+        FrameTime = seconds;
+        Clock += seconds;
+    }
+
+    double GetClock()
+    {
+        return Clock;
+    }
+}
+
+// timing, from the host's clock instead of the window's frame pacing
+
+double GetTime()
+{
+    return HeadlessPlatform::Clock;
+}
+
+float GetFrameTime()
+{
+    return HeadlessPlatform::FrameTime;
+}
+
+// input, nothing is ever pressed and the mouse never moves
+
+bool IsKeyDown(int)
+{
+    return false;
+}
+
+bool IsKeyPressed(int)
+{
+    return false;
+}
+
+bool IsMouseButtonDown(int)
+{
+    return false;
+}
+
+bool IsMouseButtonPressed(int)
+{
+    return false;
+}
+
+Vector2 GetMousePosition()
+{
+    return Vector2{ 0, 0 };
+}
+
+// logging and files, the real thing
+
+void TraceLog(int logLevel, const char* text, ...)
+{
+    if (logLevel < LOG_INFO)
+        return;
+
+    const char* prefix = (logLevel >= LOG_ERROR) ? "ERROR: " : (logLevel == LOG_WARNING) ? "WARNING: " : "INFO: ";
+
+    va_list args;
+    va_start(args, text);
+    fputs(prefix, stdout);
+    vprintf(text, args);
+    fputs("\n", stdout);
+    va_end(args);
+}
+
+unsigned char* LoadFileData(const char* fileName, unsigned int* bytesRead)
+{
+    *bytesRead = 0;
+
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr)
+        return nullptr;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = (size > 0) ? (unsigned char*)RL_MALLOC(size_t(size)) : nullptr;
+    if (data != nullptr)
+        *bytesRead = (unsigned int)fread(data, 1, size_t(size), file);
+
+    fclose(file);
+    return data;
+}
+
+void UnloadFileData(unsigned char* data)
+{
+    RL_FREE(data);
+}
+
+char* LoadFileText(const char* fileName)
+{
+    unsigned int size = 0;
+    unsigned char* data = LoadFileData(fileName, &size);
+    if (data == nullptr)
+        return nullptr;
+
+    char* text = (char*)RL_MALLOC(size + 1);
+    memcpy(text, data, size);
+    text[size] = 0;
+    RL_FREE(data);
+
+    return text;
+}
+
+void UnloadFileText(char* text)
+{
+    RL_FREE(text);
+}
+
+// the same rotating buffers raylib uses, so a few results can be alive at once
+const char* TextFormat(const char* text, ...)
+{
+    static char buffers[4][1024];
+    static int index = 0;
+
+    char* buffer = buffers[index];
+    index = (index + 1) % 4;
+
+    va_list args;
+    va_start(args, text);
+    vsnprintf(buffer, sizeof(buffers[0]), text, args);
+    va_end(args);
+
+    return buffer;
+}
+
+// GPU resources, meshes keep their arrays on the CPU and everything else is an empty handle
+
+void UploadMesh(Mesh*, bool)
+{
+}
+
+void UnloadMesh(Mesh mesh)
+{
+    RL_FREE(mesh.vertices);
+    RL_FREE(mesh.texcoords);
+    RL_FREE(mesh.texcoords2);
+    RL_FREE(mesh.normals);
+    RL_FREE(mesh.tangents);
+    RL_FREE(mesh.colors);
+    RL_FREE(mesh.indices);
+    RL_FREE(mesh.animVertices);
+    RL_FREE(mesh.animNormals);
+    RL_FREE(mesh.boneWeights);
+    RL_FREE(mesh.boneIds);
+    RL_FREE(mesh.vboId);
+}
+
+// primitives are only drawn, so they have no geometry here
+Mesh GenMeshCube(float, float, float)
+{
+    return Mesh{ 0 };
+}
+
+Mesh GenMeshPlane(float, float, int, int)
+{
+    return Mesh{ 0 };
+}
+
+Mesh GenMeshSphere(float, int, int)
+{
+    return Mesh{ 0 };
+}
+
+void DrawMesh(Mesh, Material, Matrix)
+{
+}
+
+Shader LoadShaderFromMemory(const char*, const char*)
+{
+    // every location reads as missing, so uniform setters skip it
+    Shader shader = { 0 };
+    shader.locs = (int*)RL_MALLOC(MAX_SHADER_LOCATIONS * sizeof(int));
+    for (int i = 0; i < MAX_SHADER_LOCATIONS; i++)
+        shader.locs[i] = -1;
+
+    return shader;
+}
+
+Shader LoadShader(const char* vsFileName, const char* fsFileName)
+{
+    return LoadShaderFromMemory(vsFileName, fsFileName);
+}
+
+void UnloadShader(Shader shader)
+{
+    RL_FREE(shader.locs);
+}
+
+int GetShaderLocation(Shader shader, const char* uniformName)
+{
+    // shaders loaded here have no program and find nothing, one made by hand with an id gets a location per name
+    // so code that caches uniforms can still be checked headless
+    if (shader.id == 0)
+        return -1;
+
+    static std::vector<std::string> names;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (names[i] == uniformName)
+            return int(i);
+    }
+
+    names.push_back(uniformName);
+    return int(names.size() - 1);
+}
+
+Material LoadMaterialDefault()
+{
+    Material material = { 0 };
+    material.shader = LoadShaderFromMemory(nullptr, nullptr);
+    material.maps = (MaterialMap*)RL_CALLOC(MAX_MATERIAL_MAPS, sizeof(MaterialMap));
+    material.maps[MAP_DIFFUSE].color = WHITE;
+
+    return material;
+}
+
+void UnloadMaterial(Material material)
+{
+    UnloadShader(material.shader);
+    RL_FREE(material.maps);
+}
+
+Model LoadModel(const char* fileName)
+{
+    TraceLog(LOG_WARNING, "HEADLESS: Models are not loaded, %s is empty", fileName);
+    return Model{ 0 };
+}
+
+void UnloadModel(Model model)
+{
+    for (int i = 0; i < model.meshCount; i++)
+        UnloadMesh(model.meshes[i]);
+
+    for (int i = 0; i < model.materialCount; i++)
+        UnloadMaterial(model.materials[i]);
+
+    RL_FREE(model.meshes);
+    RL_FREE(model.materials);
+    RL_FREE(model.meshMaterial);
+    RL_FREE(model.bones);
+    RL_FREE(model.bindPose);
+}
+
+// no textures exist, so every id is the default one
+
+// sized for real so recorded texture uploads count their bytes, compressed formats count as nothing
+int GetPixelDataSize(int width, int height, int format)
+{
+    int bitsPerPixel = 0;
+    switch (format)
+    {
+    case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE: bitsPerPixel = 8; break;
+    case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+    case PIXELFORMAT_UNCOMPRESSED_R5G6B5:
+    case PIXELFORMAT_UNCOMPRESSED_R5G5B5A1:
+    case PIXELFORMAT_UNCOMPRESSED_R4G4B4A4: bitsPerPixel = 16; break;
+    case PIXELFORMAT_UNCOMPRESSED_R8G8B8: bitsPerPixel = 24; break;
+    case PIXELFORMAT_UNCOMPRESSED_R8G8B8A8:
+    case PIXELFORMAT_UNCOMPRESSED_R32: bitsPerPixel = 32; break;
+    case PIXELFORMAT_UNCOMPRESSED_R32G32B32: bitsPerPixel = 96; break;
+    case PIXELFORMAT_UNCOMPRESSED_R32G32B32A32: bitsPerPixel = 128; break;
+    default: break;
+    }
+
+    return width * height * bitsPerPixel / 8;
+}
+
+void UnloadTexture(Texture2D)
+{
+}
+
+unsigned int rlGetTextureIdDefault()
+{
+    return 0;
+}
+
+unsigned int rlLoadTexture(void*, int, int, int, int)
+{
+    return 0;
+}
+
+void rlUnloadTexture(unsigned int)
+{
+}
+
+void rlUnloadVertexArray(unsigned int)
+{
+}
+
+void rlUnloadVertexBuffer(unsigned int)
+{
+}
@@ -0,0 +1,345 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "headless_checks.h"
+#include "headless_platform.h"
+
+#include "automover_component.h"
+#include "camera_component.h"
+#include "color_component.h"
+#include "drawable_component.h"
+#include "flight_data_component.h"
+#include "look_at_component.h"
+#include "transform_component.h"
+
+#include "automover_system.h"
+#include "fixed_step_runner.h"
+#include "job_system.h"
+#include "look_at_system.h"
+#include "recording_render_backend.h"
+#include "render_system.h"
+#include "spatial_index_system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// runs the simulation with no window, GL context or input, for servers and for profiling the ECS on its own
+// usage: headless [--entities N] [--frames N] [--rate HZ] [--fps HZ] [--realtime] [--no-interpolation] [--render] [--no-instancing] [--expect-draws N] [--check]
+// --render draws every frame into the recording backend and reports what was submitted, --no-instancing takes the path for GL without it
+// --expect-draws fails the run when the last frame's draw calls differ, for checking a scene in scripts
+// --check runs the fixed scene checks in headless_checks.cpp instead of the simulation and fails if any of them do
+// an unknown option or one missing its value prints the usage and exits with 1
+
+namespace
+{
+    struct Options
+    {
+        size_t Entities = 10000;
+        int Frames = 600;
+        float TickRate = FixedStepRunner::DefaultTickRate;
+
+        // frames are stepped at this rate, on the virtual clock they run back to back
+        float FrameRate = 60;
+        bool Realtime = false;
+        bool Interpolate = true;
+
+        bool Render = false;
+        bool Instancing = true;
+        int ExpectedDraws = -1;
+        bool Check = false;
+        bool Help = false;
+    };
+
+    int Usage(const char* error)
+    {
+        if (error != nullptr)
+            printf("%s\n", error);
+
+        printf("usage: headless [--entities N] [--frames N] [--rate HZ] [--fps HZ] [--realtime] [--no-interpolation] [--render] [--no-instancing] [--expect-draws N] [--check]\n");
+
+        return error != nullptr ? 1 : 0;
+    }
+
+    // false with the reason in error for an unknown option or one missing its value
+    bool ParseOptions(int argc, char* argv[], Options& options, std::string& error)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const char* arg = argv[i];
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+            {
+                options.Help = true;
+                return true;
+            }
+
+            bool takesValue = strcmp(arg, "--entities") == 0 || strcmp(arg, "--frames") == 0 || strcmp(arg, "--rate") == 0 || strcmp(arg, "--fps") == 0 || strcmp(arg, "--expect-draws") == 0;
+            const char* value = nullptr;
+            if (takesValue)
+            {
+                if (i + 1 >= argc)
+                {
+                    error = std::string(arg) + " needs a value";
+                    return false;
+                }
+
+                value = argv[++i];
+            }
+
+            if (strcmp(arg, "--entities") == 0)
+                options.Entities = size_t(atoll(value));
+            else if (strcmp(arg, "--frames") == 0)
+                options.Frames = atoi(value);
+            else if (strcmp(arg, "--rate") == 0)
+                options.TickRate = float(atof(value));
+            else if (strcmp(arg, "--fps") == 0)
+                options.FrameRate = float(atof(value));
+            else if (strcmp(arg, "--realtime") == 0)
+                options.Realtime = true;
+            else if (strcmp(arg, "--no-interpolation") == 0)
+                options.Interpolate = false;
+            else if (strcmp(arg, "--render") == 0)
+                options.Render = true;
+            else if (strcmp(arg, "--no-instancing") == 0)
+                options.Instancing = false;
+            else if (strcmp(arg, "--expect-draws") == 0)
+                options.ExpectedDraws = atoi(value), options.Render = true;
+            else if (strcmp(arg, "--check") == 0)
+                options.Check = true;
+            else
+            {
+                error = std::string("unknown option ") + arg;
+                return false;
+            }
+        }
+
+        options.FrameRate = std::max(1.0f, options.FrameRate);
+        return true;
+    }
+
+    // the same mix the sample has, shapes in small hierarchies with some of them spinning, plus cameras
+    // returns the camera the render pass draws from
+    uint64_t CreateWorld(size_t count)
+    {
+        TransformComponent* root = nullptr;
+        for (size_t i = 0; i < count; i++)
+        {
+            TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+
+            // roots are laid out on a grid, children stack a short way above their root like the radar dish in the sample
+            size_t group = i / 4;
+            if (i % 4 == 0)
+            {
+                transform->SetPosition(float(group % 50) * 4, float((group / 50) % 50) * 4, float(group / 2500) * 4);
+                root = transform;
+            }
+            else
+            {
+                root->AddChild(transform);
+                transform->SetPosition(0, 0, 0.5f * float(i % 4));
+            }
+
+            ShapeComponent* shape = ComponentManager::AddComponent<ShapeComponent>(transform);
+            shape->ObjectShape = DrawShape(i % 3);
+            shape->MustGetComponent<ColorComponent>()->SetColor(Color{ uint8_t(i), uint8_t(i >> 8), 128, 255 });
+
+            if (i % 8 == 0)
+            {
+                AutoMoverComponent* mover = ComponentManager::AddComponent<AutoMoverComponent>(transform);
+                mover->AngularSpeed.z = 90;
+                mover->LinearSpeed.y = 1;
+            }
+        }
+
+        TransformComponent* camera = ComponentManager::AddComponent<TransformComponent>();
+        // behind the field looking back down -y across it
+        camera->SetPosition(100, 220, 20);
+        ComponentManager::AddComponent<CameraComponent>(camera);
+        ComponentManager::AddComponent<FlightDataComponent>(camera);
+
+        TransformComponent* tracker = ComponentManager::AddComponent<TransformComponent>();
+        tracker->SetPosition(0, 0, 10);
+        ComponentManager::AddComponent<CameraComponent>(tracker);
+        ComponentManager::AddComponent<LookAtComponent>(tracker)->TargetEntityId = root->EntityId;
+
+        return camera->EntityId;
+    }
+
+    // the recorded calls have to agree with what the render system thinks it submitted
+    bool CheckFrame(const RecordingRenderBackend::FrameStats& frame, const RenderSystem::RenderStats& stats)
+    {
+        if (frame.InstancedDraws != stats.InstancedDraws || frame.Instances != stats.InstancedShapes)
+        {
+            printf("headless: recorded %d instanced draws of %d shapes, the render system counted %d of %d\n",
+                int(frame.InstancedDraws), int(frame.Instances), int(stats.InstancedDraws), int(stats.InstancedShapes));
+            return false;
+        }
+
+        if (frame.DrawCalls < stats.InstancedDraws + stats.PretransformDraws + stats.StaticBatchDraws)
+        {
+            printf("headless: recorded %d draw calls, fewer than the %d batched draws the render system counted\n",
+                int(frame.DrawCalls), int(stats.InstancedDraws + stats.PretransformDraws + stats.StaticBatchDraws));
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::string error;
+    if (!ParseOptions(argc, argv, options, error))
+        return Usage(error.c_str());
+
+    if (options.Help)
+        return Usage(nullptr);
+
+    if (options.Check)
+        return (HeadlessChecks::RunAll() == 0) ? 0 : 1;
+
+    JobSystem::Setup();
+    AutoMoverSystem::Setup();
+    LookAtSystem::Setup();
+    SpatialIndexSystem::Setup();
+
+    FixedStepRunner::Setup(options.TickRate);
+    FixedStepRunner::SetInterpolation(options.Interpolate);
+    FixedStepRunner::AddSystem(AutoMoverSystem::Update);
+    FixedStepRunner::AddSystem([](float) { LookAtSystem::Update(); });
+
+    RecordingRenderBackend renderBackend;
+    renderBackend.SetInstancing(options.Instancing);
+    RenderBackend::Set(&renderBackend);
+    if (options.Render)
+        RenderSystem::Setup();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t cameraEntity = CreateWorld(options.Entities);
+    double createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("headless: %d entities in %.1f ms, %d frames at %.0f fps, simulation at %.0f Hz on the %s clock\n",
+        int(options.Entities), createMs, options.Frames, options.FrameRate, FixedStepRunner::GetTickRate(), options.Realtime ? "wall" : "virtual");
+
+    float frameTime = 1.0f / options.FrameRate;
+    double totalMs = 0;
+    double worstMs = 0;
+    int ticks = 0;
+    bool framesMatch = true;
+
+    auto nextFrame = std::chrono::steady_clock::now();
+    auto lastFrame = nextFrame;
+    for (int frame = 0; frame < options.Frames; frame++)
+    {
+        if (options.Realtime)
+        {
+            // sleep to the frame boundary and step by however long it really was
+            nextFrame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / options.FrameRate));
+            std::this_thread::sleep_until(nextFrame);
+
+            auto now = std::chrono::steady_clock::now();
+            frameTime = std::chrono::duration<float>(now - lastFrame).count();
+            lastFrame = now;
+        }
+
+        HeadlessPlatform::AdvanceClock(frameTime);
+
+        auto frameStart = std::chrono::steady_clock::now();
+
+        ComponentManager::Update();
+        FixedStepRunner::Update(frameTime);
+        SpatialIndexSystem::Update();
+
+        if (options.Render)
+        {
+            // only the last frame's calls are kept, every frame keeps its counts
+            renderBackend.SetLogging(frame + 1 == options.Frames);
+
+            RenderSystem::Begin(cameraEntity);
+            RenderSystem::Draw();
+            RenderSystem::End();
+
+            framesMatch = CheckFrame(renderBackend.GetLastFrame(), RenderSystem::GetStats()) && framesMatch;
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+        ticks += FixedStepRunner::GetStats().Ticks;
+    }
+
+    printf("headless: %d ticks over %.2f simulated seconds, frame average %.3f ms, worst %.3f ms\n",
+        ticks, HeadlessPlatform::GetClock(), totalMs / std::max(1, options.Frames), worstMs);
+
+    int result = 0;
+    if (options.Render && !renderBackend.GetFrames().empty())
+    {
+        const std::vector<RecordingRenderBackend::FrameStats>& frames = renderBackend.GetFrames();
+
+        double submitMs = 0;
+        double worstSubmitMs = 0;
+        size_t drawCalls = 0;
+        for (const RecordingRenderBackend::FrameStats& frame : frames)
+        {
+            submitMs += frame.SubmitMs;
+            worstSubmitMs = std::max(worstSubmitMs, frame.SubmitMs);
+            drawCalls += frame.DrawCalls;
+        }
+
+        const RecordingRenderBackend::FrameStats& last = renderBackend.GetLastFrame();
+        printf("headless: render %.1f draw calls per frame, submit average %.3f ms, worst %.3f ms\n",
+            double(drawCalls) / frames.size(), submitMs / frames.size(), worstSubmitMs);
+        printf("headless: last frame %d draws (%d instanced covering %d shapes), %d triangles, %d state changes, %d matrix pushes, %d uniforms, %d buffer updates of %d bytes\n",
+            int(last.DrawCalls), int(last.InstancedDraws), int(last.Instances), int(last.Triangles), int(last.StateChanges),
+            int(last.MatrixPushes), int(last.UniformUploads), int(last.BufferUpdates), int(last.UploadBytes));
+
+        if (!framesMatch)
+            result = 1;
+
+        if (options.ExpectedDraws >= 0 && last.DrawCalls != size_t(options.ExpectedDraws))
+        {
+            printf("headless: expected %d draw calls, the last frame made %d\n", options.ExpectedDraws, int(last.DrawCalls));
+            result = 1;
+        }
+    }
+
+    if (options.Render)
+        RenderSystem::Shutdown();
+
+    FixedStepRunner::Shutdown();
+    JobSystem::Shutdown();
+
+    return result;
+}
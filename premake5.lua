@@ -82,4 +82,64 @@ project "test"
 		libdirs {"bin/%{cfg.buildcfg}"}
 		
 	filter "action:gmake*"
-		links {"pthread", "GL", "m", "dl", "rt", "X11"}
\ No newline at end of file
+		links {"pthread", "GL", "m", "dl", "rt", "X11"}
+
+project "bench"
+	kind "ConsoleApp"
+	location "bench"
+	language "C++"
+	targetdir "bin/%{cfg.buildcfg}"
+	cppdialect "C++17"
+	
+	vpaths 
+	{
+		["Header Files"] = { "**.h"},
+		["Source Files"] = {"**.c", "**.cpp"},
+	}
+	-- the benches need the components and systems, so everything but the sample's entry point comes along
+	-- they run headless like the headless project, on its platform stand in and without the GL only files
+	files {"bench/**.cpp", "bench/**.h", "test/**.cpp", "test/**.h", "headless/headless_platform.cpp", "headless/headless_platform.h"}
+	removefiles {"test/main.cpp", "test/shape_instancing.cpp", "test/gl_render_backend.cpp"}
+
+	includedirs { "bench", "test", "headless", "raylib/src" }
+	
+	filter "action:vs*"
+		defines{"_CRT_SECURE_NO_WARNINGS", "_WIN32"}
+		
+	filter "action:gmake*"
+		links {"pthread", "m"}
+
+project "headless"
+	kind "ConsoleApp"
+	location "headless"
+	language "C++"
+	targetdir "bin/%{cfg.buildcfg}"
+	cppdialect "C++17"
+	
+	vpaths 
+	{
+		["Header Files"] = { "**.h"},
+		["Source Files"] = {"**.c", "**.cpp"},
+	}
+	-- the simulation without raylib, headless_platform.cpp stands in for the few raylib calls it makes
+	-- the render system comes along for --render, drawing into the recording backend instead of GL
+	files {"headless/**.cpp", "headless/**.h", "test/**.h",
+		"test/components.cpp", "test/entity.cpp", "test/transform_hierarchy.cpp",
+		"test/automover_system.cpp", "test/look_at_system.cpp", "test/fixed_step_runner.cpp",
+		"test/spatial_index_system.cpp", "test/dynamic_bvh.cpp", "test/job_system.cpp",
+		"test/world_snapshot.cpp", "test/world_streaming.cpp", "test/async_loader.cpp", "test/resource_manager.cpp",
+		"test/mesh_files.cpp", "test/mesh_cache.cpp", "test/mesh_optimizer.cpp", "test/mapped_file.cpp",
+		"test/primitive_meshes.cpp", "test/primitive_mesh_cache.cpp", "test/shape_batch_builder.cpp",
+		"test/render_backend.cpp", "test/recording_render_backend.cpp", "test/render_system.cpp", "test/render_commands.cpp",
+		"test/render_queue.cpp", "test/visibility_system.cpp", "test/occlusion_culling.cpp", "test/occlusion_buffer.cpp",
+		"test/static_batch_system.cpp", "test/shape_pretransform.cpp", "test/shader_uniform_cache.cpp",
+		"test/lighting_system.cpp", "test/light_clusters.cpp", "test/light_component.cpp"}
+
+	-- raylib's headers are still used for its types and math
+	includedirs { "headless", "test", "raylib/src" }
+	
+	filter "action:vs*"
+		defines{"_CRT_SECURE_NO_WARNINGS", "_WIN32"}
+		
+	filter "action:gmake*"
+		links {"pthread", "m"}
@@ -7,6 +7,7 @@ in vec3 vertexNormal;
 in vec4 vertexColor;
 
 in mat4 instanceTransform;
+in vec4 instanceColor;
 
 // Input uniform values
 uniform mat4 mvp;
@@ -26,10 +27,10 @@ void main()
     mat4 mvpi = mvp*instanceTransform;
     
     // Send vertex attributes to fragment shader
-    fragPosition = vec3(mvpi*vec4(vertexPosition, 1.0));
+    fragPosition = vec3(instanceTransform*vec4(vertexPosition, 1.0));
     fragTexCoord = vertexTexCoord;
-    fragColor = vertexColor;
-    fragNormal = normalize(vec3(matNormal*vec4(vertexNormal, 1.0)));
+    fragColor = instanceColor;
+    fragNormal = normalize(vec3(instanceTransform*vec4(vertexNormal, 0.0)));
 
     // Calculate final vertex position
     gl_Position = mvpi*vec4(vertexPosition, 1.0);
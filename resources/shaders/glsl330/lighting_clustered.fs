@@ -0,0 +1,107 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec3 fragPosition;
+in vec2 fragTexCoord;
+in vec4 fragColor;
+in vec3 fragNormal;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+// Output fragment color
+out vec4 finalColor;
+
+#define     MAX_LIGHTS              4
+#define     LIGHT_DIRECTIONAL       0
+#define     LIGHT_POINT             1
+
+struct Light {
+    int enabled;
+    int type;
+    vec3 position;
+    vec3 target;
+    vec4 color;
+};
+
+// Input lighting values, the uniform array only carries directional lights
+uniform Light lights[MAX_LIGHTS];
+uniform vec4 ambient;
+uniform vec3 viewPos;
+
+// clustered point lights
+uniform sampler2D lightData;        // two texels per light, position + radius then color
+uniform sampler2D clusterTable;     // one texel per cluster, first index and count
+uniform sampler2D lightIndices;     // flat light index list
+
+uniform ivec3 clusterDims;          // tiles x, tiles y, depth slices
+uniform vec2 clusterDepth;          // first slice depth, slices / log(far / near)
+uniform vec2 viewportSize;
+uniform vec3 viewForward;
+
+vec4 fetchTexel(sampler2D data, int index)
+{
+    int width = textureSize(data, 0).x;
+    return texelFetch(data, ivec2(index % width, index / width), 0);
+}
+
+void addLight(vec3 light, vec3 color, float attenuation, vec3 normal, vec3 viewD, inout vec3 lightDot, inout vec3 specular)
+{
+    float NdotL = max(dot(normal, light), 0.0);
+    lightDot += color*NdotL*attenuation;
+
+    float specCo = 0.0;
+    if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
+    specular += specCo*attenuation;
+}
+
+void main()
+{
+    // Texel color fetching from texture sampler
+    vec4 texelColor = texture(texture0, fragTexCoord);
+    vec3 lightDot = vec3(0.0);
+    vec3 normal = normalize(fragNormal);
+    vec3 viewD = normalize(viewPos - fragPosition);
+    vec3 specular = vec3(0.0);
+
+    for (int i = 0; i < MAX_LIGHTS; i++)
+    {
+        if (lights[i].enabled == 1 && lights[i].type == LIGHT_DIRECTIONAL)
+        {
+            vec3 light = -normalize(lights[i].target - lights[i].position);
+            addLight(light, lights[i].color.rgb, 1.0, normal, viewD, lightDot, specular);
+        }
+    }
+
+    // find this fragment's cluster, the same slicing the CPU binning uses
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy/viewportSize*vec2(clusterDims.xy)), ivec2(0), clusterDims.xy - 1);
+    float depth = dot(fragPosition - viewPos, viewForward);
+    int slice = 0;
+    if (depth > clusterDepth.x) slice = min(int(log(depth/clusterDepth.x)*clusterDepth.y), clusterDims.z - 1);
+
+    vec4 cluster = texelFetch(clusterTable, ivec2(tile.y*clusterDims.x + tile.x, slice), 0);
+    int first = int(cluster.r);
+    int count = int(cluster.g);
+
+    for (int i = 0; i < count; i++)
+    {
+        int lightIndex = int(fetchTexel(lightIndices, first + i).r);
+        vec4 positionRadius = fetchTexel(lightData, lightIndex*2);
+        vec4 color = fetchTexel(lightData, lightIndex*2 + 1);
+
+        vec3 toLight = positionRadius.xyz - fragPosition;
+        float distance = length(toLight);
+        if (distance >= positionRadius.w) continue;
+
+        // smooth falloff that reaches zero at the light's radius
+        float falloff = 1.0 - (distance*distance)/(positionRadius.w*positionRadius.w);
+        addLight(toLight/max(distance, 0.0001), color.rgb, falloff*falloff, normal, viewD, lightDot, specular);
+    }
+
+    finalColor = (texelColor*((colDiffuse + vec4(specular, 1.0))*vec4(lightDot, 1.0)));
+    finalColor += texelColor*(ambient/10.0)*colDiffuse;
+    
+    // Gamma correction
+    finalColor = pow(finalColor, vec4(1.0/2.2));
+}
@@ -0,0 +1,444 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "async_loader.h"
+
+#include "mesh_cache.h"
+#include "mesh_files.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace AsyncLoader
+{
+    struct Waiter
+    {
+        RequestId Id = InvalidRequest;
+        MeshCallback OnMesh;
+        ShaderCallback OnShader;
+        TaskCallback OnTask;
+    };
+
+    struct Request
+    {
+        std::string Key;
+
+        // worker side, returns false on failure
+        std::function<bool()> Work;
+
+        // main thread side, must free whatever Work produced even when there is nobody left waiting
+        std::function<void(Request& request, bool loaded)> Finalize;
+
+        // only touched on the main thread
+        std::vector<Waiter> Waiters;
+
+        // set by the main thread once every waiter is gone, so the worker can skip the load
+        std::atomic<bool> Abandoned = { false };
+
+        bool Loaded = false;
+    };
+
+    using RequestPtr = std::shared_ptr<Request>;
+
+    std::vector<std::thread> Workers;
+    std::mutex QueueLock;
+    std::condition_variable QueueSignal;
+    bool Stopping = false;
+
+    // guarded by QueueLock
+    std::deque<RequestPtr> Queued;
+    std::vector<RequestPtr> Completed;
+
+    // main thread only
+    std::deque<RequestPtr> Finished;
+    std::unordered_map<std::string, RequestPtr> InFlight;
+    std::unordered_map<RequestId, RequestPtr> RequestsById;
+    RequestId NextRequestId = 1;
+
+    // submitted and not finalized yet, wherever they are in the pipeline
+    size_t Outstanding = 0;
+
+    void WorkerThread()
+    {
+        while (true)
+        {
+            RequestPtr request;
+            {
+                std::unique_lock<std::mutex> lock(QueueLock);
+                QueueSignal.wait(lock, []() { return Stopping || !Queued.empty(); });
+
+                if (Stopping)
+                    return;
+
+                request = Queued.front();
+                Queued.pop_front();
+            }
+
+            request->Loaded = !request->Abandoned && request->Work();
+
+            std::lock_guard<std::mutex> lock(QueueLock);
+            Completed.push_back(request);
+        }
+    }
+
+    void Setup(int workerCount)
+    {
+        Stopping = false;
+        for (int i = 0; i < std::max(1, workerCount); i++)
+            Workers.emplace_back(WorkerThread);
+    }
+
+    RequestId AddWaiter(const RequestPtr& request, Waiter waiter)
+    {
+        waiter.Id = NextRequestId++;
+        request->Waiters.push_back(waiter);
+        RequestsById[waiter.Id] = request;
+
+        return waiter.Id;
+    }
+
+    RequestId Submit(const std::string& key, const Waiter& waiter, const std::function<bool()>& work, const std::function<void(Request&, bool)>& finalize)
+    {
+        // join a load of the same thing that is already under way
+        // unless everyone gave up on it, then the worker may already have skipped it
+        auto itr = InFlight.find(key);
+        if (itr != InFlight.end() && !itr->second->Abandoned)
+            return AddWaiter(itr->second, waiter);
+
+        RequestPtr request = std::make_shared<Request>();
+        request->Key = key;
+        request->Work = work;
+        request->Finalize = finalize;
+
+        InFlight[key] = request;
+        RequestId id = AddWaiter(request, waiter);
+        Outstanding++;
+
+        if (Workers.empty())
+        {
+            // no workers, load in place but still hand it over through Update like everything else
+            request->Loaded = request->Work();
+            Finished.push_back(request);
+            return id;
+        }
+
+        std::lock_guard<std::mutex> lock(QueueLock);
+        Queued.push_back(request);
+        QueueSignal.notify_one();
+
+        return id;
+    }
+
+    // a request for something that is already loaded, the callback still waits for Update
+    RequestId SubmitLoaded(const Waiter& waiter, const std::function<void(Request&, bool)>& finalize)
+    {
+        RequestPtr request = std::make_shared<Request>();
+        request->Finalize = finalize;
+        request->Loaded = true;
+
+        RequestId id = AddWaiter(request, waiter);
+        Finished.push_back(request);
+        Outstanding++;
+
+        return id;
+    }
+
+    // first waiter gets the reference from the load, the rest get their own
+    template<class T, class CallbackGetter>
+    void NotifyWaiters(Request& request, T handle, CallbackGetter getCallback)
+    {
+        // callbacks can start or cancel other loads, so work from a copy
+        std::vector<Waiter> waiters;
+        waiters.swap(request.Waiters);
+
+        for (Waiter& waiter : waiters)
+            RequestsById.erase(waiter.Id);
+
+        bool first = true;
+        for (Waiter& waiter : waiters)
+        {
+
+            T waiterHandle = first ? handle : ResourceManager::Retain(handle);
+            first = false;
+
+            auto& callback = getCallback(waiter);
+            if (callback)
+                callback(waiterHandle);
+            else
+                ResourceManager::Release(waiterHandle);
+        }
+
+        if (first)
+            ResourceManager::Release(handle);
+    }
+
+    RequestId LoadMesh(const std::string& key, const MeshBuilder& build, const MeshCallback& done)
+    {
+        Waiter waiter;
+        waiter.OnMesh = done;
+
+        auto getCallback = [](Waiter& waiter) -> MeshCallback& { return waiter.OnMesh; };
+
+        ResourceManager::MeshHandle existing = ResourceManager::FindMesh(key);
+        if (existing.IsValid())
+        {
+            return SubmitLoaded(waiter, [existing, getCallback](Request& request, bool)
+                {
+                    NotifyWaiters(request, existing, getCallback);
+                });
+        }
+
+        auto mesh = std::make_shared<Mesh>();
+        *mesh = Mesh{ 0 };
+
+        return Submit("mesh:" + key, waiter,
+            [mesh, build]()
+            {
+                return build(*mesh);
+            },
+            [mesh, key, getCallback](Request& request, bool loaded)
+            {
+                ResourceManager::MeshHandle handle;
+                if (loaded && !request.Waiters.empty())
+                {
+                    // meshes mapped from the cache point into the file and need their own unload
+                    bool created = false;
+                    handle = ResourceManager::AcquireMesh(key, [&]()
+                        {
+                            created = true;
+                            UploadMesh(mesh.get(), false);
+                            return *mesh;
+                        }, MeshCache::IsMapped(*mesh) ? MeshCache::UnloadMappedMesh : nullptr);
+
+                    if (!created)
+                        MeshFiles::UnloadMeshData(*mesh);
+                }
+                else
+                {
+                    MeshFiles::UnloadMeshData(*mesh);
+                }
+
+                NotifyWaiters(request, handle, getCallback);
+            });
+    }
+
+    RequestId LoadMeshFile(const char* fileName, const MeshCallback& done)
+    {
+        std::string path = fileName;
+        return LoadMesh(path, [path](Mesh& mesh) { return MeshFiles::LoadMeshData(path.c_str(), mesh); }, done);
+    }
+
+    RequestId LoadShader(const char* vsFileName, const char* fsFileName, const ShaderCallback& done)
+    {
+        Waiter waiter;
+        waiter.OnShader = done;
+
+        auto getCallback = [](Waiter& waiter) -> ShaderCallback& { return waiter.OnShader; };
+
+        std::string key = ResourceManager::GetShaderKey(vsFileName, fsFileName);
+
+        ResourceManager::ShaderHandle existing = ResourceManager::FindShader(key);
+        if (existing.IsValid())
+        {
+            return SubmitLoaded(waiter, [existing, getCallback](Request& request, bool)
+                {
+                    NotifyWaiters(request, existing, getCallback);
+                });
+        }
+
+        struct ShaderSource
+        {
+            std::string VSPath, FSPath;
+            std::string VSCode, FSCode;
+        };
+
+        auto source = std::make_shared<ShaderSource>();
+        source->VSPath = (vsFileName != nullptr) ? vsFileName : "";
+        source->FSPath = (fsFileName != nullptr) ? fsFileName : "";
+
+        return Submit("shader:" + key, waiter,
+            [source]()
+            {
+                // an empty path keeps raylib's default for that stage
+                for (int stage = 0; stage < 2; stage++)
+                {
+                    const std::string& path = (stage == 0) ? source->VSPath : source->FSPath;
+                    if (path.empty())
+                        continue;
+
+                    char* text = LoadFileText(path.c_str());
+                    if (text == nullptr)
+                        return false;
+
+                    ((stage == 0) ? source->VSCode : source->FSCode) = text;
+                    UnloadFileText(text);
+                }
+
+                return true;
+            },
+            [source, key, getCallback](Request& request, bool loaded)
+            {
+                ResourceManager::ShaderHandle handle;
+                if (loaded && !request.Waiters.empty())
+                {
+                    handle = ResourceManager::AcquireShader(key, [&]()
+                        {
+                            return LoadShaderFromMemory(source->VSPath.empty() ? nullptr : source->VSCode.c_str(),
+                                source->FSPath.empty() ? nullptr : source->FSCode.c_str());
+                        });
+                }
+
+                NotifyWaiters(request, handle, getCallback);
+            });
+    }
+
+    RequestId LoadTask(const std::string& key, const TaskWork& work, const TaskCallback& done)
+    {
+        Waiter waiter;
+        waiter.OnTask = done;
+
+        return Submit("task:" + key, waiter, work,
+            [](Request& request, bool loaded)
+            {
+                std::vector<Waiter> waiters;
+                waiters.swap(request.Waiters);
+
+                for (Waiter& waiter : waiters)
+                    RequestsById.erase(waiter.Id);
+
+                for (Waiter& waiter : waiters)
+                {
+                    if (waiter.OnTask)
+                        waiter.OnTask(loaded);
+                }
+            });
+    }
+
+    void Cancel(RequestId id)
+    {
+        auto itr = RequestsById.find(id);
+        if (itr == RequestsById.end())
+            return;
+
+        RequestPtr request = itr->second;
+        RequestsById.erase(itr);
+
+        auto& waiters = request->Waiters;
+        for (size_t i = 0; i < waiters.size(); i++)
+        {
+            if (waiters[i].Id == id)
+            {
+                waiters.erase(waiters.begin() + i);
+                break;
+            }
+        }
+
+        if (waiters.empty())
+            request->Abandoned = true;
+    }
+
+    int Update(float budgetMs)
+    {
+        {
+            std::lock_guard<std::mutex> lock(QueueLock);
+            Finished.insert(Finished.end(), Completed.begin(), Completed.end());
+            Completed.clear();
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        int finalized = 0;
+        while (!Finished.empty())
+        {
+            RequestPtr request = Finished.front();
+            Finished.pop_front();
+
+            // a newer request may have taken the key over if this one was abandoned
+            auto inFlight = InFlight.find(request->Key);
+            if (inFlight != InFlight.end() && inFlight->second == request)
+                InFlight.erase(inFlight);
+
+            request->Finalize(*request, request->Loaded);
+            finalized++;
+            Outstanding--;
+
+            if (std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count() >= budgetMs)
+                break;
+        }
+
+        return finalized;
+    }
+
+    ResourceManager::MeshHandle AcquirePlaceholderMesh()
+    {
+        return ResourceManager::AcquireMesh("placeholder", []() { return GenMeshCube(1, 1, 1); });
+    }
+
+    size_t GetPendingCount()
+    {
+        return Outstanding;
+    }
+
+    void Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(QueueLock);
+            Stopping = true;
+        }
+        QueueSignal.notify_all();
+
+        for (std::thread& worker : Workers)
+            worker.join();
+        Workers.clear();
+
+        // nobody gets called back, but whatever was loaded still has to be freed
+        Finished.insert(Finished.end(), Completed.begin(), Completed.end());
+        Finished.insert(Finished.end(), Queued.begin(), Queued.end());
+        Completed.clear();
+        Queued.clear();
+
+        for (RequestPtr& request : Finished)
+        {
+            request->Waiters.clear();
+            request->Finalize(*request, false);
+        }
+
+        Finished.clear();
+        Outstanding = 0;
+        InFlight.clear();
+        RequestsById.clear();
+    }
+}
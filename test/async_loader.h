@@ -0,0 +1,82 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "resource_manager.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+// loads assets in the background, file reads and parsing run on worker threads
+// and only the GPU upload happens on the main thread, spread over frames by a time budget
+namespace AsyncLoader
+{
+    using RequestId = uint64_t;
+    constexpr RequestId InvalidRequest = 0;
+
+    constexpr float DefaultFinalizeBudgetMs = 2.0f;
+
+    // runs on a worker, must only build CPU data and never touch the GPU
+    using MeshBuilder = std::function<bool(Mesh& mesh)>;
+
+    // called on the main thread from Update, the handle carries one reference for the receiver
+    // and is invalid if the load failed
+    using MeshCallback = std::function<void(ResourceManager::MeshHandle handle)>;
+    using ShaderCallback = std::function<void(ResourceManager::ShaderHandle handle)>;
+
+    // for loads that are not GPU resources, work runs on a worker and done on the main thread with its result
+    using TaskWork = std::function<bool()>;
+    using TaskCallback = std::function<void(bool loaded)>;
+
+    void Setup(int workerCount = 1);
+    void Shutdown();
+
+    // loads that share a key while in flight are only done once
+    RequestId LoadMesh(const std::string& key, const MeshBuilder& build, const MeshCallback& done);
+    RequestId LoadMeshFile(const char* fileName, const MeshCallback& done);
+    RequestId LoadShader(const char* vsFileName, const char* fsFileName, const ShaderCallback& done);
+
+    // work is skipped if every waiter cancels before a worker gets to it
+    RequestId LoadTask(const std::string& key, const TaskWork& work, const TaskCallback& done);
+
+    // the callback will not run, safe to call with a request that already finished
+    void Cancel(RequestId request);
+
+    // finalizes finished loads until the budget is spent (always at least one), returns how many ran
+    int Update(float budgetMs = DefaultFinalizeBudgetMs);
+
+    // a shared unit cube to draw while the real mesh loads
+    ResourceManager::MeshHandle AcquirePlaceholderMesh();
+
+    size_t GetPendingCount();
+}
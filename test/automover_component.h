@@ -33,7 +33,7 @@
 
 #include "raylib.h"
 
-// a component that uses the update event
+// a data only component, the AutoMoverSystem moves all of them in one pass
 
 class AutoMoverComponent : public Component
 {
@@ -45,24 +45,4 @@ public:
 
 public:
     DEFINE_COMPONENT(AutoMoverComponent);
-
-    inline void OnCreate() override { NeedUpdate = true; }
-
-    inline void OnUpdate()
-    {
-        TransformComponent* transform = ComponentManager::MustGetComponent<TransformComponent>(this);
-
-        float delta = GetFrameTime();
-
-        transform->RotatePitch(AngularSpeed.x * delta);
-        if (UseHeading)
-            transform->RotateHeading(AngularSpeed.y * delta);
-        else
-            transform->RotateYaw(AngularSpeed.y * delta);
-        transform->RotateRoll(AngularSpeed.z * delta);
-
-        transform->MoveRight(LinearSpeed.x * delta);
-        transform->MoveForward(LinearSpeed.y * delta);
-        transform->MoveUp(LinearSpeed.z * delta);
-    }
 };
\ No newline at end of file
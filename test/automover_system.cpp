@@ -0,0 +1,312 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "automover_system.h"
+
+#include "automover_component.h"
+#include "transform_component.h"
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <math.h>
+#include <xmmintrin.h>
+
+namespace AutoMoverSystem
+{
+    // one step of pitch, yaw and roll folded into a single rotation, rebuilt only when the angles change
+    // the new forward and up are combinations of the old forward, up and left, heading then turns both around world Z
+    struct StepRotation
+    {
+        Vector3 Angles = { 0 };
+        bool Heading = false;
+        bool Valid = false;
+
+        float Forward[3] = { 1, 0, 0 };
+        float Up[3] = { 0, 1, 0 };
+        float HeadingSin = 0;
+        float HeadingCos = 1;
+    };
+
+    struct MoverEntry
+    {
+        AutoMoverComponent* Mover = nullptr;
+        TransformComponent* Transform = nullptr;
+        StepRotation Step;
+    };
+
+    // packed list of every mover and the transform it drives
+    std::vector<MoverEntry> Movers;
+
+    // structure of arrays work buffers, reused every frame and padded to whole groups of four for the SSE loop
+    struct MoverBatch
+    {
+        std::vector<TransformComponent*> Transforms;
+
+        std::vector<float> PX, PY, PZ;
+        std::vector<float> FX, FY, FZ;
+        std::vector<float> UX, UY, UZ;
+
+        std::vector<float> F0, F1, F2;
+        std::vector<float> U0, U1, U2;
+        std::vector<float> HeadingSin, HeadingCos;
+        std::vector<float> MoveRight, MoveForward, MoveUp;
+
+        void Resize(size_t count)
+        {
+            Transforms.resize(count);
+
+            for (std::vector<float>* stream : Streams())
+                stream->resize((count + 3) & ~size_t(3));
+        }
+
+        // zero the lanes between the last mover and the end of its group of four
+        void ClearPadding(size_t count)
+        {
+            for (std::vector<float>* stream : Streams())
+                std::fill(stream->begin() + count, stream->begin() + ((count + 3) & ~size_t(3)), 0.0f);
+        }
+
+        std::array<std::vector<float>*, 20> Streams()
+        {
+            return { &PX, &PY, &PZ, &FX, &FY, &FZ, &UX, &UY, &UZ, &F0, &F1, &F2, &U0, &U1, &U2,
+                &HeadingSin, &HeadingCos, &MoveRight, &MoveForward, &MoveUp };
+        }
+    };
+
+    MoverBatch Batch;
+
+    void OnMoverAdded(Component* component)
+    {
+        MoverEntry entry;
+        entry.Mover = static_cast<AutoMoverComponent*>(component);
+        entry.Transform = ComponentManager::MustGetComponent<TransformComponent>(component);
+        Movers.push_back(entry);
+    }
+
+    void OnMoverRemoved(Component* component)
+    {
+        auto itr = std::find_if(Movers.begin(), Movers.end(), [component](const MoverEntry& entry) { return entry.Mover == component; });
+        if (itr == Movers.end())
+            return;
+
+        *itr = Movers.back();
+        Movers.pop_back();
+    }
+
+    void OnTransformRemoved(Component* component)
+    {
+        for (MoverEntry& entry : Movers)
+        {
+            if (entry.Transform == component)
+                entry.Transform = nullptr;
+        }
+    }
+
+    void Setup()
+    {
+        Movers.clear();
+        ComponentManager::DoForEachEntity<AutoMoverComponent>([](AutoMoverComponent* mover) { OnMoverAdded(mover); });
+
+        ComponentManager::AddAddObserver<AutoMoverComponent>(OnMoverAdded);
+        ComponentManager::AddRemoveObserver<AutoMoverComponent>(OnMoverRemoved);
+        ComponentManager::AddRemoveObserver<TransformComponent>(OnTransformRemoved);
+    }
+
+    // pitch around left, yaw around up, then roll around the new forward, all in the mover's own frame
+    // with heading the yaw goes around world Z instead, a roll about the forward vector commutes with that so it still folds in here
+    void BuildStepRotation(StepRotation& step, const Vector3& angles, bool heading)
+    {
+        float localYaw = heading ? 0.0f : angles.y;
+        float worldYaw = heading ? angles.y : 0.0f;
+
+        float sp = sinf(angles.x), cp = cosf(angles.x);
+        float sy = sinf(localYaw), cy = cosf(localYaw);
+        float sr = sinf(angles.z), cr = cosf(angles.z);
+
+        step.Forward[0] = cy * cp;
+        step.Forward[1] = -cy * sp;
+        step.Forward[2] = sy;
+
+        step.Up[0] = cr * sp + sr * sy * cp;
+        step.Up[1] = cr * cp - sr * sy * sp;
+        step.Up[2] = -sr * cy;
+
+        step.HeadingSin = sinf(worldYaw);
+        step.HeadingCos = cosf(worldYaw);
+
+        step.Angles = angles;
+        step.Heading = heading;
+        step.Valid = true;
+    }
+
+    size_t Gather(float deltaTime)
+    {
+        Batch.Resize(Movers.size());
+
+        size_t count = 0;
+        for (MoverEntry& entry : Movers)
+        {
+            if (!entry.Mover->Active)
+                continue;
+
+            if (entry.Transform == nullptr)
+                entry.Transform = ComponentManager::MustGetComponent<TransformComponent>(entry.Mover);
+
+            TransformComponent* transform = entry.Transform;
+            const Vector3& pos = transform->GetPosition();
+            const Vector3& forward = transform->GetForwardVector();
+            const Vector3& up = transform->GetUpVector();
+
+            Batch.Transforms[count] = transform;
+            Batch.PX[count] = pos.x; Batch.PY[count] = pos.y; Batch.PZ[count] = pos.z;
+            Batch.FX[count] = forward.x; Batch.FY[count] = forward.y; Batch.FZ[count] = forward.z;
+            Batch.UX[count] = up.x; Batch.UY[count] = up.y; Batch.UZ[count] = up.z;
+
+            // with a fixed tick the step angles only change when the speed does, so the trig is rarely redone
+            float angleScale = deltaTime * DEG2RAD;
+            Vector3 angles = Vector3Scale(entry.Mover->AngularSpeed, angleScale);
+
+            StepRotation& step = entry.Step;
+            if (!step.Valid || step.Heading != entry.Mover->UseHeading || angles.x != step.Angles.x || angles.y != step.Angles.y || angles.z != step.Angles.z)
+                BuildStepRotation(step, angles, entry.Mover->UseHeading);
+
+            Batch.F0[count] = step.Forward[0]; Batch.F1[count] = step.Forward[1]; Batch.F2[count] = step.Forward[2];
+            Batch.U0[count] = step.Up[0]; Batch.U1[count] = step.Up[1]; Batch.U2[count] = step.Up[2];
+            Batch.HeadingSin[count] = step.HeadingSin;
+            Batch.HeadingCos[count] = step.HeadingCos;
+
+            const Vector3& linear = entry.Mover->LinearSpeed;
+            Batch.MoveRight[count] = linear.x * deltaTime;
+            Batch.MoveForward[count] = linear.y * deltaTime;
+            Batch.MoveUp[count] = linear.z * deltaTime;
+
+            count++;
+        }
+
+        Batch.ClearPadding(count);
+        return count;
+    }
+
+    inline __m128 Dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+    }
+
+    // a zero vector stays zero instead of turning into NaNs
+    inline void Normalize(__m128& x, __m128& y, __m128& z)
+    {
+        __m128 length = _mm_sqrt_ps(_mm_max_ps(Dot(x, y, z, x, y, z), _mm_set1_ps(1e-30f)));
+        x = _mm_div_ps(x, length);
+        y = _mm_div_ps(y, length);
+        z = _mm_div_ps(z, length);
+    }
+
+    inline __m128 Combine(__m128 a, __m128 b, __m128 c, __m128 wa, __m128 wb, __m128 wc)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, wa), _mm_mul_ps(b, wb)), _mm_mul_ps(c, wc));
+    }
+
+    // applies the step rotation and then the three moves along the new axes, four movers at a time
+    // the batch is padded with zeros past the count, those lanes are computed and never scattered
+    void Integrate(size_t count)
+    {
+        float* px = Batch.PX.data(); float* py = Batch.PY.data(); float* pz = Batch.PZ.data();
+        float* fx = Batch.FX.data(); float* fy = Batch.FY.data(); float* fz = Batch.FZ.data();
+        float* ux = Batch.UX.data(); float* uy = Batch.UY.data(); float* uz = Batch.UZ.data();
+
+        for (size_t i = 0; i < count; i += 4)
+        {
+            __m128 Fx = _mm_loadu_ps(fx + i), Fy = _mm_loadu_ps(fy + i), Fz = _mm_loadu_ps(fz + i);
+            __m128 Ux = _mm_loadu_ps(ux + i), Uy = _mm_loadu_ps(uy + i), Uz = _mm_loadu_ps(uz + i);
+
+            // left is up cross forward
+            __m128 Lx = _mm_sub_ps(_mm_mul_ps(Uy, Fz), _mm_mul_ps(Uz, Fy));
+            __m128 Ly = _mm_sub_ps(_mm_mul_ps(Uz, Fx), _mm_mul_ps(Ux, Fz));
+            __m128 Lz = _mm_sub_ps(_mm_mul_ps(Ux, Fy), _mm_mul_ps(Uy, Fx));
+            Normalize(Lx, Ly, Lz);
+
+            __m128 f0 = _mm_loadu_ps(Batch.F0.data() + i), f1 = _mm_loadu_ps(Batch.F1.data() + i), f2 = _mm_loadu_ps(Batch.F2.data() + i);
+            __m128 u0 = _mm_loadu_ps(Batch.U0.data() + i), u1 = _mm_loadu_ps(Batch.U1.data() + i), u2 = _mm_loadu_ps(Batch.U2.data() + i);
+
+            __m128 nFx = Combine(Fx, Ux, Lx, f0, f1, f2), nFy = Combine(Fy, Uy, Ly, f0, f1, f2), nFz = Combine(Fz, Uz, Lz, f0, f1, f2);
+            __m128 nUx = Combine(Fx, Ux, Lx, u0, u1, u2), nUy = Combine(Fy, Uy, Ly, u0, u1, u2), nUz = Combine(Fz, Uz, Lz, u0, u1, u2);
+
+            // heading turns around world Z, it is the identity for movers without it
+            __m128 hs = _mm_loadu_ps(Batch.HeadingSin.data() + i), hc = _mm_loadu_ps(Batch.HeadingCos.data() + i);
+            Fx = _mm_sub_ps(_mm_mul_ps(nFx, hc), _mm_mul_ps(nFy, hs));
+            Fy = _mm_add_ps(_mm_mul_ps(nFx, hs), _mm_mul_ps(nFy, hc));
+            Fz = nFz;
+            Ux = _mm_sub_ps(_mm_mul_ps(nUx, hc), _mm_mul_ps(nUy, hs));
+            Uy = _mm_add_ps(_mm_mul_ps(nUx, hs), _mm_mul_ps(nUy, hc));
+            Uz = nUz;
+
+            Normalize(Fx, Fy, Fz);
+            Normalize(Ux, Uy, Uz);
+
+            // all three moves use the final axes, so they fold into one position delta
+            __m128 right = _mm_loadu_ps(Batch.MoveRight.data() + i);
+            __m128 forward = _mm_loadu_ps(Batch.MoveForward.data() + i);
+            __m128 up = _mm_loadu_ps(Batch.MoveUp.data() + i);
+
+            __m128 Rx = _mm_sub_ps(_mm_mul_ps(Fy, Uz), _mm_mul_ps(Fz, Uy));
+            __m128 Ry = _mm_sub_ps(_mm_mul_ps(Fz, Ux), _mm_mul_ps(Fx, Uz));
+            __m128 Rz = _mm_sub_ps(_mm_mul_ps(Fx, Uy), _mm_mul_ps(Fy, Ux));
+
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), Combine(Rx, Fx, Ux, right, forward, up)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), Combine(Ry, Fy, Uy, right, forward, up)));
+            _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), Combine(Rz, Fz, Uz, right, forward, up)));
+
+            _mm_storeu_ps(fx + i, Fx); _mm_storeu_ps(fy + i, Fy); _mm_storeu_ps(fz + i, Fz);
+            _mm_storeu_ps(ux + i, Ux); _mm_storeu_ps(uy + i, Uy); _mm_storeu_ps(uz + i, Uz);
+        }
+    }
+
+    void Scatter(size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Batch.Transforms[i]->SetLocalFrame(Vector3{ Batch.PX[i], Batch.PY[i], Batch.PZ[i] },
+                Vector3{ Batch.FX[i], Batch.FY[i], Batch.FZ[i] },
+                Vector3{ Batch.UX[i], Batch.UY[i], Batch.UZ[i] });
+        }
+    }
+
+    void Update(float deltaTime)
+    {
+        size_t count = Gather(deltaTime);
+        if (count == 0)
+            return;
+
+        Integrate(count);
+        Scatter(count);
+    }
+}
@@ -0,0 +1,174 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <math.h>
+
+// world space bounds and view frustum helpers shared by the culling code
+
+// planes are stored as normal (xyz) and distance (w), a point is inside when dot(normal, point) + distance >= 0
+struct Frustum
+{
+    Vector4 Planes[6];
+};
+
+inline Vector4 NormalizePlane(float x, float y, float z, float w)
+{
+    float length = sqrtf(x * x + y * y + z * z);
+    if (length == 0)
+        length = 1;
+
+    return Vector4{ x / length, y / length, z / length, w / length };
+}
+
+// extract the six planes from a combined view projection matrix (Gribb/Hartmann)
+inline Frustum FrustumFromMatrix(const Matrix& viewProjection)
+{
+    const Matrix& m = viewProjection;
+    Frustum frustum;
+
+    frustum.Planes[0] = NormalizePlane(m.m3 + m.m0, m.m7 + m.m4, m.m11 + m.m8, m.m15 + m.m12);    // left
+    frustum.Planes[1] = NormalizePlane(m.m3 - m.m0, m.m7 - m.m4, m.m11 - m.m8, m.m15 - m.m12);    // right
+    frustum.Planes[2] = NormalizePlane(m.m3 + m.m1, m.m7 + m.m5, m.m11 + m.m9, m.m15 + m.m13);    // bottom
+    frustum.Planes[3] = NormalizePlane(m.m3 - m.m1, m.m7 - m.m5, m.m11 - m.m9, m.m15 - m.m13);    // top
+    frustum.Planes[4] = NormalizePlane(m.m3 + m.m2, m.m7 + m.m6, m.m11 + m.m10, m.m15 + m.m14);   // near
+    frustum.Planes[5] = NormalizePlane(m.m3 - m.m2, m.m7 - m.m6, m.m11 - m.m10, m.m15 - m.m14);   // far
+
+    return frustum;
+}
+
+// the same view and projection BeginMode3D sets up for a perspective camera
+inline Matrix GetCameraViewProjection(const Camera3D& camera, float aspect, float nearPlane, float farPlane)
+{
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, nearPlane, farPlane);
+
+    return MatrixMultiply(view, projection);
+}
+
+inline Frustum FrustumFromCamera(const Camera3D& camera, float aspect, float nearPlane, float farPlane)
+{
+    return FrustumFromMatrix(GetCameraViewProjection(camera, aspect, nearPlane, farPlane));
+}
+
+// true if any part of the box is on the inside of every plane
+inline bool FrustumContainsBox(const Frustum& frustum, const BoundingBox& box)
+{
+    for (const Vector4& plane : frustum.Planes)
+    {
+        // test the corner furthest along the plane normal
+        float x = plane.x >= 0 ? box.max.x : box.min.x;
+        float y = plane.y >= 0 ? box.max.y : box.min.y;
+        float z = plane.z >= 0 ? box.max.z : box.min.z;
+
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0)
+            return false;
+    }
+
+    return true;
+}
+
+// the axis aligned box that contains the transformed box (Arvo)
+inline BoundingBox TransformBoundingBox(const BoundingBox& box, const Matrix& m)
+{
+    Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 extents = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+    Vector3 newCenter = Vector3Transform(center, m);
+    Vector3 newExtents =
+    {
+        fabsf(m.m0) * extents.x + fabsf(m.m4) * extents.y + fabsf(m.m8) * extents.z,
+        fabsf(m.m1) * extents.x + fabsf(m.m5) * extents.y + fabsf(m.m9) * extents.z,
+        fabsf(m.m2) * extents.x + fabsf(m.m6) * extents.y + fabsf(m.m10) * extents.z
+    };
+
+    return BoundingBox{ Vector3Subtract(newCenter, newExtents), Vector3Add(newCenter, newExtents) };
+}
+
+inline BoundingBox BoundingBoxUnion(const BoundingBox& a, const BoundingBox& b)
+{
+    return BoundingBox{ Vector3Min(a.min, b.min), Vector3Max(a.max, b.max) };
+}
+
+inline float BoundingBoxSurfaceArea(const BoundingBox& box)
+{
+    Vector3 size = Vector3Subtract(box.max, box.min);
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+inline bool BoundingBoxContains(const BoundingBox& outer, const BoundingBox& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+        outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+inline bool BoundingBoxOverlaps(const BoundingBox& a, const BoundingBox& b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+        a.min.y <= b.max.y && a.max.y >= b.min.y &&
+        a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+inline bool SphereOverlapsBox(const Vector3& center, float radius, const BoundingBox& box)
+{
+    float dx = fmaxf(fmaxf(box.min.x - center.x, 0.0f), center.x - box.max.x);
+    float dy = fmaxf(fmaxf(box.min.y - center.y, 0.0f), center.y - box.max.y);
+    float dz = fmaxf(fmaxf(box.min.z - center.z, 0.0f), center.z - box.max.z);
+
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+// slab test, inverseDirection is 1/ray.direction per axis. on a hit distance is where the ray enters the box (0 if it starts inside)
+inline bool RayIntersectsBox(const Ray& ray, const Vector3& inverseDirection, const BoundingBox& box, float maxDistance, float& distance)
+{
+    float t1 = (box.min.x - ray.position.x) * inverseDirection.x;
+    float t2 = (box.max.x - ray.position.x) * inverseDirection.x;
+    float tMin = fminf(t1, t2);
+    float tMax = fmaxf(t1, t2);
+
+    t1 = (box.min.y - ray.position.y) * inverseDirection.y;
+    t2 = (box.max.y - ray.position.y) * inverseDirection.y;
+    tMin = fmaxf(tMin, fminf(t1, t2));
+    tMax = fminf(tMax, fmaxf(t1, t2));
+
+    t1 = (box.min.z - ray.position.z) * inverseDirection.z;
+    t2 = (box.max.z - ray.position.z) * inverseDirection.z;
+    tMin = fmaxf(tMin, fminf(t1, t2));
+    tMax = fminf(tMax, fmaxf(t1, t2));
+
+    tMin = fmaxf(tMin, 0.0f);
+    if (tMax < tMin || tMin > maxDistance)
+        return false;
+
+    distance = tMin;
+    return true;
+}
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "components.h"
+#include "interpolated_matrix.h"
 
 #include "raylib.h"
 #include "raymath.h"
@@ -39,6 +40,9 @@ class CameraComponent : public Component
 public:
     float FOVY = 45;
 
+    // the transform's world matrix blended between fixed steps, see FixedStepRunner
+    InterpolatedMatrix Interpolation;
+
 public:
     DEFINE_COMPONENT(CameraComponent);
 };
\ No newline at end of file
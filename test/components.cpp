@@ -44,7 +44,14 @@ public:
 
     bool Add(Component* component)
     {
-        ComponentList& components = Entities[component->EntityId];
+        // new entities get the highest id so far, appending with a hint skips the tree search
+        auto entity = Entities.end();
+        if (!Entities.empty() && Entities.rbegin()->first < component->EntityId)
+            entity = Entities.emplace_hint(Entities.end(), component->EntityId, ComponentList());
+        else
+            entity = Entities.try_emplace(component->EntityId).first;
+
+        ComponentList& components = entity->second;
         if (components.empty())
         {
             components.push_back(component);
@@ -186,7 +193,7 @@ namespace ComponentManager
 
     void RemoveEntity(uint64_t entityId)
     {
-        for (auto componentTable : ComponentDB)
+        for (auto& componentTable : ComponentDB)
         {
             EraseAllComponents(componentTable.first, entityId);
         }
@@ -218,7 +225,7 @@ namespace ComponentManager
 
     void DoForEachComponentInEntity(uint64_t entityId, std::function<void(Component*)> func)
     {
-        for (auto componentTable : ComponentDB)
+        for (auto& componentTable : ComponentDB)
         {
             auto entityItr = componentTable.second.Entities.find(entityId);
             if (entityItr == componentTable.second.Entities.end())
@@ -196,7 +196,7 @@ namespace ComponentManager
     }
 
     template<class T>
-    inline void AddAddbs(Component* component)
+    inline T* AddAddbs(Component* component)
     {
         T* newComponent = static_cast<T*>(FindComponent(T::GetComponentId(), component->EntityId));
         if (newComponent != nullptr)
@@ -36,22 +36,19 @@
 #include "rlgl.h"
 
 #include "color_component.h"
-
-class Drawable3DComponent : public Component
-{
-public:
-    DEFINE_COMPONENT(Drawable3DComponent);
-
-    inline virtual void Draw(const Camera3D& camera) {}
-};
-
-enum class DrawShape
-{
-    Box,
-    Sphere,
-    Cylinder,
-    Plane
-};
+#include "bounds.h"
+#include "lod.h"
+#include "draw_shape.h"
+#include "render_queue.h"
+#include "shape_batch_builder.h"
+#include "render_backend.h"
+#include "primitive_mesh_cache.h"
+#include "primitive_meshes.h"
+#include "resource_manager.h"
+#include "async_loader.h"
+#include "interpolated_matrix.h"
+
+#include <string.h>
 
 class OffsetTransform
 {
@@ -68,6 +65,18 @@ public:
         rlTranslatef(Offset.x, Offset.y, Offset.z);
     }
 
+    // the same transform Apply pushes to rlgl, as a matrix
+    inline Matrix GetMatrix() const
+    {
+        if (IsZero)
+            return MatrixIdentity();
+
+        Matrix matrix = MatrixTranslate(Offset.x, Offset.y, Offset.z);
+        matrix = MatrixMultiply(matrix, MatrixRotateZ(Rotation.z * DEG2RAD));
+        matrix = MatrixMultiply(matrix, MatrixRotateY(Rotation.y * DEG2RAD));
+        return MatrixMultiply(matrix, MatrixRotateX(Rotation.x * DEG2RAD));
+    }
+
     inline void SetOffset(float x, float y, float z)
     {
         Offset = { x,y,z };
@@ -80,6 +89,11 @@ public:
         CheckZero();
     }
 
+    inline const Vector3& GetOffset() const { return Offset; }
+    inline const Vector3& GetRotation() const { return Rotation; }
+
+    inline uint32_t GetVersion() const { return Version; }
+
 private:
     Vector3 Offset = { 0,0,0 };
     Vector3 Rotation{ 0,0,0 };
@@ -87,9 +101,169 @@ private:
     void CheckZero()
     {
         IsZero = (Offset.x == 0 && Offset.y == 0 && Offset.z == 0 && Rotation.x == 0 && Rotation.y == 0 && Rotation.z == 0);
+        Version++;
     }
 
     bool IsZero = true;
+    uint32_t Version = 0;
+};
+
+class Drawable3DComponent : public Component
+{
+public:
+    OffsetTransform Offset;
+
+    // set by the StaticBatchSystem while this drawable is baked into a batch, the render system skips it
+    bool StaticBatched = false;
+
+    // set by OcclusionCulling for drawables on occluder entities, they hide others but are never tested themselves
+    bool Occluder = false;
+
+    // the world matrix blended between fixed steps, see FixedStepRunner
+    InterpolatedMatrix Interpolation;
+
+public:
+    DEFINE_COMPONENT(Drawable3DComponent);
+
+    inline virtual void Draw(const Camera3D& camera) {}
+
+    // what the render queue sorts on, drawables that share all three can be drawn without any state change
+    inline virtual RenderPipeline GetPipeline() { return RenderPipeline::Opaque; }
+    inline virtual uint16_t GetGeometryId() { return 0; }
+    inline virtual uint32_t GetMaterialId() { return 0; }
+
+    // level 0 is full detail, each level after it is coarser
+    inline virtual int GetLODCount() { return 1; }
+
+    // the smallest projected size in pixels a level is used at
+    inline virtual float GetLODScreenSize(int level) { return 0; }
+
+    // triangles drawn at the current level
+    inline virtual int GetTriangleCount() { return 0; }
+
+    inline int GetLOD() const { return CurrentLOD; }
+
+    // the full detail CPU side mesh, the matrix that places it in the world and the material it is drawn with, for baking into static batches
+    inline virtual const Mesh* GetStaticMesh(Matrix& model, Material*& material) { return nullptr; }
+
+    // the color the drawable is tinted with
+    inline virtual Color GetTint() { return WHITE; }
+
+    // pick the level for the projected size from this camera, a level only changes once the size is clearly past its threshold
+    inline int UpdateLOD(const Camera3D& camera, float viewportHeight)
+    {
+        int levels = GetLODCount();
+        if (levels > LOD::MaxLevels)
+            levels = LOD::MaxLevels;
+
+        if (levels <= 1)
+        {
+            CurrentLOD = 0;
+            return CurrentLOD;
+        }
+
+        float screenSize = LOD::GetScreenSize(GetWorldBounds(), camera, viewportHeight);
+
+        int level = levels - 1;
+        for (int i = 0; i < levels - 1; i++)
+        {
+            // moving to a finer level needs the size to be above the threshold by the margin, staying or going coarser needs it below
+            float threshold = GetLODScreenSize(i) * (i < CurrentLOD ? 1 + LOD::Hysteresis : 1 - LOD::Hysteresis);
+            if (screenSize >= threshold)
+            {
+                level = i;
+                break;
+            }
+        }
+
+        CurrentLOD = level;
+        return CurrentLOD;
+    }
+
+    // world space bounds, only recomputed when the transform, offset or local bounds change
+    inline const BoundingBox& GetWorldBounds()
+    {
+        UpdateWorldCache();
+        return WorldBounds;
+    }
+
+    // the offset combined with the transform's world matrix
+    inline const Matrix& GetWorldMatrix()
+    {
+        UpdateWorldCache();
+        return WorldMatrix;
+    }
+
+    // bumped each time the world matrix or bounds are recomputed, as of the last call that read them
+    inline uint32_t GetWorldCacheVersion() const
+    {
+        return WorldCacheVersion;
+    }
+
+    // the matrix to draw with, the world matrix blended between fixed steps while the simulation is interpolated
+    // culling and picking keep using GetWorldMatrix and GetWorldBounds
+    inline const Matrix& GetDrawMatrix()
+    {
+        UpdateWorldCache();
+        return Interpolation.Get(WorldMatrix, WorldCacheVersion);
+    }
+
+    // the local bounds as an oriented box in world space, corner i is at max x when bit 0 is set, max y for bit 1 and max z for bit 2
+    inline void GetWorldCorners(Vector3 corners[8])
+    {
+        UpdateWorldCache();
+        BoundingBox local = GetLocalBounds();
+
+        for (int i = 0; i < 8; i++)
+        {
+            Vector3 corner = { (i & 1) ? local.max.x : local.min.x, (i & 2) ? local.max.y : local.min.y, (i & 4) ? local.max.z : local.min.z };
+            corners[i] = Vector3Transform(corner, WorldMatrix);
+        }
+    }
+
+protected:
+    inline virtual BoundingBox GetLocalBounds() { return BoundingBox{ Vector3Zero(), Vector3Zero() }; }
+
+    // return true when something GetLocalBounds depends on has changed since the last call
+    inline virtual bool LocalBoundsChanged() { return false; }
+
+private:
+    BoundingBox WorldBounds = { 0 };
+    Matrix WorldMatrix = { 0 };
+
+    TransformComponent* CachedTransform = nullptr;
+    uint32_t CachedWorldVersion = 0;
+    uint32_t CachedOffsetVersion = 0;
+    uint32_t WorldCacheVersion = 0;
+    bool CacheValid = false;
+
+    int CurrentLOD = 0;
+
+    inline void UpdateWorldCache()
+    {
+        TransformComponent* transform = GetComponent<TransformComponent>();
+
+        Matrix transformMatrix = MatrixIdentity();
+        uint32_t worldVersion = 0;
+        if (transform != nullptr)
+        {
+            transformMatrix = transform->GetWorldMatrix();
+            worldVersion = transform->GetWorldVersion();
+        }
+
+        bool localChanged = LocalBoundsChanged();
+        if (CacheValid && !localChanged && transform == CachedTransform && worldVersion == CachedWorldVersion && Offset.GetVersion() == CachedOffsetVersion)
+            return;
+
+        WorldMatrix = MatrixMultiply(Offset.GetMatrix(), transformMatrix);
+        WorldBounds = TransformBoundingBox(GetLocalBounds(), WorldMatrix);
+
+        CachedTransform = transform;
+        CachedWorldVersion = worldVersion;
+        CachedOffsetVersion = Offset.GetVersion();
+        WorldCacheVersion++;
+        CacheValid = true;
+    }
 };
 
 class ShapeComponent : public Drawable3DComponent
@@ -98,56 +272,154 @@ public:
     Vector3 ObjectSize = { 1, 1, 1 };
     DrawShape ObjectShape = DrawShape::Box;
 
-    OffsetTransform Offset;
-
 public:
     DEFINE_DERIVED_COMPONENT(ShapeComponent, Drawable3DComponent);
 
     inline void Draw(const Camera3D&) override
     {
-        TransformComponent* transform = GetComponent<TransformComponent>();
-        if (transform == nullptr)
+        if (GetComponent<TransformComponent>() == nullptr)
             return;
 
-        transform->PushMatrix();
+        // the size is folded into the model matrix so every shape of a kind shares one cached unit mesh
+        Vector3 scale = ShapeBatch::GetUnitScale(ObjectShape, ObjectSize);
+        Matrix model = MatrixMultiply(MatrixScale(scale.x, scale.y, scale.z), GetDrawMatrix());
+
+        // the material is shared with untinted meshes, the color goes on a copy of its maps
+        Material material = PrimitiveMeshCache::GetMaterial();
+        MaterialMap maps[MAX_MATERIAL_MAPS];
+        memcpy(maps, material.maps, sizeof(maps));
+        maps[MAP_DIFFUSE].color = MustGetComponent<ColorComponent>()->GetColor();
+        material.maps = maps;
 
-        Offset.Apply();
+        // the render system draws planes in the double sided pipeline group
+        RenderBackend::Get().DrawMesh(GetUnitMesh(), material, model);
+    }
+
+    // the cached unit mesh for the shape at the current LOD
+    inline const Mesh& GetUnitMesh()
+    {
+        return PrimitiveMeshCache::Get(ObjectShape, ShapeBatch::GetSizeClass(ObjectShape, ObjectSize), PrimitiveMeshes::GetLODTessellation(ObjectShape, GetLOD()));
+    }
+
+    inline int GetLODCount() override
+    {
+        return PrimitiveMeshes::GetLODCount(ObjectShape);
+    }
 
-        Color objectColor = MustGetComponent<ColorComponent>()->GetColor();
+    inline float GetLODScreenSize(int level) override
+    {
+        return PrimitiveMeshes::GetLODScreenSize(level);
+    }
+
+    inline int GetTriangleCount() override
+    {
+        return GetUnitMesh().triangleCount;
+    }
+
+    inline const Mesh* GetStaticMesh(Matrix& model, Material*& material) override
+    {
+        material = &PrimitiveMeshCache::GetMaterial();
+
+        Vector3 scale = ShapeBatch::GetUnitScale(ObjectShape, ObjectSize);
+        model = MatrixMultiply(MatrixScale(scale.x, scale.y, scale.z), GetWorldMatrix());
+
+        return &PrimitiveMeshCache::Get(ObjectShape, ShapeBatch::GetSizeClass(ObjectShape, ObjectSize), PrimitiveMeshes::GetLODTessellation(ObjectShape, 0));
+    }
+
+    inline Color GetTint() override
+    {
+        return MustGetComponent<ColorComponent>()->GetColor();
+    }
+
+    inline RenderPipeline GetPipeline() override
+    {
+        return ObjectShape == DrawShape::Plane ? RenderPipeline::DoubleSided : RenderPipeline::Opaque;
+    }
+
+    // shapes that share a geometry id can be drawn from the same unit mesh
+    inline uint16_t GetGeometryId() override
+    {
+        uint16_t variant = uint16_t(GetLOD() * ShapeBatch::SizeClassCount + ShapeBatch::GetSizeClass(ObjectShape, ObjectSize));
+        return DrawKey::MakeShapeGeometry(uint8_t(ObjectShape), variant);
+    }
+
+protected:
+    inline BoundingBox GetLocalBounds() override
+    {
+        Vector3 size = ObjectSize;
 
         switch (ObjectShape)
         {
         case DrawShape::Box:
-            DrawCube(Vector3Zero(), ObjectSize.x, ObjectSize.y, ObjectSize.z, objectColor);
-            break;
+            return BoundingBox{ Vector3Scale(size, -0.5f), Vector3Scale(size, 0.5f) };
+
         case DrawShape::Sphere:
-            DrawSphere(Vector3Zero(), std::max(std::max(ObjectSize.x, ObjectSize.y), ObjectSize.z), objectColor);
-            ;           break;
+        {
+            float radius = std::max(std::max(size.x, size.y), size.z);
+            return BoundingBox{ Vector3{ -radius, -radius, -radius }, Vector3{ radius, radius, radius } };
+        }
+
         case DrawShape::Cylinder:
-            DrawCylinder(Vector3Zero(), ObjectSize.x, ObjectSize.y, ObjectSize.z, 32, objectColor);
-            break;
+        {
+            // top radius, bottom radius and height, drawn up the Y axis from the origin
+            float radius = std::max(size.x, size.y);
+            return BoundingBox{ Vector3{ -radius, std::min(0.0f, size.z), -radius }, Vector3{ radius, std::max(0.0f, size.z), radius } };
+        }
+
         case DrawShape::Plane:
-            rlDisableBackfaceCulling();
-            DrawPlane(Vector3Zero(), Vector2{ ObjectSize.x,ObjectSize.y }, objectColor);
-            rlDrawRenderBatchActive();
-            rlEnableBackfaceCulling();
-            break;
+            return BoundingBox{ Vector3{ -size.x * 0.5f, 0, -size.y * 0.5f }, Vector3{ size.x * 0.5f, 0, size.y * 0.5f } };
+
         default:
-            break;
+            return BoundingBox{ Vector3Zero(), Vector3Zero() };
         }
+    }
 
-        transform->PopMatrix();
+    inline bool LocalBoundsChanged() override
+    {
+        if (BoundsShape == ObjectShape && BoundsSize.x == ObjectSize.x && BoundsSize.y == ObjectSize.y && BoundsSize.z == ObjectSize.z)
+            return false;
+
+        BoundsShape = ObjectShape;
+        BoundsSize = ObjectSize;
+        return true;
     }
+
+private:
+    Vector3 BoundsSize = { 0, 0, 0 };
+    DrawShape BoundsShape = DrawShape::Box;
 };
 
 class MeshComponent : public Drawable3DComponent
 {
 public:
-    Mesh ObjetMesh;
+    Mesh ObjetMesh = { 0 };
     Material ObjectMaterial;
-    OffsetTransform Offset;
 
     bool UseColor = false;
+
+    // the material's own diffuse color, its maps can be shared so the tint is never written into them
+    Color MaterialTint = WHITE;
+
+    // coarser versions of ObjetMesh, LODs[0] is level 1
+    struct MeshLOD
+    {
+        Mesh LODMesh = { 0 };
+
+        // used once the projected size drops below this many pixels
+        float ScreenSize = 0;
+
+        // set when the mesh is shared through the resource manager
+        ResourceManager::MeshHandle Resource;
+    };
+    std::vector<MeshLOD> LODs;
+
+    // shared resources this component holds a reference on, ObjetMesh and ObjectMaterial are copies of them
+    ResourceManager::MeshHandle MeshResource;
+    ResourceManager::MaterialHandle MaterialResource;
+    ResourceManager::ModelHandle ModelResource;
+
+    // a background load that will replace the placeholder mesh
+    AsyncLoader::RequestId PendingLoad = AsyncLoader::InvalidRequest;
  
 public:
 
@@ -155,28 +427,212 @@ public:
 
     inline void OnCreate() override
     {
-        ObjectMaterial = LoadMaterialDefault();
+        // every mesh without its own material shares the one default material
+        SetMaterial(ResourceManager::AcquireDefaultMaterial());
+    }
+
+    inline void OnDestroy() override
+    {
+        AsyncLoader::Cancel(PendingLoad);
+        PendingLoad = AsyncLoader::InvalidRequest;
+
+        ResourceManager::Release(MeshResource);
+        ResourceManager::Release(MaterialResource);
+        ResourceManager::Release(ModelResource);
+
+        for (MeshLOD& lod : LODs)
+            ResourceManager::Release(lod.Resource);
+        LODs.clear();
+    }
+
+    // takes over the reference in the handle
+    inline void SetMesh(ResourceManager::MeshHandle handle)
+    {
+        ResourceManager::Release(MeshResource);
+        ResourceManager::Release(ModelResource);
+
+        MeshResource = handle;
+        Mesh* mesh = ResourceManager::Get(handle);
+        ObjetMesh = (mesh != nullptr) ? *mesh : Mesh{ 0 };
+    }
+
+    // draws the shared placeholder until the mesh file has been read, parsed and uploaded
+    inline void LoadMeshAsync(const char* fileName)
+    {
+        BeginAsyncLoad();
+        PendingLoad = AsyncLoader::LoadMeshFile(fileName, [this](ResourceManager::MeshHandle handle) { OnMeshLoaded(handle); });
+    }
+
+    // same as LoadMeshAsync for meshes built in code, build runs on a worker and must not touch the GPU
+    inline void LoadMeshAsync(const std::string& key, const AsyncLoader::MeshBuilder& build)
+    {
+        BeginAsyncLoad();
+        PendingLoad = AsyncLoader::LoadMesh(key, build, [this](ResourceManager::MeshHandle handle) { OnMeshLoaded(handle); });
+    }
+
+    inline bool IsLoading() const { return PendingLoad != AsyncLoader::InvalidRequest; }
+
+    // takes over the reference in the handle
+    inline void SetMaterial(ResourceManager::MaterialHandle handle)
+    {
+        ResourceManager::Release(MaterialResource);
+
+        MaterialResource = handle;
+        Material* material = ResourceManager::Get(handle);
+        if (material != nullptr)
+            ObjectMaterial = *material;
+
+        MaterialTint = (ObjectMaterial.maps != nullptr) ? ObjectMaterial.maps[MAP_DIFFUSE].color : WHITE;
+    }
+
+    // uses one mesh of a shared model along with that mesh's material, takes over the reference in the handle
+    inline void SetModel(ResourceManager::ModelHandle handle, int meshIndex = 0)
+    {
+        ResourceManager::Release(MeshResource);
+        ResourceManager::Release(MaterialResource);
+        ResourceManager::Release(ModelResource);
+
+        ModelResource = handle;
+        Model* model = ResourceManager::Get(handle);
+        if (model == nullptr || meshIndex < 0 || meshIndex >= model->meshCount)
+        {
+            ObjetMesh = Mesh{ 0 };
+            return;
+        }
+
+        ObjetMesh = model->meshes[meshIndex];
+        ObjectMaterial = model->materials[model->meshMaterial[meshIndex]];
+        MaterialTint = (ObjectMaterial.maps != nullptr) ? ObjectMaterial.maps[MAP_DIFFUSE].color : WHITE;
     }
 
     inline void Draw(const Camera3D&) override
     {
-        TransformComponent* transform = GetComponent<TransformComponent>();
-        if (transform == nullptr)
+        if (GetComponent<TransformComponent>() == nullptr)
             return;
 
-        transform->PushMatrix();
+        // the world matrix already has the offset folded in
+        RenderBackend::Get().PushMatrix(GetDrawMatrix());
+
+        // the tint goes on a copy of the maps, other meshes on the same material keep their own
+        Material material = ObjectMaterial;
+        MaterialMap maps[MAX_MATERIAL_MAPS];
+        if (UseColor && material.maps != nullptr)
+        {
+            memcpy(maps, material.maps, sizeof(maps));
+            maps[MAP_DIFFUSE].color = GetTint();
+            material.maps = maps;
+        }
+
+        RenderBackend::Get().DrawMesh(GetLODMesh(), material, MatrixIdentity());
+        RenderBackend::Get().PopMatrix();
+    }
+
+    // add the next coarser level, thresholds should get smaller with each level
+    inline void AddLOD(const Mesh& mesh, float screenSize)
+    {
+        LODs.push_back(MeshLOD{ mesh, screenSize });
+    }
+
+    // takes over the reference in the handle
+    inline void AddLOD(ResourceManager::MeshHandle handle, float screenSize)
+    {
+        Mesh* mesh = ResourceManager::Get(handle);
+        LODs.push_back(MeshLOD{ (mesh != nullptr) ? *mesh : Mesh{ 0 }, screenSize, handle });
+    }
+
+    inline const Mesh& GetLODMesh()
+    {
+        int level = GetLOD();
+        if (level <= 0 || level > int(LODs.size()))
+            return ObjetMesh;
+
+        return LODs[level - 1].LODMesh;
+    }
+
+    inline int GetLODCount() override
+    {
+        return int(LODs.size()) + 1;
+    }
+
+    inline float GetLODScreenSize(int level) override
+    {
+        // a level is used down to the size the next one takes over at
+        if (level < 0 || level >= int(LODs.size()))
+            return 0;
+
+        return LODs[level].ScreenSize;
+    }
+
+    inline int GetTriangleCount() override
+    {
+        const Mesh& mesh = GetLODMesh();
+        return mesh.triangleCount > 0 ? mesh.triangleCount : mesh.vertexCount / 3;
+    }
 
-        Offset.Apply();
+    inline const Mesh* GetStaticMesh(Matrix& model, Material*& material) override
+    {
+        material = &ObjectMaterial;
+        model = GetWorldMatrix();
+        return (ObjetMesh.vertices != nullptr) ? &ObjetMesh : nullptr;
+    }
 
+    inline Color GetTint() override
+    {
         if (UseColor)
         {
             ColorComponent* color = GetComponent<ColorComponent>();
             if (color != nullptr)
-                ObjectMaterial.maps[0].color = color->GetColor();
+                return color->GetColor();
         }
 
-        DrawMesh(ObjetMesh, ObjectMaterial, MatrixIdentity());
+        return MaterialTint;
+    }
+
+    inline uint16_t GetGeometryId() override
+    {
+        return uint16_t(DrawKey::FirstMeshGeometry + GetLODMesh().vaoId % (DrawKey::GeometryMask + 1 - DrawKey::FirstMeshGeometry));
+    }
 
-        transform->PopMatrix();
+    inline uint32_t GetMaterialId() override
+    {
+        uint32_t textureId = (ObjectMaterial.maps != nullptr) ? ObjectMaterial.maps[MAP_DIFFUSE].texture.id : 0;
+        return ((ObjectMaterial.shader.id & 0x3FF) << 10) | (textureId & 0x3FF);
+    }
+
+protected:
+    inline BoundingBox GetLocalBounds() override
+    {
+        return MeshBounds;
     }
+
+    inline bool LocalBoundsChanged() override
+    {
+        if (BoundsVertices == ObjetMesh.vertices && BoundsVertexCount == ObjetMesh.vertexCount)
+            return false;
+
+        BoundsVertices = ObjetMesh.vertices;
+        BoundsVertexCount = ObjetMesh.vertexCount;
+        MeshBounds = (ObjetMesh.vertices != nullptr) ? GetMeshBoundingBox(ObjetMesh) : BoundingBox{ Vector3Zero(), Vector3Zero() };
+        return true;
+    }
+
+private:
+    inline void BeginAsyncLoad()
+    {
+        AsyncLoader::Cancel(PendingLoad);
+        SetMesh(AsyncLoader::AcquirePlaceholderMesh());
+    }
+
+    inline void OnMeshLoaded(ResourceManager::MeshHandle handle)
+    {
+        PendingLoad = AsyncLoader::InvalidRequest;
+
+        // a failed load keeps showing the placeholder
+        if (handle.IsValid())
+            SetMesh(handle);
+    }
+
+    BoundingBox MeshBounds = { 0 };
+    float* BoundsVertices = nullptr;
+    int BoundsVertexCount = 0;
 };
\ No newline at end of file
@@ -0,0 +1,481 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "dynamic_bvh.h"
+
+#include <algorithm>
+#include <float.h>
+
+namespace
+{
+    // deep enough for a balanced tree of far more proxies than we can hold in memory
+    constexpr int TraversalStackSize = 256;
+}
+
+BoundingBox DynamicBVH::Loosen(const BoundingBox& box) const
+{
+    Vector3 margin = { Margin, Margin, Margin };
+    return BoundingBox{ Vector3Subtract(box.min, margin), Vector3Add(box.max, margin) };
+}
+
+int32_t DynamicBVH::AllocateNode()
+{
+    if (FreeList == NullNode)
+    {
+        Nodes.emplace_back();
+        return int32_t(Nodes.size() - 1);
+    }
+
+    int32_t node = FreeList;
+    FreeList = Nodes[node].Parent;
+    Nodes[node] = Node();
+    return node;
+}
+
+void DynamicBVH::FreeNode(int32_t node)
+{
+    Nodes[node].Parent = FreeList;
+    Nodes[node].Height = -1;
+    FreeList = node;
+}
+
+void DynamicBVH::Clear()
+{
+    Nodes.clear();
+    Root = NullNode;
+    FreeList = NullNode;
+    ProxyCount = 0;
+}
+
+int32_t DynamicBVH::CreateProxy(const BoundingBox& box, uint64_t userData)
+{
+    int32_t proxy = AllocateNode();
+    Nodes[proxy].Box = Loosen(box);
+    Nodes[proxy].UserData = userData;
+    Nodes[proxy].Height = 0;
+
+    InsertLeaf(proxy);
+    ProxyCount++;
+    return proxy;
+}
+
+void DynamicBVH::DestroyProxy(int32_t proxy)
+{
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    ProxyCount--;
+}
+
+bool DynamicBVH::MoveProxy(int32_t proxy, const BoundingBox& box)
+{
+    Node& leaf = Nodes[proxy];
+    if (BoundingBoxContains(leaf.Box, box))
+        return false;
+
+    BoundingBox looseBox = Loosen(box);
+
+    // a short move only needs the parents grown to fit, a long one would leave huge parents behind so reinsert
+    if (BoundingBoxOverlaps(leaf.Box, box))
+    {
+        leaf.Box = looseBox;
+        Refit(leaf.Parent);
+        return true;
+    }
+
+    RemoveLeaf(proxy);
+    Nodes[proxy].Box = looseBox;
+    InsertLeaf(proxy);
+    return true;
+}
+
+void DynamicBVH::Refit(int32_t node)
+{
+    while (node != NullNode)
+    {
+        Node& current = Nodes[node];
+        BoundingBox box = BoundingBoxUnion(Nodes[current.Child1].Box, Nodes[current.Child2].Box);
+
+        // once a parent already fits its children nothing above it can change
+        if (BoundingBoxContains(current.Box, box))
+            return;
+
+        current.Box = box;
+        node = current.Parent;
+    }
+}
+
+void DynamicBVH::InsertLeaf(int32_t leaf)
+{
+    if (Root == NullNode)
+    {
+        Root = leaf;
+        Nodes[Root].Parent = NullNode;
+        return;
+    }
+
+    // find the best sibling using the surface area cost of the new parent plus the growth of the ancestors
+    BoundingBox leafBox = Nodes[leaf].Box;
+    int32_t index = Root;
+    while (!Nodes[index].IsLeaf())
+    {
+        const Node& node = Nodes[index];
+        int32_t child1 = node.Child1;
+        int32_t child2 = node.Child2;
+
+        float area = BoundingBoxSurfaceArea(node.Box);
+        float combinedArea = BoundingBoxSurfaceArea(BoundingBoxUnion(node.Box, leafBox));
+
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int32_t child)
+        {
+            float newArea = BoundingBoxSurfaceArea(BoundingBoxUnion(leafBox, Nodes[child].Box));
+            if (Nodes[child].IsLeaf())
+                return newArea + inheritanceCost;
+
+            return (newArea - BoundingBoxSurfaceArea(Nodes[child].Box)) + inheritanceCost;
+        };
+
+        float cost1 = childCost(child1);
+        float cost2 = childCost(child2);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = (cost1 < cost2) ? child1 : child2;
+    }
+
+    int32_t sibling = index;
+
+    int32_t oldParent = Nodes[sibling].Parent;
+    int32_t newParent = AllocateNode();
+    Nodes[newParent].Parent = oldParent;
+    Nodes[newParent].Box = BoundingBoxUnion(leafBox, Nodes[sibling].Box);
+    Nodes[newParent].Height = Nodes[sibling].Height + 1;
+    Nodes[newParent].Child1 = sibling;
+    Nodes[newParent].Child2 = leaf;
+    Nodes[sibling].Parent = newParent;
+    Nodes[leaf].Parent = newParent;
+
+    if (oldParent != NullNode)
+    {
+        if (Nodes[oldParent].Child1 == sibling)
+            Nodes[oldParent].Child1 = newParent;
+        else
+            Nodes[oldParent].Child2 = newParent;
+    }
+    else
+    {
+        Root = newParent;
+    }
+
+    // walk back up fixing heights and boxes
+    index = Nodes[leaf].Parent;
+    while (index != NullNode)
+    {
+        index = Balance(index);
+
+        Node& node = Nodes[index];
+        node.Height = 1 + std::max(Nodes[node.Child1].Height, Nodes[node.Child2].Height);
+        node.Box = BoundingBoxUnion(Nodes[node.Child1].Box, Nodes[node.Child2].Box);
+
+        index = node.Parent;
+    }
+}
+
+void DynamicBVH::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == Root)
+    {
+        Root = NullNode;
+        return;
+    }
+
+    int32_t parent = Nodes[leaf].Parent;
+    int32_t grandParent = Nodes[parent].Parent;
+    int32_t sibling = (Nodes[parent].Child1 == leaf) ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+    FreeNode(parent);
+
+    if (grandParent == NullNode)
+    {
+        Root = sibling;
+        Nodes[sibling].Parent = NullNode;
+        return;
+    }
+
+    if (Nodes[grandParent].Child1 == parent)
+        Nodes[grandParent].Child1 = sibling;
+    else
+        Nodes[grandParent].Child2 = sibling;
+
+    Nodes[sibling].Parent = grandParent;
+
+    int32_t index = grandParent;
+    while (index != NullNode)
+    {
+        index = Balance(index);
+
+        Node& node = Nodes[index];
+        node.Box = BoundingBoxUnion(Nodes[node.Child1].Box, Nodes[node.Child2].Box);
+        node.Height = 1 + std::max(Nodes[node.Child1].Height, Nodes[node.Child2].Height);
+
+        index = node.Parent;
+    }
+}
+
+// rotate the node up if its children are unbalanced, returns the new root of this subtree
+int32_t DynamicBVH::Balance(int32_t iA)
+{
+    Node& A = Nodes[iA];
+    if (A.IsLeaf() || A.Height < 2)
+        return iA;
+
+    int32_t iB = A.Child1;
+    int32_t iC = A.Child2;
+    int32_t balance = Nodes[iC].Height - Nodes[iB].Height;
+
+    // rotate the taller child up
+    auto rotate = [this](int32_t iA, int32_t iUp, int32_t iOther, bool upIsChild2)
+    {
+        Node& A = Nodes[iA];
+        Node& Up = Nodes[iUp];
+
+        int32_t iF = Up.Child1;
+        int32_t iG = Up.Child2;
+
+        Up.Child1 = iA;
+        Up.Parent = A.Parent;
+        A.Parent = iUp;
+
+        if (Up.Parent != NullNode)
+        {
+            if (Nodes[Up.Parent].Child1 == iA)
+                Nodes[Up.Parent].Child1 = iUp;
+            else
+                Nodes[Up.Parent].Child2 = iUp;
+        }
+        else
+        {
+            Root = iUp;
+        }
+
+        // keep the taller grandchild up top, the shorter one moves under A
+        int32_t iKeep = iF;
+        int32_t iMove = iG;
+        if (Nodes[iF].Height < Nodes[iG].Height)
+            std::swap(iKeep, iMove);
+
+        Up.Child2 = iKeep;
+        if (upIsChild2)
+            A.Child2 = iMove;
+        else
+            A.Child1 = iMove;
+
+        Nodes[iMove].Parent = iA;
+
+        A.Box = BoundingBoxUnion(Nodes[iOther].Box, Nodes[iMove].Box);
+        Up.Box = BoundingBoxUnion(A.Box, Nodes[iKeep].Box);
+
+        A.Height = 1 + std::max(Nodes[iOther].Height, Nodes[iMove].Height);
+        Up.Height = 1 + std::max(A.Height, Nodes[iKeep].Height);
+
+        return iUp;
+    };
+
+    if (balance > 1)
+        return rotate(iA, iC, iB, true);
+
+    if (balance < -1)
+        return rotate(iA, iB, iC, false);
+
+    return iA;
+}
+
+int32_t DynamicBVH::GetHeight() const
+{
+    if (Root == NullNode)
+        return 0;
+
+    return Nodes[Root].Height;
+}
+
+void DynamicBVH::QueryBox(const BoundingBox& box, std::vector<uint64_t>& results) const
+{
+    if (Root == NullNode)
+        return;
+
+    int32_t stack[TraversalStackSize];
+    int count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+        if (!BoundingBoxOverlaps(node.Box, box))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            results.push_back(node.UserData);
+        }
+        else
+        {
+            stack[count++] = node.Child1;
+            stack[count++] = node.Child2;
+        }
+    }
+}
+
+void DynamicBVH::QuerySphere(const Vector3& center, float radius, std::vector<uint64_t>& results) const
+{
+    if (Root == NullNode)
+        return;
+
+    int32_t stack[TraversalStackSize];
+    int count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+        if (!SphereOverlapsBox(center, radius, node.Box))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            results.push_back(node.UserData);
+        }
+        else
+        {
+            stack[count++] = node.Child1;
+            stack[count++] = node.Child2;
+        }
+    }
+}
+
+void DynamicBVH::QueryFrustum(const Frustum& frustum, std::vector<uint64_t>& results) const
+{
+    if (Root == NullNode)
+        return;
+
+    int32_t stack[TraversalStackSize];
+    int count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+        if (!FrustumContainsBox(frustum, node.Box))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            results.push_back(node.UserData);
+        }
+        else
+        {
+            stack[count++] = node.Child1;
+            stack[count++] = node.Child2;
+        }
+    }
+}
+
+void DynamicBVH::RayCast(const Ray& ray, float maxDistance, std::vector<RayHit>& results) const
+{
+    if (Root == NullNode)
+        return;
+
+    Vector3 inverseDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+    size_t firstResult = results.size();
+
+    int32_t stack[TraversalStackSize];
+    int count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+
+        float distance = 0;
+        if (!RayIntersectsBox(ray, inverseDirection, node.Box, maxDistance, distance))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            results.push_back(RayHit{ node.UserData, distance });
+        }
+        else
+        {
+            stack[count++] = node.Child1;
+            stack[count++] = node.Child2;
+        }
+    }
+
+    std::sort(results.begin() + firstResult, results.end(), [](const RayHit& a, const RayHit& b) { return a.Distance < b.Distance; });
+}
+
+bool DynamicBVH::RayCastClosest(const Ray& ray, float maxDistance, RayHit& hit) const
+{
+    if (Root == NullNode)
+        return false;
+
+    Vector3 inverseDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+    bool found = false;
+
+    int32_t stack[TraversalStackSize];
+    int count = 0;
+    stack[count++] = Root;
+
+    while (count > 0)
+    {
+        const Node& node = Nodes[stack[--count]];
+
+        // anything further than the best hit so far can be skipped
+        float distance = 0;
+        if (!RayIntersectsBox(ray, inverseDirection, node.Box, maxDistance, distance))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            hit = RayHit{ node.UserData, distance };
+            maxDistance = distance;
+            found = true;
+        }
+        else
+        {
+            stack[count++] = node.Child1;
+            stack[count++] = node.Child2;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,110 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "bounds.h"
+
+#include "raylib.h"
+
+#include <stdint.h>
+#include <vector>
+
+// a dynamic bounding volume hierarchy over loose (fattened) boxes
+// small moves are absorbed by the loose box or handled by refitting the parents, only large moves reinsert a leaf
+class DynamicBVH
+{
+public:
+    static constexpr int32_t NullNode = -1;
+
+    struct RayHit
+    {
+        uint64_t UserData = 0;
+        float Distance = 0;
+    };
+
+    // how much each leaf box is grown so small moves don't touch the tree
+    float Margin = 0.25f;
+
+    int32_t CreateProxy(const BoundingBox& box, uint64_t userData);
+    void DestroyProxy(int32_t proxy);
+
+    // returns true if the tree had to change
+    bool MoveProxy(int32_t proxy, const BoundingBox& box);
+
+    inline uint64_t GetUserData(int32_t proxy) const { return Nodes[proxy].UserData; }
+    inline const BoundingBox& GetLooseBounds(int32_t proxy) const { return Nodes[proxy].Box; }
+
+    inline size_t GetProxyCount() const { return ProxyCount; }
+    int32_t GetHeight() const;
+
+    void Clear();
+
+    // the queries test the loose boxes, so results can include proxies slightly outside the query volume
+    void QueryBox(const BoundingBox& box, std::vector<uint64_t>& results) const;
+    void QuerySphere(const Vector3& center, float radius, std::vector<uint64_t>& results) const;
+    void QueryFrustum(const Frustum& frustum, std::vector<uint64_t>& results) const;
+
+    // all proxies the ray passes through, nearest first
+    void RayCast(const Ray& ray, float maxDistance, std::vector<RayHit>& results) const;
+
+    // the nearest proxy along the ray
+    bool RayCastClosest(const Ray& ray, float maxDistance, RayHit& hit) const;
+
+private:
+    struct Node
+    {
+        BoundingBox Box = { 0 };
+        uint64_t UserData = 0;
+
+        // the parent link doubles as the free list link
+        int32_t Parent = NullNode;
+        int32_t Child1 = NullNode;
+        int32_t Child2 = NullNode;
+
+        // leaf = 0, free = -1
+        int32_t Height = -1;
+
+        inline bool IsLeaf() const { return Child1 == NullNode; }
+    };
+
+    std::vector<Node> Nodes;
+    int32_t Root = NullNode;
+    int32_t FreeList = NullNode;
+    size_t ProxyCount = 0;
+
+    int32_t AllocateNode();
+    void FreeNode(int32_t node);
+
+    void InsertLeaf(int32_t leaf);
+    void RemoveLeaf(int32_t leaf);
+    void Refit(int32_t node);
+    int32_t Balance(int32_t node);
+
+    BoundingBox Loosen(const BoundingBox& box) const;
+};
@@ -0,0 +1,352 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "fixed_step_runner.h"
+
+#include "camera_component.h"
+#include "drawable_component.h"
+#include "transform_component.h"
+
+#include "raymath.h"
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+namespace FixedStepRunner
+{
+    // a drawable or camera whose draw matrix is blended, with how to read its real world matrix
+    struct TrackedMatrix
+    {
+        Component* Owner = nullptr;
+        InterpolatedMatrix* State = nullptr;
+        const Matrix& (*GetWorld)(Component* owner, uint32_t& version) = nullptr;
+    };
+
+    // a tracked matrix the simulation moved, as of the last two ticks
+    struct MovingMatrix
+    {
+        InterpolatedMatrix* State = nullptr;
+        Matrix Previous;
+        Matrix Current;
+    };
+
+    std::vector<TickFunction> Systems;
+    std::vector<TrackedMatrix> Tracked;
+    std::vector<MovingMatrix> Moving;
+
+    // the world matrix each tracked owner had after the last tick, parallel to Tracked
+    std::vector<Matrix> LastTick;
+    std::vector<uint32_t> LastTickVersion;
+
+    // the last tick version of something added since the last tick, its first tick only records where it is
+    constexpr uint32_t UnknownVersion = UINT32_MAX;
+
+    float TickDelta = 1.0f / DefaultTickRate;
+    int MaxSteps = DefaultMaxSteps;
+    bool Interpolate = true;
+
+    float Accumulator = 0;
+    float Alpha = 0;
+
+    Stats RunnerStats;
+
+    const Matrix& GetDrawableWorld(Component* owner, uint32_t& version)
+    {
+        Drawable3DComponent* drawable = static_cast<Drawable3DComponent*>(owner);
+        const Matrix& world = drawable->GetWorldMatrix();
+        version = drawable->GetWorldCacheVersion();
+        return world;
+    }
+
+    const Matrix& GetCameraWorld(Component* owner, uint32_t& version)
+    {
+        TransformComponent* transform = ComponentManager::MustGetComponent<TransformComponent>(owner);
+        const Matrix& world = transform->GetWorldMatrix();
+        version = transform->GetWorldVersion();
+        return world;
+    }
+
+    void AddTracked(Component* owner, InterpolatedMatrix& state, const Matrix& (*getWorld)(Component*, uint32_t&))
+    {
+        if (state.TrackedIndex >= 0)
+            return;
+
+        state.TrackedIndex = int32_t(Tracked.size());
+        state.MovingIndex = -1;
+        state.Active = false;
+        Tracked.push_back(TrackedMatrix{ owner, &state, getWorld });
+        LastTick.push_back(MatrixIdentity());
+        LastTickVersion.push_back(UnknownVersion);
+    }
+
+    void RemoveMoving(InterpolatedMatrix& state)
+    {
+        size_t index = size_t(state.MovingIndex);
+        state.MovingIndex = -1;
+        state.Active = false;
+
+        if (index + 1 != Moving.size())
+        {
+            Moving[index] = Moving.back();
+            Moving[index].State->MovingIndex = int32_t(index);
+        }
+
+        Moving.pop_back();
+    }
+
+    void RemoveTracked(InterpolatedMatrix& state)
+    {
+        if (state.TrackedIndex < 0)
+            return;
+
+        if (state.MovingIndex >= 0)
+            RemoveMoving(state);
+
+        size_t index = size_t(state.TrackedIndex);
+        state.TrackedIndex = -1;
+
+        if (index + 1 != Tracked.size())
+        {
+            Tracked[index] = Tracked.back();
+            LastTick[index] = LastTick.back();
+            LastTickVersion[index] = LastTickVersion.back();
+            Tracked[index].State->TrackedIndex = int32_t(index);
+        }
+
+        Tracked.pop_back();
+        LastTick.pop_back();
+        LastTickVersion.pop_back();
+    }
+
+    void OnDrawableAdded(Component* component)
+    {
+        Drawable3DComponent* drawable = static_cast<Drawable3DComponent*>(component);
+        AddTracked(drawable, drawable->Interpolation, GetDrawableWorld);
+    }
+
+    void OnDrawableRemoved(Component* component)
+    {
+        RemoveTracked(static_cast<Drawable3DComponent*>(component)->Interpolation);
+    }
+
+    void OnCameraAdded(Component* component)
+    {
+        CameraComponent* camera = static_cast<CameraComponent*>(component);
+        AddTracked(camera, camera->Interpolation, GetCameraWorld);
+    }
+
+    void OnCameraRemoved(Component* component)
+    {
+        RemoveTracked(static_cast<CameraComponent*>(component)->Interpolation);
+    }
+
+    void Setup(float tickRate, int maxSteps)
+    {
+        SetTickRate(tickRate);
+        SetMaxSteps(maxSteps);
+
+        ComponentManager::DoForEachEntity<Drawable3DComponent>([](Drawable3DComponent* drawable) { OnDrawableAdded(drawable); });
+        ComponentManager::DoForEachEntity<CameraComponent>([](CameraComponent* camera) { OnCameraAdded(camera); });
+
+        ComponentManager::AddAddObserver<Drawable3DComponent>(OnDrawableAdded);
+        ComponentManager::AddRemoveObserver<Drawable3DComponent>(OnDrawableRemoved);
+        ComponentManager::AddAddObserver<CameraComponent>(OnCameraAdded);
+        ComponentManager::AddRemoveObserver<CameraComponent>(OnCameraRemoved);
+    }
+
+    void Shutdown()
+    {
+        while (!Tracked.empty())
+            RemoveTracked(*Tracked.back().State);
+
+        Systems.clear();
+        Accumulator = 0;
+    }
+
+    void AddSystem(const TickFunction& tick)
+    {
+        Systems.push_back(tick);
+    }
+
+    void SetTickRate(float ticksPerSecond)
+    {
+        TickDelta = 1.0f / std::max(1.0f, ticksPerSecond);
+    }
+
+    float GetTickRate()
+    {
+        return 1.0f / TickDelta;
+    }
+
+    float GetTickDelta()
+    {
+        return TickDelta;
+    }
+
+    void SetMaxSteps(int steps)
+    {
+        MaxSteps = std::max(1, steps);
+    }
+
+    void SetInterpolation(bool enabled)
+    {
+        Interpolate = enabled;
+    }
+
+    bool IsInterpolating()
+    {
+        return Interpolate;
+    }
+
+    void RunTick()
+    {
+        for (TickFunction& system : Systems)
+            system(TickDelta);
+
+        // a changed world version means the tick moved it, anything that sat still for a whole tick has nothing left to blend
+        for (size_t i = 0; i < Tracked.size(); i++)
+        {
+            InterpolatedMatrix& state = *Tracked[i].State;
+
+            uint32_t version = 0;
+            const Matrix& world = Tracked[i].GetWorld(Tracked[i].Owner, version);
+
+            if (LastTickVersion[i] == UnknownVersion)
+            {
+                LastTick[i] = world;
+                LastTickVersion[i] = version;
+                continue;
+            }
+
+            if (version == LastTickVersion[i])
+            {
+                if (state.MovingIndex >= 0)
+                    RemoveMoving(state);
+                continue;
+            }
+
+            if (state.MovingIndex < 0)
+            {
+                state.MovingIndex = int32_t(Moving.size());
+                Moving.push_back(MovingMatrix{ &state });
+            }
+
+            MovingMatrix& moving = Moving[state.MovingIndex];
+            moving.Previous = LastTick[i];
+            moving.Current = world;
+            state.Version = version;
+
+            LastTick[i] = world;
+            LastTickVersion[i] = version;
+        }
+    }
+
+    // lerp an axis and keep its length lerped too, so scale survives and a rotation does not shrink the matrix
+    inline Vector3 BlendAxis(const Vector3& from, const Vector3& to, float alpha)
+    {
+        Vector3 axis = Vector3Lerp(from, to, alpha);
+        float length = Vector3Length(axis);
+        float scale = (length > 0) ? Lerp(Vector3Length(from), Vector3Length(to), alpha) / length : 0;
+
+        return Vector3Scale(axis, scale);
+    }
+
+    Matrix BlendMatrix(const Matrix& from, const Matrix& to, float alpha)
+    {
+        // raylib's Matrix fields run along rows, an axis is a column: (m0, m1, m2), (m4, m5, m6) and (m8, m9, m10)
+        Vector3 x = BlendAxis(Vector3{ from.m0, from.m1, from.m2 }, Vector3{ to.m0, to.m1, to.m2 }, alpha);
+        Vector3 y = BlendAxis(Vector3{ from.m4, from.m5, from.m6 }, Vector3{ to.m4, to.m5, to.m6 }, alpha);
+        Vector3 z = BlendAxis(Vector3{ from.m8, from.m9, from.m10 }, Vector3{ to.m8, to.m9, to.m10 }, alpha);
+
+        Matrix blended = to;
+        blended.m0 = x.x; blended.m1 = x.y; blended.m2 = x.z;
+        blended.m4 = y.x; blended.m5 = y.y; blended.m6 = y.z;
+        blended.m8 = z.x; blended.m9 = z.y; blended.m10 = z.z;
+
+        blended.m12 = Lerp(from.m12, to.m12, alpha);
+        blended.m13 = Lerp(from.m13, to.m13, alpha);
+        blended.m14 = Lerp(from.m14, to.m14, alpha);
+        return blended;
+    }
+
+    void Blend()
+    {
+        for (MovingMatrix& moving : Moving)
+        {
+            moving.State->Blended = BlendMatrix(moving.Previous, moving.Current, Alpha);
+            moving.State->Active = true;
+        }
+    }
+
+    void Update(float frameTime)
+    {
+        RunnerStats.Ticks = 0;
+        RunnerStats.DroppedTime = 0;
+
+        Accumulator += std::max(0.0f, frameTime);
+        while (Accumulator >= TickDelta)
+        {
+            if (RunnerStats.Ticks >= MaxSteps)
+            {
+                RunnerStats.DroppedTime = Accumulator - fmodf(Accumulator, TickDelta);
+                Accumulator = fmodf(Accumulator, TickDelta);
+                break;
+            }
+
+            RunTick();
+            Accumulator -= TickDelta;
+            RunnerStats.Ticks++;
+        }
+
+        Alpha = Accumulator / TickDelta;
+        RunnerStats.Interpolated = 0;
+
+        if (Interpolate)
+        {
+            Blend();
+            RunnerStats.Interpolated = Moving.size();
+        }
+        else
+        {
+            for (MovingMatrix& moving : Moving)
+                moving.State->Active = false;
+        }
+    }
+
+    float GetAlpha()
+    {
+        return Alpha;
+    }
+
+    const Stats& GetStats()
+    {
+        return RunnerStats;
+    }
+}
@@ -0,0 +1,88 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+#include "entity.h"
+#include "components.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+// runs the simulation systems at a fixed rate no matter how fast frames are drawn
+// drawables and cameras a tick moved are drawn blended between their world matrices from the last two ticks
+// the blend only goes into their InterpolatedMatrix, transforms and everything that reads them stay on the latest tick
+namespace FixedStepRunner
+{
+    constexpr float DefaultTickRate = 30;
+
+    // a frame longer than this many ticks drops the rest, the simulation slows down instead of spiralling
+    constexpr int DefaultMaxSteps = 5;
+
+    using TickFunction = std::function<void(float deltaTime)>;
+
+    struct Stats
+    {
+        int Ticks = 0;
+        size_t Interpolated = 0;
+
+        // simulation time thrown away because a frame needed more than the maximum steps
+        float DroppedTime = 0;
+    };
+
+    void Setup(float tickRate = DefaultTickRate, int maxSteps = DefaultMaxSteps);
+    void Shutdown();
+
+    // tick functions run in the order they were added
+    void AddSystem(const TickFunction& tick);
+
+    void SetTickRate(float ticksPerSecond);
+    float GetTickRate();
+    float GetTickDelta();
+
+    void SetMaxSteps(int steps);
+
+    void SetInterpolation(bool enabled);
+    bool IsInterpolating();
+
+    // runs whatever ticks the frame time covers and blends the draw matrices of what they moved
+    // something moved outside a tick is drawn where it is right away, and blends from its last tick position over the next one
+    void Update(float frameTime);
+
+    // how far the drawn state is between the last two ticks, 0 to 1
+    float GetAlpha();
+
+    // the draw matrix between two ticks' world matrices, translation and each axis lerped with the axis lengths kept
+    Matrix BlendMatrix(const Matrix& from, const Matrix& to, float alpha);
+
+    const Stats& GetStats();
+}
@@ -34,14 +34,14 @@
 
 namespace FreeFlightController
 {
-    void Update(TransformComponent* toMove)
+    void Update(TransformComponent* toMove, float deltaTime)
     {
         if (toMove == nullptr)
             return;
 
         FlightDataComponent* flightData = ComponentManager::MustGetComponent<FlightDataComponent>(toMove);
 
-        float speed = flightData->Speed * GetFrameTime();
+        float speed = flightData->Speed * deltaTime;
 
         if (IsKeyDown(KEY_LEFT_SHIFT))
             speed *= 5.0f;
@@ -61,7 +61,7 @@ namespace FreeFlightController
         else if (IsKeyDown(KEY_S))
             toMove->MoveForward(-speed);
 
-        float rotSpeed = flightData->RotationSpeed * GetFrameTime();
+        float rotSpeed = flightData->RotationSpeed * deltaTime;
 
         if (flightData->UseHeading)
         {
@@ -34,5 +34,6 @@
 
 namespace FreeFlightController
 {
-    void Update(TransformComponent* transform);
+    // deltaTime is the simulation step, the mouse moves since the last call are applied all at once
+    void Update(TransformComponent* transform, float deltaTime);
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "gl_render_backend.h"
+#include "shape_instancing.h"
+
+#include "raymath.h"
+#include "rlgl.h"
+
+void GLRenderBackend::Setup()
+{
+    ShapeInstancing::Setup();
+}
+
+void GLRenderBackend::Shutdown()
+{
+    ShapeInstancing::Shutdown();
+}
+
+int GLRenderBackend::GetViewportWidth()
+{
+    return GetScreenWidth();
+}
+
+int GLRenderBackend::GetViewportHeight()
+{
+    return GetScreenHeight();
+}
+
+bool GLRenderBackend::SupportsInstancing()
+{
+    return ShapeInstancing::IsAvailable();
+}
+
+void GLRenderBackend::BeginView(const Camera3D& camera)
+{
+    BeginMode3D(camera);
+}
+
+void GLRenderBackend::EndView()
+{
+    EndMode3D();
+}
+
+void GLRenderBackend::SetBackfaceCulling(bool enabled)
+{
+    rlDrawRenderBatchActive();
+
+    if (enabled)
+        rlEnableBackfaceCulling();
+    else
+        rlDisableBackfaceCulling();
+}
+
+void GLRenderBackend::PushMatrix(const Matrix& transform)
+{
+    // rlgl wants the matrix column major
+    Matrix glMatrix = MatrixTranspose(transform);
+
+    rlPushMatrix();
+    rlMultMatrixf(&glMatrix.m0);
+}
+
+void GLRenderBackend::PopMatrix()
+{
+    rlPopMatrix();
+}
+
+void GLRenderBackend::DrawMesh(const Mesh& mesh, const Material& material, const Matrix& transform)
+{
+    ::DrawMesh(mesh, material, transform);
+}
+
+void GLRenderBackend::DrawShapeGroup(const ShapeBatchBuilder& builder, const ShapeBatchBuilder::Group& group)
+{
+    ShapeInstancing::DrawGroup(builder, group);
+}
+
+void GLRenderBackend::UpdateMeshBuffer(const Mesh& mesh, int index, const void* data, int size)
+{
+    ::UpdateMeshBuffer(mesh, index, (void*)data, size, 0);
+}
+
+void GLRenderBackend::UpdateTexture(const Texture2D& texture, int width, int height, const void* data)
+{
+    rlUpdateTexture(texture.id, 0, 0, width, height, texture.format, data);
+}
+
+void GLRenderBackend::SetUniform(const Shader& shader, int location, const void* value, int uniformType, int count)
+{
+    SetShaderValueV(shader, location, value, uniformType, count);
+}
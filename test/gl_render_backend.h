@@ -0,0 +1,61 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+#include "render_backend.h"
+
+// draws through raylib and rlgl, needs the window and its GL context
+class GLRenderBackend : public RenderBackend
+{
+public:
+    void Setup() override;
+    void Shutdown() override;
+
+    int GetViewportWidth() override;
+    int GetViewportHeight() override;
+
+    bool SupportsInstancing() override;
+
+    void BeginView(const Camera3D& camera) override;
+    void EndView() override;
+
+    void SetBackfaceCulling(bool enabled) override;
+
+    void PushMatrix(const Matrix& transform) override;
+    void PopMatrix() override;
+
+    void DrawMesh(const Mesh& mesh, const Material& material, const Matrix& transform) override;
+    void DrawShapeGroup(const ShapeBatchBuilder& builder, const ShapeBatchBuilder::Group& group) override;
+
+    void UpdateMeshBuffer(const Mesh& mesh, int index, const void* data, int size) override;
+    void UpdateTexture(const Texture2D& texture, int width, int height, const void* data) override;
+
+    void SetUniform(const Shader& shader, int location, const void* value, int uniformType, int count) override;
+};
@@ -0,0 +1,54 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stdint.h>
+
+// a world matrix FixedStepRunner blends between the last two ticks, only the drawing code reads it
+// the blend is made against one version of the source matrix, once the source changes outside a tick it is drawn where it really is
+struct InterpolatedMatrix
+{
+    Matrix Blended = { 0 };
+
+    // the source version the blend was made from
+    uint32_t Version = 0;
+    bool Active = false;
+
+    // FixedStepRunner's slots for the owner
+    int32_t TrackedIndex = -1;
+    int32_t MovingIndex = -1;
+
+    inline const Matrix& Get(const Matrix& world, uint32_t version) const
+    {
+        return (Active && version == Version) ? Blended : world;
+    }
+};
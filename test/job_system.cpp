@@ -0,0 +1,179 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace JobSystem
+{
+    std::vector<std::thread> Workers;
+
+    std::mutex JobMutex;
+    std::condition_variable JobStart;
+    std::condition_variable JobDone;
+
+    // the loop currently being run, workers pick it up when the generation changes
+    const RangeFunction* CurrentFunction = nullptr;
+    size_t CurrentCount = 0;
+    size_t CurrentGrain = 1;
+    uint64_t Generation = 0;
+    size_t ActiveWorkers = 0;
+    bool Quit = false;
+
+    std::atomic<size_t> NextItem(0);
+
+    void RunChunks(const RangeFunction& function, size_t count, size_t grain, size_t threadIndex)
+    {
+        while (true)
+        {
+            size_t begin = NextItem.fetch_add(grain);
+            if (begin >= count)
+                return;
+
+            function(begin, std::min(begin + grain, count), threadIndex);
+        }
+    }
+
+    // a worker starts from the generation at Setup, so a loop left over from before a Shutdown is never picked up
+    void WorkerMain(size_t threadIndex, uint64_t seenGeneration)
+    {
+
+        while (true)
+        {
+            const RangeFunction* function = nullptr;
+            size_t count = 0;
+            size_t grain = 1;
+
+            {
+                std::unique_lock<std::mutex> lock(JobMutex);
+                JobStart.wait(lock, [&seenGeneration]() { return Quit || Generation != seenGeneration; });
+                if (Quit)
+                    return;
+
+                seenGeneration = Generation;
+                function = CurrentFunction;
+                count = CurrentCount;
+                grain = CurrentGrain;
+            }
+
+            RunChunks(*function, count, grain, threadIndex);
+
+            {
+                std::lock_guard<std::mutex> lock(JobMutex);
+                ActiveWorkers--;
+            }
+            JobDone.notify_one();
+        }
+    }
+
+    void Setup(size_t workerCount)
+    {
+        if (!Workers.empty())
+            return;
+
+        if (workerCount == 0)
+        {
+            size_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+
+        uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(JobMutex);
+            Quit = false;
+            generation = Generation;
+        }
+
+        for (size_t i = 0; i < workerCount; i++)
+            Workers.emplace_back(WorkerMain, i + 1, generation);
+    }
+
+    void Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(JobMutex);
+            Quit = true;
+        }
+        JobStart.notify_all();
+
+        for (std::thread& worker : Workers)
+            worker.join();
+
+        Workers.clear();
+
+        std::lock_guard<std::mutex> lock(JobMutex);
+        CurrentFunction = nullptr;
+        ActiveWorkers = 0;
+        Quit = false;
+    }
+
+    size_t GetThreadCount()
+    {
+        return Workers.size() + 1;
+    }
+
+    void ParallelFor(size_t count, size_t grainSize, const RangeFunction& function)
+    {
+        if (count == 0)
+            return;
+
+        if (grainSize == 0)
+            grainSize = 1;
+
+        // not worth waking anyone for a single chunk
+        if (Workers.empty() || count <= grainSize)
+        {
+            function(0, count, 0);
+            return;
+        }
+
+        NextItem = 0;
+        {
+            std::lock_guard<std::mutex> lock(JobMutex);
+            CurrentFunction = &function;
+            CurrentCount = count;
+            CurrentGrain = grainSize;
+            ActiveWorkers = Workers.size();
+            Generation++;
+        }
+        JobStart.notify_all();
+
+        RunChunks(function, count, grainSize, 0);
+
+        // every worker has to check in, even ones that found no work left, before the function can go out of scope
+        std::unique_lock<std::mutex> lock(JobMutex);
+        JobDone.wait(lock, []() { return ActiveWorkers == 0; });
+    }
+}
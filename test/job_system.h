@@ -0,0 +1,53 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <functional>
+
+// a fixed pool of worker threads for splitting loops across cores
+namespace JobSystem
+{
+    // the range of items [Begin, End) and which thread is running it, 0 is the calling thread
+    using RangeFunction = std::function<void(size_t begin, size_t end, size_t threadIndex)>;
+
+    // workerCount of 0 uses one less than the hardware thread count, the calling thread makes up the difference
+    void Setup(size_t workerCount = 0);
+    void Shutdown();
+
+    // worker threads plus the calling thread, sizes per thread storage for ParallelFor
+    size_t GetThreadCount();
+
+    /// <summary>
+    /// Split [0, count) into chunks of at most grainSize items and run them on every thread, returns when all are done.
+    /// The calling thread works too, so this also runs (serially) when Setup was never called.
+    /// Must not be called from inside a job.
+    /// </summary>
+    void ParallelFor(size_t count, size_t grainSize, const RangeFunction& function);
+}
@@ -0,0 +1,206 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "light_clusters.h"
+#include "bounds.h"
+
+#include <algorithm>
+#include <math.h>
+
+void LightClusterGrid::Setup(int tilesX, int tilesY, int slices)
+{
+    TilesX = std::max(1, tilesX);
+    TilesY = std::max(1, tilesY);
+    Slices = std::max(1, slices);
+
+    ClusterBounds.resize(GetClusterCount());
+    ClusterTable.assign(GetClusterCount() * 2, 0);
+    BoundsValid = false;
+}
+
+void LightClusterGrid::SetView(const Camera3D& camera, float aspect, float nearPlane, float farPlane)
+{
+    if (ClusterBounds.empty())
+        Setup();
+
+    View = MatrixLookAt(camera.position, camera.target, camera.up);
+
+    float tanHalfY = tanf(camera.fovy * 0.5f * DEG2RAD);
+    float tanHalfX = tanHalfY * aspect;
+
+    if (!BoundsValid || tanHalfX != TanHalfX || tanHalfY != TanHalfY || nearPlane != NearPlane || farPlane != FarPlane)
+    {
+        TanHalfX = tanHalfX;
+        TanHalfY = tanHalfY;
+        NearPlane = nearPlane;
+        FarPlane = farPlane;
+        LogDepthScale = Slices / logf(FarPlane / NearPlane);
+
+        BuildClusterBounds();
+    }
+}
+
+float LightClusterGrid::GetSliceDepth(int slice) const
+{
+    return NearPlane * powf(FarPlane / NearPlane, float(slice) / Slices);
+}
+
+int LightClusterGrid::GetSlice(float depth) const
+{
+    if (depth <= NearPlane)
+        return 0;
+
+    return std::min(Slices - 1, int(logf(depth / NearPlane) * LogDepthScale));
+}
+
+void LightClusterGrid::BuildClusterBounds()
+{
+    for (int slice = 0; slice < Slices; slice++)
+    {
+        float nearDepth = slice == 0 ? 0 : GetSliceDepth(slice);
+        float farDepth = GetSliceDepth(slice + 1);
+
+        for (int y = 0; y < TilesY; y++)
+        {
+            float ndcY0 = -1 + 2.0f * y / TilesY;
+            float ndcY1 = -1 + 2.0f * (y + 1) / TilesY;
+
+            for (int x = 0; x < TilesX; x++)
+            {
+                float ndcX0 = -1 + 2.0f * x / TilesX;
+                float ndcX1 = -1 + 2.0f * (x + 1) / TilesX;
+
+                // the tile's frustum slice widens with depth, so take the extremes of both ends
+                BoundingBox& bounds = ClusterBounds[GetClusterIndex(x, y, slice)];
+                bounds.min.x = std::min(ndcX0 * nearDepth, ndcX0 * farDepth) * TanHalfX;
+                bounds.max.x = std::max(ndcX1 * nearDepth, ndcX1 * farDepth) * TanHalfX;
+                bounds.min.y = std::min(ndcY0 * nearDepth, ndcY0 * farDepth) * TanHalfY;
+                bounds.max.y = std::max(ndcY1 * nearDepth, ndcY1 * farDepth) * TanHalfY;
+                bounds.min.z = -farDepth;
+                bounds.max.z = -nearDepth;
+            }
+        }
+    }
+
+    BoundsValid = true;
+}
+
+void LightClusterGrid::Bin(const std::vector<ClusterLight>& lights)
+{
+    Assignments.clear();
+
+    for (uint32_t lightIndex = 0; lightIndex < uint32_t(lights.size()); lightIndex++)
+    {
+        const ClusterLight& light = lights[lightIndex];
+        if (light.Radius <= 0)
+            continue;
+
+        Vector3 center = Vector3Transform(light.Position, View);
+        float radius = light.Radius;
+
+        float minDepth = -center.z - radius;
+        float maxDepth = -center.z + radius;
+        if (maxDepth < 0 || minDepth > FarPlane)
+            continue;
+
+        int firstSlice = GetSlice(minDepth);
+        int lastSlice = GetSlice(maxDepth);
+
+        // the tiles the box around the sphere projects to, everything when it reaches the eye
+        int firstX = 0, lastX = TilesX - 1, firstY = 0, lastY = TilesY - 1;
+        if (minDepth > NearPlane)
+        {
+            float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+            for (float depth : { minDepth, maxDepth })
+            {
+                for (float offset : { -radius, radius })
+                {
+                    float ndcX = (center.x + offset) / (depth * TanHalfX);
+                    float ndcY = (center.y + offset) / (depth * TanHalfY);
+                    minX = std::min(minX, ndcX);
+                    maxX = std::max(maxX, ndcX);
+                    minY = std::min(minY, ndcY);
+                    maxY = std::max(maxY, ndcY);
+                }
+            }
+
+            if (maxX < -1 || minX > 1 || maxY < -1 || minY > 1)
+                continue;
+
+            firstX = std::max(0, int(floorf((minX + 1) * 0.5f * TilesX)));
+            lastX = std::min(TilesX - 1, int(floorf((maxX + 1) * 0.5f * TilesX)));
+            firstY = std::max(0, int(floorf((minY + 1) * 0.5f * TilesY)));
+            lastY = std::min(TilesY - 1, int(floorf((maxY + 1) * 0.5f * TilesY)));
+        }
+
+        for (int slice = firstSlice; slice <= lastSlice; slice++)
+        {
+            for (int y = firstY; y <= lastY; y++)
+            {
+                for (int x = firstX; x <= lastX; x++)
+                {
+                    uint32_t cluster = uint32_t(GetClusterIndex(x, y, slice));
+                    // the candidate range is only a box around the sphere
+                    if (!SphereOverlapsBox(center, radius, ClusterBounds[cluster]))
+                        continue;
+
+                    Assignments.push_back(Assignment{ cluster, lightIndex });
+                }
+            }
+        }
+    }
+
+    // count
+    size_t clusterCount = GetClusterCount();
+    ClusterTable.assign(clusterCount * 2, 0);
+    for (const Assignment& assignment : Assignments)
+        ClusterTable[assignment.Cluster * 2 + 1]++;
+
+    // prefix sum into offsets
+    uint32_t offset = 0;
+    MaxPerCluster = 0;
+    for (size_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+        uint32_t count = ClusterTable[cluster * 2 + 1];
+        ClusterTable[cluster * 2] = offset;
+        offset += count;
+        MaxPerCluster = std::max(MaxPerCluster, count);
+
+        // reused as the fill cursor
+        ClusterTable[cluster * 2 + 1] = 0;
+    }
+
+    // fill, lights stay in input order within a cluster
+    LightIndices.resize(Assignments.size());
+    for (const Assignment& assignment : Assignments)
+    {
+        uint32_t& cursor = ClusterTable[assignment.Cluster * 2 + 1];
+        LightIndices[ClusterTable[assignment.Cluster * 2] + cursor] = assignment.Light;
+        cursor++;
+    }
+}
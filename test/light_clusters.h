@@ -0,0 +1,116 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// a point light as the cluster grid sees it, in world space
+struct ClusterLight
+{
+    Vector3 Position = { 0, 0, 0 };
+    float Radius = 1;
+    Color LightColor = WHITE;
+};
+
+// bins point lights into a grid of view space clusters: screen tiles in x and y, exponential depth slices in z
+// produces a per cluster (offset, count) table into one flat light index list, all on the CPU
+class LightClusterGrid
+{
+public:
+    static constexpr int DefaultTilesX = 16;
+    static constexpr int DefaultTilesY = 8;
+    static constexpr int DefaultSlices = 24;
+
+    void Setup(int tilesX = DefaultTilesX, int tilesY = DefaultTilesY, int slices = DefaultSlices);
+
+    // sets the view for the next Bin, the cluster bounds are only rebuilt when the projection changes
+    // depth slices run from nearPlane to farPlane, anything closer than nearPlane lands in the first slice
+    void SetView(const Camera3D& camera, float aspect, float nearPlane, float farPlane);
+
+    // count, prefix sum and fill, lights are referenced by their index in the input
+    void Bin(const std::vector<ClusterLight>& lights);
+
+    inline int GetTilesX() const { return TilesX; }
+    inline int GetTilesY() const { return TilesY; }
+    inline int GetSlices() const { return Slices; }
+    inline size_t GetClusterCount() const { return size_t(TilesX) * TilesY * Slices; }
+
+    inline float GetNearPlane() const { return NearPlane; }
+    inline float GetFarPlane() const { return FarPlane; }
+
+    // cluster index for a tile and slice, the same order the shader uses
+    inline size_t GetClusterIndex(int x, int y, int slice) const { return (size_t(slice) * TilesY + y) * TilesX + x; }
+
+    // the depth slice a view distance falls in
+    int GetSlice(float depth) const;
+
+    // two entries per cluster, the first light index and the light count
+    inline const std::vector<uint32_t>& GetClusterTable() const { return ClusterTable; }
+    inline const std::vector<uint32_t>& GetLightIndices() const { return LightIndices; }
+
+    // the view space bounds of a cluster (camera looking down -Z)
+    inline const BoundingBox& GetClusterBounds(size_t cluster) const { return ClusterBounds[cluster]; }
+
+    // the largest light count in any one cluster after the last Bin
+    inline uint32_t GetMaxLightsPerCluster() const { return MaxPerCluster; }
+
+private:
+    int TilesX = 0;
+    int TilesY = 0;
+    int Slices = 0;
+
+    Matrix View = { 0 };
+    float TanHalfX = 1;
+    float TanHalfY = 1;
+    float NearPlane = 0.1f;
+    float FarPlane = 1000;
+    float LogDepthScale = 1;
+
+    std::vector<BoundingBox> ClusterBounds;
+    bool BoundsValid = false;
+
+    struct Assignment
+    {
+        uint32_t Cluster;
+        uint32_t Light;
+    };
+    std::vector<Assignment> Assignments;
+
+    std::vector<uint32_t> ClusterTable;
+    std::vector<uint32_t> LightIndices;
+    uint32_t MaxPerCluster = 0;
+
+    void BuildClusterBounds();
+    float GetSliceDepth(int slice) const;
+};
@@ -30,58 +30,37 @@
 #include "transform_component.h"
 #include "color_component.h"
 
-void LightComponent::Setup(int index, Shader& shader)
+void LightComponent::Setup(int index, ShaderUniformCache& uniforms)
 {
     LightIndex = index;
     LightEnabled = 1;
 
-    // TODO: Below code doesn't look good to me, 
-    // it assumes a specific shader naming and structure
-    // Probably this implementation could be improved
-    char enabledName[32] = "lights[x].enabled\0";
-    char typeName[32] = "lights[x].type\0";
-    char posName[32] = "lights[x].position\0";
-    char targetName[32] = "lights[x].target\0";
-    char colorName[32] = "lights[x].color\0";
+    // the cache only looks each name up once per shader, lights that reuse a slot get the same handles
+    EnabledUniform = uniforms.Register(TextFormat("lights[%i].enabled", LightIndex), SHADER_UNIFORM_INT);
+    TypeUniform = uniforms.Register(TextFormat("lights[%i].type", LightIndex), SHADER_UNIFORM_INT);
+    PosUniform = uniforms.Register(TextFormat("lights[%i].position", LightIndex), SHADER_UNIFORM_VEC3);
+    TargetUniform = uniforms.Register(TextFormat("lights[%i].target", LightIndex), SHADER_UNIFORM_VEC3);
+    ColorUniform = uniforms.Register(TextFormat("lights[%i].color", LightIndex), SHADER_UNIFORM_VEC4);
 
-    // Set location name [x] depending on lights count
-    enabledName[7] = '0' + LightIndex;
-    typeName[7] = '0' + LightIndex;
-    posName[7] = '0' + LightIndex;
-    targetName[7] = '0' + LightIndex;
-    colorName[7] = '0' + LightIndex;
-
-    EnabledLoc = GetShaderLocation(shader, enabledName);
-    TypeLoc = GetShaderLocation(shader, typeName);
-    PosLoc = GetShaderLocation(shader, posName);
-    TargetLoc = GetShaderLocation(shader, targetName);
-    ColorLoc = GetShaderLocation(shader, colorName);
-
-    Update(shader);
+    Update(uniforms);
 }
 
-void LightComponent::Update(Shader& shader)
+void LightComponent::Update(ShaderUniformCache& uniforms)
 {
-    // Send to shader light enabled state and type
-    SetShaderValue(shader, EnabledLoc, &LightEnabled, SHADER_UNIFORM_INT);
-    SetShaderValue(shader, TypeLoc, &LightType, SHADER_UNIFORM_INT);
+    // Send to shader light enabled state and type, only what changed is uploaded
+    int type = int(LightType);
+    uniforms.Set(EnabledUniform, &LightEnabled);
+    uniforms.Set(TypeUniform, &type);
 
     auto* transform = MustGetComponent<TransformComponent>();
 
     Vector3 pos = transform->GetWorldPosition();
-    float p[3] = { pos.x,pos.y,pos.z };
-   
-    // Send to shader light position values
-    SetShaderValue(shader, PosLoc, p, SHADER_UNIFORM_VEC3);
+    uniforms.Set(PosUniform, &pos.x);
 
-    // Send to shader light target position values
     Vector3 target = { 0 };
     if (LightType == LightTypes::DIRECTIONAL)
         target = transform->GetWorldTarget();
 
-    float t[3] = { target.x,target.y,target.z };
-
-    SetShaderValue(shader, TargetLoc, &target.x, SHADER_UNIFORM_VEC3);
-
-    SetShaderValue(shader, ColorLoc, MustGetComponent<ColorComponent>()->GetGLColor(), SHADER_UNIFORM_VEC4);
+    uniforms.Set(TargetUniform, &target.x);
+    uniforms.Set(ColorUniform, MustGetComponent<ColorComponent>()->GetGLColor());
 }
@@ -30,6 +30,7 @@
 
 #include "components.h"
 #include "transform_component.h"
+#include "shader_uniform_cache.h"
 
 #include "raylib.h"
 
@@ -45,21 +46,24 @@ public:
     LightTypes LightType = LightTypes::POINT;
     int LightEnabled = 1;
 
+    // how far a point light reaches, used to bin it into the light clusters
+    float Radius = 10;
+
 protected:
     int LightIndex = -1;
 
-    // Shader locations
-    int EnabledLoc;
-    int TypeLoc;
-    int PosLoc;
-    int TargetLoc;
-    int ColorLoc;
+    // Shader uniforms
+    ShaderUniformCache::Handle EnabledUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle TypeUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle PosUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle TargetUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle ColorUniform = ShaderUniformCache::InvalidHandle;
 
 public:
     DEFINE_COMPONENT(LightComponent);
 
     inline bool IsSetup() const { return LightIndex != -1; };
 
-    void Setup(int index, Shader& shader);
-    void Update(Shader& shader);
+    void Setup(int index, ShaderUniformCache& uniforms);
+    void Update(ShaderUniformCache& uniforms);
 };
\ No newline at end of file
@@ -30,87 +30,312 @@
 
 #include "light_component.h"
 #include "transform_component.h"
+#include "color_component.h"
+#include "render_system.h"
+#include "resource_manager.h"
+#include "async_loader.h"
+#include "render_backend.h"
 
 #include "raylib.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <math.h>
 #include <set>
+#include <vector>
 
 namespace LightingSystem
 {
-    Shader LightShader;
+    Shader LightShader = { 0 };
+    ResourceManager::ShaderHandle LightShaderResource;
+    AsyncLoader::RequestId ShaderLoad = AsyncLoader::InvalidRequest;
 
     std::set<int> UsedLightIds;
 
 #define GLSL_VERSION            330
-#define MAX_LIGHTS              4         // Max dynamic lights supported by shader
+#define MAX_LIGHTS              4         // Max directional lights supported by shader
+
+    // depth slices start here, anything closer shares the first slice
+    constexpr float ClusterNearDepth = 1.0f;
+
+    // the cluster data rides along in material map slots the lighting shader does not otherwise use
+    constexpr int LightDataMap = MATERIAL_MAP_OCCLUSION;
+    constexpr int ClusterTableMap = MATERIAL_MAP_EMISSION;
+    constexpr int LightIndexMap = MATERIAL_MAP_HEIGHT;
+
+    // two RGBA float texels per light, position and radius then color
+    constexpr int LightDataWidth = 1024;
+    constexpr int LightDataRows = (MaxClusterLights * 2) / LightDataWidth;
+
+    constexpr int LightIndexWidth = 1024;
+    constexpr int LightIndexRows = MaxClusterLightIndices / LightIndexWidth;
+
+    LightClusterGrid Clusters;
+    std::vector<ClusterLight> PointLights;
+
+    Texture2D LightDataTexture = { 0 };
+    Texture2D ClusterTableTexture = { 0 };
+    Texture2D LightIndexTexture = { 0 };
+
+    std::vector<float> LightDataBuffer;
+    std::vector<float> ClusterTableBuffer;
+    std::vector<float> LightIndexBuffer;
+
+    ShaderUniformCache Uniforms;
+
+    ShaderUniformCache::Handle ViewPosUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle ClusterDepthUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle ViewportSizeUniform = ShaderUniformCache::InvalidHandle;
+    ShaderUniformCache::Handle ViewForwardUniform = ShaderUniformCache::InvalidHandle;
+
+    LightingStats Stats;
 
     Shader& GetShader()
     {
         return LightShader;
     }
 
-    void Setup()
+    Texture2D LoadDataTexture(int width, int height, int format)
+    {
+        Texture2D texture = { 0 };
+        texture.id = rlLoadTexture(nullptr, width, height, format, 1);
+        texture.width = width;
+        texture.height = height;
+        texture.mipmaps = 1;
+        texture.format = format;
+
+        return texture;
+    }
+
+    void OnShaderLoaded(ResourceManager::ShaderHandle handle)
     {
-        LightShader = LoadShader(TextFormat("resources/shaders/glsl%i/base_lighting.vs", GLSL_VERSION),
-            TextFormat("resources/shaders/glsl%i/lighting.fs", GLSL_VERSION));
+        ShaderLoad = AsyncLoader::InvalidRequest;
+
+        Shader* shader = ResourceManager::Get(handle);
+        if (shader == nullptr)
+            return;
+
+        LightShaderResource = handle;
+        LightShader = *shader;
         
-        LightShader.locs[SHADER_LOC_VECTOR_VIEW] = GetShaderLocation(LightShader, "viewPos");
+        Uniforms.Setup(LightShader);
+
+        ViewPosUniform = Uniforms.Register("viewPos", SHADER_UNIFORM_VEC3);
+        LightShader.locs[SHADER_LOC_VECTOR_VIEW] = Uniforms.GetLocation(ViewPosUniform);
 
         // Ambient light level (some basic lighting)
-        int ambientLoc = GetShaderLocation(LightShader, "ambient");
-        
         float color[4] = { 0.2f, 0.2f, 0.2f, 1.0f };
-
-        SetShaderValue(LightShader, ambientLoc, color, SHADER_UNIFORM_VEC4);
+        Uniforms.Set(Uniforms.Register("ambient", SHADER_UNIFORM_VEC4), color);
 
         // disable all lights
-        char enabledName[32] = "lights[x].enabled\0";
         for (int i = 0; i < MAX_LIGHTS; i++)
         {
-            enabledName[7] = '0' + i;
-
-            auto loc = GetShaderLocation(LightShader, enabledName);
             int val = 0;
-            SetShaderValue(LightShader, loc, &val, SHADER_UNIFORM_INT);
+            Uniforms.Set(Uniforms.Register(TextFormat("lights[%i].enabled", i), SHADER_UNIFORM_INT), &val);
         }
+
+        LightShader.locs[SHADER_LOC_MAP_OCCLUSION] = GetShaderLocation(LightShader, "lightData");
+        LightShader.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(LightShader, "clusterTable");
+        LightShader.locs[SHADER_LOC_MAP_HEIGHT] = GetShaderLocation(LightShader, "lightIndices");
+
+        ClusterDepthUniform = Uniforms.Register("clusterDepth", SHADER_UNIFORM_VEC2);
+        ViewportSizeUniform = Uniforms.Register("viewportSize", SHADER_UNIFORM_VEC2);
+        ViewForwardUniform = Uniforms.Register("viewForward", SHADER_UNIFORM_VEC3);
+
+        int dims[3] = { Clusters.GetTilesX(), Clusters.GetTilesY(), Clusters.GetSlices() };
+        Uniforms.Set(Uniforms.Register("clusterDims", SHADER_UNIFORM_IVEC3), dims);
+    }
+
+    void Setup()
+    {
+        Clusters.Setup();
+
+        // fixed size textures so the ids handed to materials never change
+        LightDataTexture = LoadDataTexture(LightDataWidth, LightDataRows, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32);
+        ClusterTableTexture = LoadDataTexture(Clusters.GetTilesX() * Clusters.GetTilesY(), Clusters.GetSlices(), PIXELFORMAT_UNCOMPRESSED_R32G32B32);
+        LightIndexTexture = LoadDataTexture(LightIndexWidth, LightIndexRows, PIXELFORMAT_UNCOMPRESSED_R32);
+
+        // the shader sources are read in the background, lighting starts once it is compiled
+        ShaderLoad = AsyncLoader::LoadShader(TextFormat("resources/shaders/glsl%i/base_lighting.vs", GLSL_VERSION),
+            TextFormat("resources/shaders/glsl%i/lighting_clustered.fs", GLSL_VERSION), OnShaderLoaded);
+    }
+
+    bool IsReady()
+    {
+        return LightShader.id != 0;
+    }
+
+    void Shutdown()
+    {
+        AsyncLoader::Cancel(ShaderLoad);
+        ShaderLoad = AsyncLoader::InvalidRequest;
+
+        UnloadTexture(LightDataTexture);
+        UnloadTexture(ClusterTableTexture);
+        UnloadTexture(LightIndexTexture);
+
+        LightDataTexture = ClusterTableTexture = LightIndexTexture = Texture2D{ 0 };
+
+        ResourceManager::Release(LightShaderResource);
+        LightShader = Shader{ 0 };
+        Uniforms.Clear();
+        UsedLightIds.clear();
+        PointLights.clear();
     }
 
     void UpdateLights()
     {
+        if (!IsReady())
+            return;
+
+        PointLights.clear();
+        Stats.DirectionalLights = 0;
+
         ComponentManager::DoForEachEntity<LightComponent>([](LightComponent* light)
             {
                 if (!light->LightEnabled || !light->Active)
                     return;
 
+                if (light->LightType == LightTypes::POINT)
+                {
+                    if (PointLights.size() >= MaxClusterLights)
+                        return;
+
+                    ClusterLight clusterLight;
+                    clusterLight.Position = light->MustGetComponent<TransformComponent>()->GetWorldPosition();
+                    clusterLight.Radius = light->Radius;
+                    clusterLight.LightColor = light->MustGetComponent<ColorComponent>()->GetColor();
+                    PointLights.push_back(clusterLight);
+                    return;
+                }
+
                 if (!light->IsSetup())
                 {
                     int id = 0;
                     while (UsedLightIds.find(id) != UsedLightIds.end())
                     {
                         id++;
-                        if (id > MAX_LIGHTS)
+                        if (id >= MAX_LIGHTS)
                             return;
                     }
                     UsedLightIds.insert(id);
-                    light->Setup(id, LightShader);
+                    light->Setup(id, Uniforms);
                 }
                 else
                 {
-                    light->Update(LightShader);
+                    light->Update(Uniforms);
                 }
+                Stats.DirectionalLights++;
             });
+
+        Stats.PointLights = int(PointLights.size());
+    }
+
+    void UploadClusters()
+    {
+        // lights, padded out to whole rows
+        int lightRows = std::max(1, int((PointLights.size() * 2 + LightDataWidth - 1) / LightDataWidth));
+        LightDataBuffer.assign(size_t(lightRows) * LightDataWidth * 4, 0.0f);
+        for (size_t i = 0; i < PointLights.size(); i++)
+        {
+            const ClusterLight& light = PointLights[i];
+            float* texel = &LightDataBuffer[i * 8];
+            texel[0] = light.Position.x;
+            texel[1] = light.Position.y;
+            texel[2] = light.Position.z;
+            texel[3] = light.Radius;
+            texel[4] = light.LightColor.r / 255.0f;
+            texel[5] = light.LightColor.g / 255.0f;
+            texel[6] = light.LightColor.b / 255.0f;
+            texel[7] = light.LightColor.a / 255.0f;
+        }
+        RenderBackend::Get().UpdateTexture(LightDataTexture, LightDataWidth, lightRows, LightDataBuffer.data());
+
+        // offset and count per cluster, floats are exact well past the index limit
+        const std::vector<uint32_t>& table = Clusters.GetClusterTable();
+        const std::vector<uint32_t>& indices = Clusters.GetLightIndices();
+        size_t indexCount = std::min(indices.size(), size_t(MaxClusterLightIndices));
+
+        size_t clusterCount = Clusters.GetClusterCount();
+        ClusterTableBuffer.resize(clusterCount * 3);
+        for (size_t cluster = 0; cluster < clusterCount; cluster++)
+        {
+            uint32_t offset = table[cluster * 2];
+            uint32_t count = table[cluster * 2 + 1];
+
+            // clusters past the index limit lose their lights rather than reading garbage
+            if (offset + count > indexCount)
+                count = offset < indexCount ? uint32_t(indexCount - offset) : 0;
+
+            ClusterTableBuffer[cluster * 3] = float(offset);
+            ClusterTableBuffer[cluster * 3 + 1] = float(count);
+            ClusterTableBuffer[cluster * 3 + 2] = 0;
+        }
+        RenderBackend::Get().UpdateTexture(ClusterTableTexture, ClusterTableTexture.width, ClusterTableTexture.height, ClusterTableBuffer.data());
+
+        int indexRows = std::max(1, int((indexCount + LightIndexWidth - 1) / LightIndexWidth));
+        LightIndexBuffer.assign(size_t(indexRows) * LightIndexWidth, 0.0f);
+        for (size_t i = 0; i < indexCount; i++)
+            LightIndexBuffer[i] = float(indices[i]);
+        RenderBackend::Get().UpdateTexture(LightIndexTexture, LightIndexWidth, indexRows, LightIndexBuffer.data());
     }
 
     void Update(uint64_t cameraEntity)
     {
+        if (!IsReady())
+            return;
+
         auto* transform = ComponentManager::MustGetComponent<TransformComponent>(cameraEntity);
         Vector3 cameraPos = transform->GetWorldPosition();
-        float p[3] = { cameraPos.x,cameraPos.y,cameraPos.z };
-        SetShaderValue(LightShader, LightShader.locs[SHADER_LOC_VECTOR_VIEW], p, SHADER_UNIFORM_VEC3);
+        Uniforms.Set(ViewPosUniform, &cameraPos.x);
+
+        // bin the point lights against this camera's view
+        Camera3D camera = RenderSystem::GetCameraView(cameraEntity);
+        float viewport[2] = { float(RenderBackend::Get().GetViewportWidth()), float(RenderBackend::Get().GetViewportHeight()) };
+
+        Clusters.SetView(camera, viewport[0] / viewport[1], ClusterNearDepth, float(RL_CULL_DISTANCE_FAR));
+        Clusters.Bin(PointLights);
+        UploadClusters();
+
+        Stats.ClusterAssignments = Clusters.GetLightIndices().size();
+        Stats.MaxLightsPerCluster = Clusters.GetMaxLightsPerCluster();
+
+        Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+        float depth[2] = { Clusters.GetNearPlane(), Clusters.GetSlices() / logf(Clusters.GetFarPlane() / Clusters.GetNearPlane()) };
+
+        Uniforms.Set(ViewForwardUniform, &forward.x);
+        Uniforms.Set(ClusterDepthUniform, depth);
+        Uniforms.Set(ViewportSizeUniform, viewport);
+
+        Stats.UniformUploads = Uniforms.GetIssuedUploads();
+        Stats.UniformUploadsSkipped = Uniforms.GetSkippedUploads();
     }
 
     void SetMaterial(Material& material, Color& albedoColor)
     {
-        material.shader = GetShader();
+        // until the shader arrives the material keeps the one it has
+        if (IsReady())
+            material.shader = GetShader();
+
         material.maps[MAP_DIFFUSE].color = albedoColor;
+
+        material.maps[LightDataMap].texture = LightDataTexture;
+        material.maps[ClusterTableMap].texture = ClusterTableTexture;
+        material.maps[LightIndexMap].texture = LightIndexTexture;
+    }
+
+    const LightClusterGrid& GetClusters()
+    {
+        return Clusters;
+    }
+
+    ShaderUniformCache& GetUniforms()
+    {
+        return Uniforms;
+    }
+
+    const LightingStats& GetStats()
+    {
+        return Stats;
     }
-}
\ No newline at end of file
+}
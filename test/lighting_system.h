@@ -31,13 +31,43 @@
 #include "stdint.h"
 #include "raylib.h"
 
+#include "light_clusters.h"
+#include "shader_uniform_cache.h"
+
 namespace LightingSystem
 {
+    // point lights are binned into view space clusters and read from textures, so they have no fixed limit
+    // directional lights still go through the small uniform array in the shader
+    constexpr int MaxClusterLights = 16384;
+    constexpr int MaxClusterLightIndices = 1024 * 1024;
+
+    struct LightingStats
+    {
+        int DirectionalLights = 0;
+        int PointLights = 0;
+        size_t ClusterAssignments = 0;
+        uint32_t MaxLightsPerCluster = 0;
+
+        // running totals from the uniform cache
+        size_t UniformUploads = 0;
+        size_t UniformUploadsSkipped = 0;
+    };
+
     Shader& GetShader();
 
+    // the shader loads through the AsyncLoader, nothing is lit until IsReady
     void Setup();
+    void Shutdown();
+    bool IsReady();
     void Update(uint64_t cameraEntity);
     void UpdateLights();
 
+    // materials set up before the shader is ready keep their shader, set them again once IsReady
     void SetMaterial(Material& material, Color& albedoColor);
-}
\ No newline at end of file
+
+    const LightClusterGrid& GetClusters();
+
+    // every uniform the lighting shader uses goes through here so unchanged values are not uploaded again
+    ShaderUniformCache& GetUniforms();
+    const LightingStats& GetStats();
+}
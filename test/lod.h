@@ -0,0 +1,57 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <math.h>
+
+// level of detail selection by projected screen size
+namespace LOD
+{
+    constexpr int MaxLevels = 4;
+
+    // how far past a threshold the screen size has to move before the level changes, as a fraction of the threshold
+    constexpr float Hysteresis = 0.15f;
+
+    // the approximate height in pixels of the bounding sphere around a world space box
+    inline float GetScreenSize(const BoundingBox& worldBounds, const Camera3D& camera, float viewportHeight)
+    {
+        Vector3 center = Vector3Scale(Vector3Add(worldBounds.min, worldBounds.max), 0.5f);
+        float radius = Vector3Length(Vector3Subtract(worldBounds.max, center));
+        float distance = Vector3Distance(center, camera.position);
+
+        // inside the sphere it covers the whole view
+        if (distance <= radius)
+            return viewportHeight;
+
+        return (radius * viewportHeight) / (distance * tanf(camera.fovy * 0.5f * DEG2RAD));
+    }
+}
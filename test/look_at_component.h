@@ -43,8 +43,6 @@ public:
 public:
     DEFINE_COMPONENT(LookAtComponent);
 
-    inline void OnCreate() override { NeedUpdate = true; }
-
     inline void SetTarget(Component* component)
     {
         if (component == nullptr)
@@ -52,18 +50,4 @@ public:
         else
             TargetEntityId = component->EntityId;
     }
-
-    inline void OnUpdate()
-    {
-        if (TargetEntityId == uint64_t(-1))
-            return;
-
-        TransformComponent* selfTransform = ComponentManager::MustGetComponent<TransformComponent>(this);
-
-        TransformComponent* taretTransform = ComponentManager::MustGetComponent<TransformComponent>(TargetEntityId);
-
-        Vector3 targetPos = Vector3Transform(Vector3Zero(), taretTransform->GetWorldMatrix());
-
-        selfTransform->LookAt(targetPos, Vector3{ 0,0,1 });
-    }
 };
\ No newline at end of file
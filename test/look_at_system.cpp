@@ -0,0 +1,137 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "look_at_system.h"
+
+#include "look_at_component.h"
+#include "transform_component.h"
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <vector>
+#include <algorithm>
+#include <xmmintrin.h>
+
+namespace LookAtSystem
+{
+    struct LookAtEntry
+    {
+        LookAtComponent* LookAt = nullptr;
+        TransformComponent* Self = nullptr;
+        TransformComponent* Target = nullptr;
+        uint64_t ResolvedTargetId = uint64_t(-1);
+    };
+
+    std::vector<LookAtEntry> Entries;
+
+    // work buffers reused every frame
+    std::vector<LookAtEntry*> Batch;
+    std::vector<Vector3> TargetPositions;
+
+    constexpr size_t PrefetchDistance = 4;
+
+    void OnLookAtAdded(Component* component)
+    {
+        LookAtEntry entry;
+        entry.LookAt = static_cast<LookAtComponent*>(component);
+        Entries.push_back(entry);
+    }
+
+    void OnLookAtRemoved(Component* component)
+    {
+        auto itr = std::find_if(Entries.begin(), Entries.end(), [component](const LookAtEntry& entry) { return entry.LookAt == component; });
+        if (itr == Entries.end())
+            return;
+
+        *itr = Entries.back();
+        Entries.pop_back();
+    }
+
+    void OnTransformRemoved(Component* component)
+    {
+        for (LookAtEntry& entry : Entries)
+        {
+            if (entry.Self == component)
+                entry.Self = nullptr;
+
+            if (entry.Target == component)
+            {
+                entry.Target = nullptr;
+                entry.ResolvedTargetId = uint64_t(-1);
+            }
+        }
+    }
+
+    void Setup()
+    {
+        Entries.clear();
+        ComponentManager::DoForEachEntity<LookAtComponent>([](LookAtComponent* lookAt) { OnLookAtAdded(lookAt); });
+
+        ComponentManager::AddAddObserver<LookAtComponent>(OnLookAtAdded);
+        ComponentManager::AddRemoveObserver<LookAtComponent>(OnLookAtRemoved);
+        ComponentManager::AddRemoveObserver<TransformComponent>(OnTransformRemoved);
+    }
+
+    void Update()
+    {
+        // resolve the transforms, only looking them up when the target changes
+        Batch.clear();
+        for (LookAtEntry& entry : Entries)
+        {
+            LookAtComponent* lookAt = entry.LookAt;
+            if (!lookAt->Active || lookAt->TargetEntityId == uint64_t(-1))
+                continue;
+
+            if (entry.Self == nullptr)
+                entry.Self = ComponentManager::MustGetComponent<TransformComponent>(lookAt);
+
+            if (entry.Target == nullptr || entry.ResolvedTargetId != lookAt->TargetEntityId)
+            {
+                entry.Target = ComponentManager::MustGetComponent<TransformComponent>(lookAt->TargetEntityId);
+                entry.ResolvedTargetId = lookAt->TargetEntityId;
+            }
+
+            Batch.push_back(&entry);
+        }
+
+        // fetch every target position before any transform is changed, prefetching a few targets ahead
+        TargetPositions.resize(Batch.size());
+        for (size_t i = 0; i < Batch.size(); i++)
+        {
+            if (i + PrefetchDistance < Batch.size())
+                _mm_prefetch(reinterpret_cast<const char*>(Batch[i + PrefetchDistance]->Target), _MM_HINT_T0);
+
+            const Matrix& targetMatrix = Batch[i]->Target->GetWorldMatrix();
+            TargetPositions[i] = Vector3{ targetMatrix.m12, targetMatrix.m13, targetMatrix.m14 };
+        }
+
+        for (size_t i = 0; i < Batch.size(); i++)
+            Batch[i]->Self->LookAt(TargetPositions[i], Vector3{ 0,0,1 });
+    }
+}
@@ -34,10 +34,24 @@
 #include "drawable_component.h"
 #include "flight_data_component.h"
 #include "look_at_component.h"
+#include "occluder_component.h"
+#include "static_batch_component.h"
 #include "transform_component.h"
 
+#include "async_loader.h"
+#include "automover_system.h"
+#include "fixed_step_runner.h"
 #include "free_flight_controller.h"
+#include "gl_render_backend.h"
+#include "job_system.h"
+#include "look_at_system.h"
+#include "occlusion_culling.h"
 #include "render_system.h"
+#include "resource_manager.h"
+#include "spatial_index_system.h"
+#include "static_batch_system.h"
+#include "visibility_system.h"
+#include "world_streaming.h"
 
 uint64_t targetEntityId = uint64_t(-1);
 
@@ -115,6 +129,25 @@ void CreateTestEntity()
 std::vector<TransformComponent*> Cameras;
 size_t cameraIndex = 0;
 
+uint64_t pickedEntityId = uint64_t(-1);
+
+void PickEntity()
+{
+    std::vector<DynamicBVH::RayHit> hits;
+    SpatialIndexSystem::RayCast(GetMouseRay(GetMousePosition(), RenderSystem::GetViewCamera()), 1000, hits);
+
+    // skip the camera we are looking through
+    pickedEntityId = uint64_t(-1);
+    for (const DynamicBVH::RayHit& hit : hits)
+    {
+        if (hit.UserData != Cameras[cameraIndex]->EntityId)
+        {
+            pickedEntityId = hit.UserData;
+            break;
+        }
+    }
+}
+
 void CreateCameras()
 {
     // the free flight camera
@@ -184,14 +217,22 @@ void CreateCameras()
     Cameras.push_back(camera);
 }
 
-void DrawGrid()
+void AddStaticCube(Vector3 position, Vector3 size, Color color)
 {
-    // world grid
-    rlPushMatrix();
-    rlRotatef(90, 1, 0, 0);
-    DrawGrid(50, 2.5f);
-    rlPopMatrix();
+    TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+    transform->SetPosition(position.x, position.y, position.z);
+
+    ShapeComponent* drawable = ComponentManager::AddComponent<ShapeComponent>(transform);
+    drawable->MustGetComponent<ColorComponent>()->SetColor(color);
+    drawable->ObjectShape = DrawShape::Box;
+    drawable->ObjectSize = size;
 
+    // never moves, so it is baked into a static batch
+    ComponentManager::AddComponent<StaticBatchComponent>(transform);
+}
+
+void CreateStaticGrid()
+{
     for (float y = -20; y <= 20; y += 5)
     {
         for (float x = -20; x <= 20; x += 5)
@@ -212,7 +253,7 @@ void DrawGrid()
                     c = ORANGE;
             }
 
-            DrawCube(Vector3{ x,y, 0 }, 0.5f, 0.5f, 0, c);
+            AddStaticCube(Vector3{ x,y, 0 }, Vector3{ 0.5f, 0.5f, 0 }, c);
         }
     }
 
@@ -225,32 +266,250 @@ void DrawGrid()
         if (z < 0)
             c = GRAY;
 
-        DrawCube(Vector3{ 0,0,z }, 0.125f, 0.125f, 0.125f, c);
+        AddStaticCube(Vector3{ 0,0,z }, Vector3{ 0.125f, 0.125f, 0.125f }, c);
+    }
+}
+
+void CreateOccluderWall()
+{
+    TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+    transform->SetPosition(0, -25, 2);
+
+    ShapeComponent* drawable = ComponentManager::AddComponent<ShapeComponent>(transform);
+    drawable->MustGetComponent<ColorComponent>()->SetColor(LIGHTGRAY);
+    drawable->ObjectShape = DrawShape::Box;
+    drawable->ObjectSize = Vector3{ 30, 1, 4 };
+
+    // solid, so anything behind it from the camera's point of view can be skipped
+    ComponentManager::AddComponent<OccluderComponent>(transform);
+}
+
+// runs on a loader thread, so it only fills in CPU arrays
+bool BuildTerrainMesh(Mesh& mesh)
+{
+    constexpr int cells = 128;
+    constexpr float size = 20;
+    constexpr int side = cells + 1;
+
+    mesh.vertexCount = side * side;
+    mesh.triangleCount = cells * cells * 2;
+    mesh.vertices = (float*)RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+    mesh.normals = (float*)RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+    mesh.texcoords = (float*)RL_MALLOC(mesh.vertexCount * 2 * sizeof(float));
+    mesh.indices = (unsigned short*)RL_MALLOC(mesh.triangleCount * 3 * sizeof(unsigned short));
+
+    for (int y = 0; y < side; y++)
+    {
+        for (int x = 0; x < side; x++)
+        {
+            float u = float(x) / cells;
+            float v = float(y) / cells;
+            float px = (u - 0.5f) * size;
+            float py = (v - 0.5f) * size;
+
+            // rolling hills and the slope of them for the normal
+            float height = sinf(px * 0.6f) * cosf(py * 0.4f);
+            float dx = 0.6f * cosf(px * 0.6f) * cosf(py * 0.4f);
+            float dy = -0.4f * sinf(px * 0.6f) * sinf(py * 0.4f);
+            Vector3 normal = Vector3Normalize(Vector3{ -dx, -dy, 1 });
+
+            int vertex = y * side + x;
+            mesh.vertices[vertex * 3 + 0] = px;
+            mesh.vertices[vertex * 3 + 1] = py;
+            mesh.vertices[vertex * 3 + 2] = height;
+            mesh.normals[vertex * 3 + 0] = normal.x;
+            mesh.normals[vertex * 3 + 1] = normal.y;
+            mesh.normals[vertex * 3 + 2] = normal.z;
+            mesh.texcoords[vertex * 2 + 0] = u;
+            mesh.texcoords[vertex * 2 + 1] = v;
+        }
+    }
+
+    int index = 0;
+    for (int y = 0; y < cells; y++)
+    {
+        for (int x = 0; x < cells; x++)
+        {
+            unsigned short corner = (unsigned short)(y * side + x);
+            unsigned short quad[6] = { corner, (unsigned short)(corner + 1), (unsigned short)(corner + side + 1), corner, (unsigned short)(corner + side + 1), (unsigned short)(corner + side) };
+            for (unsigned short i : quad)
+                mesh.indices[index++] = i;
+        }
+    }
+
+    return true;
+}
+
+void CreateTerrain()
+{
+    TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>();
+    transform->SetPosition(40, 0, -1);
+
+    MeshComponent* drawable = ComponentManager::AddComponent<MeshComponent>(transform);
+    drawable->MustGetComponent<ColorComponent>()->SetColor(DARKGREEN);
+    drawable->UseColor = true;
+
+    // shows the placeholder cube until the loader hands the mesh over
+    drawable->LoadMeshAsync("terrain", BuildTerrainMesh);
+}
+
+// a forest too big to keep in the world, built once and written out as streaming cells
+void CreateStreamedForest()
+{
+    constexpr float cellSize = 16;
+    constexpr float extent = 160;
+
+    std::vector<uint64_t> roots;
+    for (float y = -extent; y < extent; y += 4)
+    {
+        for (float x = -extent; x < extent; x += 4)
+        {
+            // jitter so it doesn't read as a grid, and keep clear of the scene in the middle
+            float px = x + float(GetRandomValue(0, 300)) / 100.0f;
+            float py = y + float(GetRandomValue(0, 300)) / 100.0f;
+            if (fabsf(px) < 35 && fabsf(py) < 35)
+                continue;
+
+            TransformComponent* trunk = ComponentManager::AddComponent<TransformComponent>();
+            trunk->SetPosition(px, py, 1);
+
+            ShapeComponent* drawable = ComponentManager::AddComponent<ShapeComponent>(trunk);
+            drawable->MustGetComponent<ColorComponent>()->SetColor(BROWN);
+            drawable->ObjectShape = DrawShape::Box;
+            drawable->ObjectSize = Vector3{ 0.25f, 0.25f, 2 };
+
+            TransformComponent* crown = ComponentManager::AddComponent<TransformComponent>();
+            crown->SetPosition(0, 0, 1.5f);
+            trunk->AddChild(crown);
+
+            drawable = ComponentManager::AddComponent<ShapeComponent>(crown);
+            drawable->MustGetComponent<ColorComponent>()->SetColor(GREEN);
+            drawable->ObjectShape = DrawShape::Sphere;
+            drawable->ObjectSize = Vector3{ 1, 1, 1 };
+
+            roots.push_back(trunk->EntityId);
+        }
+    }
+
+    WorldStreaming::SaveCells("forest", cellSize, roots);
+
+    std::vector<uint64_t> entities;
+    for (uint64_t root : roots)
+    {
+        for (TransformComponent* node : ComponentManager::GetComponent<TransformComponent>(root)->GetSubtree())
+            entities.push_back(node->EntityId);
     }
+
+    // it comes back cell by cell around the camera
+    WorldStreaming::DestroyEntities(entities);
+    WorldStreaming::Setup("forest");
+}
+
+void DrawGrid()
+{
+    // world grid
+    rlPushMatrix();
+    rlRotatef(90, 1, 0, 0);
+    DrawGrid(50, 2.5f);
+    rlPopMatrix();
 }
 
-void main()
+int main()
 {
     SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(1280, 900, "ECS Test");
 
     SetTargetFPS(144);
 
+    // everything the render system submits goes to GL
+    GLRenderBackend renderBackend;
+    RenderBackend::Set(&renderBackend);
+
+    JobSystem::Setup();
+    AsyncLoader::Setup();
+    RenderSystem::Setup();
+    AutoMoverSystem::Setup();
+    LookAtSystem::Setup();
+    SpatialIndexSystem::Setup();
+    StaticBatchSystem::Setup();
+    OcclusionCulling::Setup();
+    VisibilitySystem::Setup();
+
+    // a second view in the corner, drawn from the next camera in the list
+    RenderTexture2D insetView = LoadRenderTexture(320, 240);
+    bool showInset = true;
+
     CreateTestEntity();
     CreateCameras();
+    CreateStaticGrid();
+    CreateOccluderWall();
+    CreateTerrain();
+    CreateStreamedForest();
+
+    // lay the transform links out depth first now that the scene is built
+    TransformHierarchy::Compact();
+
+    FixedStepRunner::Setup(30);
+    FixedStepRunner::AddSystem([](float deltaTime) { FreeFlightController::Update(Cameras[0], deltaTime); });
+    FixedStepRunner::AddSystem(AutoMoverSystem::Update);
+    FixedStepRunner::AddSystem([](float) { LookAtSystem::Update(); });
 
     while (!WindowShouldClose())
     {
+        // upload whatever finished loading, a little each frame
+        AsyncLoader::Update();
+
         ComponentManager::Update();
 
-        FreeFlightController::Update(Cameras[0]);
+        // movement runs at the simulation rate, transforms come back blended between ticks for drawing
+        FixedStepRunner::Update(GetFrameTime());
+
+        SpatialIndexSystem::Update();
+        StaticBatchSystem::Update();
+
+        // the forest follows the camera being looked through
+        WorldStreaming::Update(Cameras[cameraIndex % Cameras.size()]->EntityId);
 
         if (IsKeyPressed(KEY_SPACE))
             cameraIndex += 1;
 
+        if (IsKeyPressed(KEY_I))
+            RenderSystem::SetInstancing(!RenderSystem::IsInstancing());
+
+        if (IsKeyPressed(KEY_P))
+            RenderSystem::SetPretransform(!RenderSystem::IsPretransforming());
+
+        if (IsKeyPressed(KEY_O))
+            OcclusionCulling::SetEnabled(!OcclusionCulling::IsEnabled());
+
+        if (IsKeyPressed(KEY_M))
+            showInset = !showInset;
+
+        if (IsKeyPressed(KEY_T))
+            FixedStepRunner::SetInterpolation(!FixedStepRunner::IsInterpolating());
+
         if (cameraIndex >= Cameras.size())
             cameraIndex = 0;
 
+        size_t insetIndex = (cameraIndex + 1) % Cameras.size();
+        float insetAspect = float(insetView.texture.width) / float(insetView.texture.height);
+
+        // every camera is classified in one pass, both views draw from its lists
+        VisibilitySystem::SetViewAspect(Cameras[cameraIndex]->EntityId, float(GetScreenWidth()) / float(GetScreenHeight()));
+        VisibilitySystem::SetViewAspect(Cameras[insetIndex]->EntityId, insetAspect);
+        VisibilitySystem::Update();
+
+        if (showInset)
+        {
+            BeginTextureMode(insetView);
+            ClearBackground(DARKGRAY);
+            RenderSystem::Begin(Cameras[insetIndex]->EntityId, insetAspect);
+            DrawGrid();
+            RenderSystem::Draw();
+            RenderSystem::End();
+            EndTextureMode();
+        }
+
         BeginDrawing();
         ClearBackground(BLACK);
 
@@ -261,6 +520,9 @@ void main()
 
         RenderSystem::End();
 
+        if (IsMouseButtonPressed(0))
+            PickEntity();
+
         DrawText(TextFormat("X%.2f Y%.2f Z%.2f", cameraIndex, Cameras[cameraIndex]->GetPosition().x, Cameras[cameraIndex]->GetPosition().y, Cameras[cameraIndex]->GetPosition().z),0,20,20,RED);
         DrawText("Space to change cameras", 0, 40, 20, RED);
         switch (cameraIndex)
@@ -277,9 +539,45 @@ void main()
             break;
         }
 
+        const RenderSystem::RenderStats& stats = RenderSystem::GetStats();
+        DrawText(TextFormat("Visible %d Culled %d Occluded %d (O %s)", int(stats.Visible), int(stats.Culled), int(stats.Occluded), OcclusionCulling::IsEnabled() ? "on" : "off"), 0, 100, 20, RED);
+        if (RenderSystem::IsInstancing())
+            DrawText(TextFormat("Instancing on (I) %d shapes in %d draws", int(stats.InstancedShapes), int(stats.InstancedDraws)), 0, 140, 20, RED);
+        else
+            DrawText(TextFormat("Instancing off (I) CPU batching %s (P) %d shapes in %d draws", RenderSystem::IsPretransforming() ? "on" : "off", int(stats.PretransformShapes), int(stats.PretransformDraws)), 0, 140, 20, RED);
+
+        if (pickedEntityId != uint64_t(-1))
+            DrawText(TextFormat("Picked entity %d", int(pickedEntityId)), 0, 120, 20, RED);
+
+        for (int level = 0; level < 3; level++)
+            DrawText(TextFormat("LOD%d %d drawables %d triangles", level, int(stats.DrawablesPerLOD[level]), int(stats.TrianglesPerLOD[level])), 0, 160 + level * 20, 20, RED);
+
+        DrawText(TextFormat("Simulation %d Hz, %d ticks this frame, interpolation %s (T) %d blended", int(FixedStepRunner::GetTickRate() + 0.5f), FixedStepRunner::GetStats().Ticks, FixedStepRunner::IsInterpolating() ? "on" : "off", int(FixedStepRunner::GetStats().Interpolated)), 0, 240, 20, RED);
+
+        const WorldStreaming::Stats& streaming = WorldStreaming::GetStats();
+        DrawText(TextFormat("Streaming %d/%d cells (%d pending, %d unloading) %d entities, %d changes this frame", int(streaming.LoadedCells), int(streaming.Cells), int(streaming.PendingCells), int(streaming.UnloadingCells), int(streaming.Entities), int(streaming.FrameRecords)), 0, 220, 20, RED);
+
+        if (showInset)
+        {
+            // render textures are upside down
+            Vector2 insetPos = { float(GetScreenWidth() - insetView.texture.width - 10), float(GetScreenHeight() - insetView.texture.height - 10) };
+            DrawTextureRec(insetView.texture, Rectangle{ 0, 0, float(insetView.texture.width), -float(insetView.texture.height) }, insetPos, WHITE);
+            DrawRectangleLines(int(insetPos.x), int(insetPos.y), insetView.texture.width, insetView.texture.height, RAYWHITE);
+            DrawText("M to toggle", int(insetPos.x) + 4, int(insetPos.y) + 4, 10, RAYWHITE);
+        }
+
         DrawFPS(0, 0);
         EndDrawing();
     }
 
+    UnloadRenderTexture(insetView);
+    FixedStepRunner::Shutdown();
+    WorldStreaming::Shutdown();
+    RenderSystem::Shutdown();
+    AsyncLoader::Shutdown();
+    ResourceManager::Shutdown();
+    JobSystem::Shutdown();
     CloseWindow();
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const char* fileName)
+{
+    Close();
+
+    FileHandle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        FileHandle = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(FileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (MappingHandle == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    Data = static_cast<uint8_t*>(MapViewOfFile(MappingHandle, FILE_MAP_COPY, 0, 0, 0));
+    if (Data == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    Size = size_t(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (Data != nullptr)
+        UnmapViewOfFile(Data);
+
+    if (MappingHandle != nullptr)
+        CloseHandle(MappingHandle);
+
+    if (FileHandle != nullptr)
+        CloseHandle(FileHandle);
+
+    Data = nullptr;
+    Size = 0;
+    MappingHandle = nullptr;
+    FileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const char* fileName)
+{
+    Close();
+
+    int file = open(fileName, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        close(file);
+        return false;
+    }
+
+    // the mapping keeps its own reference to the file
+    void* view = mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (view == MAP_FAILED)
+        return false;
+
+    Data = static_cast<uint8_t*>(view);
+    Size = size_t(info.st_size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (Data != nullptr)
+        munmap(Data, Size);
+
+    Data = nullptr;
+    Size = 0;
+}
+
+#endif
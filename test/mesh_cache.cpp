@@ -0,0 +1,263 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "mesh_cache.h"
+#include "mapped_file.h"
+
+#include "rlgl.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace MeshCache
+{
+    enum Streams
+    {
+        PositionStream = 0,
+        TexCoordStream,
+        TexCoord2Stream,
+        NormalStream,
+        TangentStream,
+        ColorStream,
+        IndexStream,
+        StreamCount
+    };
+
+    // streams start on this boundary so they can be used in place
+    constexpr uint64_t StreamAlignment = 16;
+
+    // fixed size fields only, the header is written and read as raw bytes
+    struct FileHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t ContentHash;
+        uint32_t VertexCount;
+        uint32_t TriangleCount;
+        uint64_t StreamOffsets[StreamCount];
+        uint64_t StreamSizes[StreamCount];
+    };
+
+    const char FileMagic[4] = { 'R', 'M', 'S', 'H' };
+
+    // the mappings behind mapped meshes, keyed by the mesh's position stream
+    std::mutex MappingLock;
+    std::unordered_map<const void*, std::unique_ptr<MappedFile>> Mappings;
+
+    uint64_t HashBytes(const void* data, size_t size, uint64_t hash)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    std::string GetCachePath(const char* sourceFileName)
+    {
+        return std::string(sourceFileName) + ".meshcache";
+    }
+
+    uint64_t GetStreamSize(int stream, uint64_t vertexCount, uint64_t triangleCount)
+    {
+        switch (stream)
+        {
+        case PositionStream:
+        case NormalStream:
+            return vertexCount * 3 * sizeof(float);
+
+        case TexCoordStream:
+        case TexCoord2Stream:
+            return vertexCount * 2 * sizeof(float);
+
+        case TangentStream:
+            return vertexCount * 4 * sizeof(float);
+
+        case ColorStream:
+            return vertexCount * 4 * sizeof(unsigned char);
+
+        default:
+            return triangleCount * 3 * sizeof(unsigned short);
+        }
+    }
+
+    void GetStreams(const Mesh& mesh, const void* data[StreamCount], uint64_t sizes[StreamCount])
+    {
+        data[PositionStream] = mesh.vertices;
+        data[TexCoordStream] = mesh.texcoords;
+        data[TexCoord2Stream] = mesh.texcoords2;
+        data[NormalStream] = mesh.normals;
+        data[TangentStream] = mesh.tangents;
+        data[ColorStream] = mesh.colors;
+        data[IndexStream] = mesh.indices;
+
+        for (int stream = 0; stream < StreamCount; stream++)
+            sizes[stream] = (data[stream] != nullptr) ? GetStreamSize(stream, uint64_t(mesh.vertexCount), uint64_t(mesh.triangleCount)) : 0;
+    }
+
+    bool Write(const char* fileName, const Mesh& mesh, uint64_t contentHash)
+    {
+        if (mesh.vertices == nullptr || mesh.vertexCount <= 0)
+            return false;
+
+        FileHeader header = { 0 };
+        memcpy(header.Magic, FileMagic, sizeof(FileMagic));
+        header.Version = Version;
+        header.ContentHash = contentHash;
+        header.VertexCount = uint32_t(mesh.vertexCount);
+        header.TriangleCount = uint32_t(mesh.triangleCount);
+
+        const void* data[StreamCount];
+        GetStreams(mesh, data, header.StreamSizes);
+
+        uint64_t offset = (sizeof(FileHeader) + StreamAlignment - 1) & ~(StreamAlignment - 1);
+        for (int stream = 0; stream < StreamCount; stream++)
+        {
+            if (header.StreamSizes[stream] == 0)
+                continue;
+
+            header.StreamOffsets[stream] = offset;
+            offset = (offset + header.StreamSizes[stream] + StreamAlignment - 1) & ~(StreamAlignment - 1);
+        }
+
+        // write to the side and swap it in, so a reader never maps a half written file
+        std::string tempName = std::string(fileName) + ".tmp";
+        FILE* file = fopen(tempName.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        static const uint8_t padding[StreamAlignment] = { 0 };
+        uint64_t position = sizeof(header);
+        for (int stream = 0; stream < StreamCount && written; stream++)
+        {
+            if (header.StreamSizes[stream] == 0)
+                continue;
+
+            written = fwrite(padding, 1, size_t(header.StreamOffsets[stream] - position), file) == size_t(header.StreamOffsets[stream] - position);
+            written = written && fwrite(data[stream], 1, size_t(header.StreamSizes[stream]), file) == size_t(header.StreamSizes[stream]);
+            position = header.StreamOffsets[stream] + header.StreamSizes[stream];
+        }
+
+        written = fclose(file) == 0 && written;
+
+        remove(fileName);
+        if (!written || rename(tempName.c_str(), fileName) != 0)
+        {
+            remove(tempName.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Map(const char* fileName, uint64_t contentHash, Mesh& mesh)
+    {
+        std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>();
+        if (!file->Open(fileName) || file->GetSize() < sizeof(FileHeader))
+            return false;
+
+        FileHeader header;
+        memcpy(&header, file->GetData(), sizeof(header));
+
+        if (memcmp(header.Magic, FileMagic, sizeof(FileMagic)) != 0 || header.Version != Version || header.ContentHash != contentHash)
+            return false;
+
+        // the sizes have to agree with the counts and every stream has to be inside the file
+        void* streams[StreamCount] = { nullptr };
+        for (int stream = 0; stream < StreamCount; stream++)
+        {
+            uint64_t size = header.StreamSizes[stream];
+            if (size == 0)
+                continue;
+
+            uint64_t offset = header.StreamOffsets[stream];
+            if (size != GetStreamSize(stream, header.VertexCount, header.TriangleCount) || offset % StreamAlignment != 0 || offset > file->GetSize() || size > file->GetSize() - offset)
+                return false;
+
+            streams[stream] = file->GetData() + offset;
+        }
+
+        if (streams[PositionStream] == nullptr || header.VertexCount == 0)
+            return false;
+
+        mesh = Mesh{ 0 };
+        mesh.vertexCount = int(header.VertexCount);
+        mesh.triangleCount = int(header.TriangleCount);
+        mesh.vertices = static_cast<float*>(streams[PositionStream]);
+        mesh.texcoords = static_cast<float*>(streams[TexCoordStream]);
+        mesh.texcoords2 = static_cast<float*>(streams[TexCoord2Stream]);
+        mesh.normals = static_cast<float*>(streams[NormalStream]);
+        mesh.tangents = static_cast<float*>(streams[TangentStream]);
+        mesh.colors = static_cast<unsigned char*>(streams[ColorStream]);
+        mesh.indices = static_cast<unsigned short*>(streams[IndexStream]);
+
+        std::lock_guard<std::mutex> lock(MappingLock);
+        Mappings[mesh.vertices] = std::move(file);
+
+        return true;
+    }
+
+    bool IsMapped(const Mesh& mesh)
+    {
+        std::lock_guard<std::mutex> lock(MappingLock);
+        return mesh.vertices != nullptr && Mappings.find(mesh.vertices) != Mappings.end();
+    }
+
+    void Unmap(Mesh& mesh)
+    {
+        {
+            std::lock_guard<std::mutex> lock(MappingLock);
+            Mappings.erase(mesh.vertices);
+        }
+
+        RL_FREE(mesh.vboId);
+        mesh = Mesh{ 0 };
+    }
+
+    void UnloadMappedMesh(Mesh mesh)
+    {
+        rlUnloadVertexArray(mesh.vaoId);
+
+        // UploadMesh allocates seven vertex buffer slots
+        if (mesh.vboId != nullptr)
+        {
+            for (int i = 0; i < 7; i++)
+                rlUnloadVertexBuffer(mesh.vboId[i]);
+        }
+
+        Unmap(mesh);
+    }
+}
@@ -0,0 +1,61 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// a binary mesh format that is mapped straight into memory, the streams are stored exactly as UploadMesh reads them
+// so a mapped mesh points into the file and nothing is parsed or copied on load
+namespace MeshCache
+{
+    constexpr uint32_t Version = 1;
+
+    // FNV-1a, used to tag a cache file with the content it was built from
+    uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
+    // where the cache for a source file lives
+    std::string GetCachePath(const char* sourceFileName);
+
+    bool Write(const char* fileName, const Mesh& mesh, uint64_t contentHash);
+
+    // fails when the file is missing, damaged, from another version or built from different content
+    bool Map(const char* fileName, uint64_t contentHash, Mesh& mesh);
+
+    bool IsMapped(const Mesh& mesh);
+
+    // drops the mapping behind a mapped mesh's arrays, the mesh must not have been uploaded
+    void Unmap(Mesh& mesh);
+
+    // the UnloadMesh for mapped meshes, frees the GPU buffers and then the mapping
+    void UnloadMappedMesh(Mesh mesh);
+}
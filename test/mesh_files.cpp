@@ -0,0 +1,287 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "mesh_files.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+
+#include "raymath.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace MeshFiles
+{
+    // IsFileExtension lower cases through a shared buffer, so it is not safe off the main thread
+    bool HasExtension(const char* fileName, const char* extension)
+    {
+        const char* dot = strrchr(fileName, '.');
+        if (dot == nullptr || strlen(dot) != strlen(extension))
+            return false;
+
+        for (size_t i = 0; dot[i] != '\0'; i++)
+        {
+            if (tolower(dot[i]) != tolower(extension[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool LoadMeshData(const char* fileName, Mesh& mesh, bool useCache)
+    {
+        if (!HasExtension(fileName, ".obj"))
+            return false;
+
+        unsigned int size = 0;
+        unsigned char* data = LoadFileData(fileName, &size);
+        if (data == nullptr)
+            return false;
+
+        // hashing the source is far cheaper than parsing it, and catches edits the file date would miss
+        // the optimizer version is part of the hash so a changed optimizer rebuilds old caches
+        uint64_t contentHash = MeshCache::HashBytes(data, size);
+        contentHash = MeshCache::HashBytes(&MeshOptimizer::Version, sizeof(MeshOptimizer::Version), contentHash);
+        std::string cachePath = MeshCache::GetCachePath(fileName);
+
+        if (useCache && MeshCache::Map(cachePath.c_str(), contentHash, mesh))
+        {
+            UnloadFileData(data);
+            return true;
+        }
+
+        bool loaded = ParseObj(reinterpret_cast<const char*>(data), size, mesh);
+        UnloadFileData(data);
+
+        // obj files come in as triangle soup, weld and reorder them once here instead of drawing them as loaded
+        if (loaded)
+            MeshOptimizer::Optimize(mesh);
+
+        if (loaded && useCache)
+            MeshCache::Write(cachePath.c_str(), mesh, contentHash);
+
+        return loaded;
+    }
+
+    struct ObjVertex
+    {
+        int Position = 0;
+        int TexCoord = 0;
+        int Normal = 0;
+    };
+
+    // obj indices are one based, negative ones count back from the end
+    int ResolveIndex(long index, size_t count)
+    {
+        if (index > 0)
+            return int(index - 1);
+
+        if (index < 0)
+            return int(long(count) + index);
+
+        return -1;
+    }
+
+    bool ParseObj(const char* text, size_t size, Mesh& mesh)
+    {
+        // the file data is not null terminated
+        std::string buffer(text, size);
+
+        std::vector<Vector3> positions;
+        std::vector<Vector2> texCoords;
+        std::vector<Vector3> normals;
+
+        std::vector<float> outPositions;
+        std::vector<float> outTexCoords;
+        std::vector<float> outNormals;
+
+        std::vector<ObjVertex> face;
+
+        const char* cursor = buffer.c_str();
+        while (*cursor != '\0')
+        {
+            const char* lineEnd = strchr(cursor, '\n');
+            if (lineEnd == nullptr)
+                lineEnd = cursor + strlen(cursor);
+
+            while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t'))
+                cursor++;
+
+            char* next = nullptr;
+            if (cursor[0] == 'v' && cursor[1] == ' ')
+            {
+                Vector3 position;
+                position.x = strtof(cursor + 2, &next);
+                position.y = strtof(next, &next);
+                position.z = strtof(next, &next);
+                positions.push_back(position);
+            }
+            else if (cursor[0] == 'v' && cursor[1] == 't' && cursor[2] == ' ')
+            {
+                Vector2 texCoord;
+                texCoord.x = strtof(cursor + 3, &next);
+                texCoord.y = strtof(next, &next);
+                texCoords.push_back(texCoord);
+            }
+            else if (cursor[0] == 'v' && cursor[1] == 'n' && cursor[2] == ' ')
+            {
+                Vector3 normal;
+                normal.x = strtof(cursor + 3, &next);
+                normal.y = strtof(next, &next);
+                normal.z = strtof(next, &next);
+                normals.push_back(normal);
+            }
+            else if (cursor[0] == 'f' && cursor[1] == ' ')
+            {
+                face.clear();
+
+                const char* token = cursor + 2;
+                while (token < lineEnd)
+                {
+                    while (token < lineEnd && isspace((unsigned char)*token))
+                        token++;
+                    if (token >= lineEnd)
+                        break;
+
+                    // v, v/vt, v//vn or v/vt/vn
+                    ObjVertex vertex;
+                    vertex.Position = ResolveIndex(strtol(token, &next, 10), positions.size());
+                    token = next;
+                    if (*token == '/')
+                    {
+                        token++;
+                        if (*token != '/')
+                        {
+                            vertex.TexCoord = ResolveIndex(strtol(token, &next, 10), texCoords.size());
+                            token = next;
+                        }
+                        else
+                        {
+                            vertex.TexCoord = -1;
+                        }
+
+                        if (*token == '/')
+                        {
+                            token++;
+                            vertex.Normal = ResolveIndex(strtol(token, &next, 10), normals.size());
+                            token = next;
+                        }
+                        else
+                        {
+                            vertex.Normal = -1;
+                        }
+                    }
+                    else
+                    {
+                        vertex.TexCoord = -1;
+                        vertex.Normal = -1;
+                    }
+
+                    // skip whatever is left of a malformed token
+                    while (token < lineEnd && !isspace((unsigned char)*token))
+                        token++;
+
+                    if (vertex.Position < 0 || vertex.Position >= int(positions.size()))
+                        return false;
+
+                    face.push_back(vertex);
+                }
+
+                for (size_t i = 2; i < face.size(); i++)
+                {
+                    const ObjVertex* triangle[3] = { &face[0], &face[i - 1], &face[i] };
+
+                    Vector3 corners[3];
+                    for (int c = 0; c < 3; c++)
+                        corners[c] = positions[triangle[c]->Position];
+
+                    // faces without normals get a flat one
+                    Vector3 faceNormal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(corners[1], corners[0]), Vector3Subtract(corners[2], corners[0])));
+
+                    for (int c = 0; c < 3; c++)
+                    {
+                        const ObjVertex& vertex = *triangle[c];
+                        outPositions.insert(outPositions.end(), { corners[c].x, corners[c].y, corners[c].z });
+
+                        Vector2 texCoord = (vertex.TexCoord >= 0 && vertex.TexCoord < int(texCoords.size())) ? texCoords[vertex.TexCoord] : Vector2{ 0, 0 };
+                        outTexCoords.insert(outTexCoords.end(), { texCoord.x, 1.0f - texCoord.y });
+
+                        Vector3 normal = (vertex.Normal >= 0 && vertex.Normal < int(normals.size())) ? normals[vertex.Normal] : faceNormal;
+                        outNormals.insert(outNormals.end(), { normal.x, normal.y, normal.z });
+                    }
+                }
+            }
+
+            cursor = (*lineEnd == '\0') ? lineEnd : lineEnd + 1;
+        }
+
+        if (outPositions.empty())
+            return false;
+
+        mesh = Mesh{ 0 };
+        mesh.vertexCount = int(outPositions.size() / 3);
+        mesh.triangleCount = mesh.vertexCount / 3;
+
+        mesh.vertices = (float*)RL_MALLOC(outPositions.size() * sizeof(float));
+        mesh.texcoords = (float*)RL_MALLOC(outTexCoords.size() * sizeof(float));
+        mesh.normals = (float*)RL_MALLOC(outNormals.size() * sizeof(float));
+
+        memcpy(mesh.vertices, outPositions.data(), outPositions.size() * sizeof(float));
+        memcpy(mesh.texcoords, outTexCoords.data(), outTexCoords.size() * sizeof(float));
+        memcpy(mesh.normals, outNormals.data(), outNormals.size() * sizeof(float));
+
+        return true;
+    }
+
+    void UnloadMeshData(Mesh& mesh)
+    {
+        if (MeshCache::IsMapped(mesh))
+        {
+            MeshCache::Unmap(mesh);
+            return;
+        }
+
+        RL_FREE(mesh.vertices);
+        RL_FREE(mesh.texcoords);
+        RL_FREE(mesh.texcoords2);
+        RL_FREE(mesh.normals);
+        RL_FREE(mesh.tangents);
+        RL_FREE(mesh.colors);
+        RL_FREE(mesh.indices);
+        RL_FREE(mesh.animVertices);
+        RL_FREE(mesh.animNormals);
+        RL_FREE(mesh.boneIds);
+        RL_FREE(mesh.boneWeights);
+        RL_FREE(mesh.vboId);
+
+        mesh = Mesh{ 0 };
+    }
+}
@@ -0,0 +1,49 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stddef.h>
+
+// CPU side mesh loading, nothing here touches the GPU so it is safe to run on worker threads
+namespace MeshFiles
+{
+    // reads and parses a mesh file, the mesh still has to be uploaded with UploadMesh
+    // parsed meshes go through MeshOptimizer before they are cached, so they come back indexed when they fit 16 bits
+    // with the cache on, a matching MeshCache file is mapped instead of parsing and a missing one is written
+    bool LoadMeshData(const char* fileName, Mesh& mesh, bool useCache = true);
+
+    // wavefront obj, faces are fan triangulated and every group is merged into one mesh
+    bool ParseObj(const char* text, size_t size, Mesh& mesh);
+
+    // frees the arrays of a mesh that was never uploaded, UnloadMesh expects GPU buffers
+    // mapped meshes just drop their mapping
+    void UnloadMeshData(Mesh& mesh);
+}
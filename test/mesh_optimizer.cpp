@@ -0,0 +1,582 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "mesh_optimizer.h"
+#include "mesh_cache.h"
+
+#include "raymath.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace MeshOptimizer
+{
+    constexpr int MaxIndexedVertices = 65535;
+
+    int GetCorner(const Mesh& mesh, int corner)
+    {
+        return (mesh.indices != nullptr) ? int(mesh.indices[corner]) : corner;
+    }
+
+    Stats Analyze(const Mesh& mesh, int cacheSize)
+    {
+        Stats stats;
+        stats.VertexCount = mesh.vertexCount;
+        stats.TriangleCount = mesh.triangleCount;
+
+        if (mesh.vertexCount <= 0 || mesh.triangleCount <= 0)
+            return stats;
+
+        // a vertex is in the FIFO while fewer than cacheSize misses have happened since it went in
+        std::vector<int> cachedAt(mesh.vertexCount, -1);
+        int misses = 0;
+
+        for (int corner = 0; corner < mesh.triangleCount * 3; corner++)
+        {
+            int vertex = GetCorner(mesh, corner);
+            if (cachedAt[vertex] >= 0 && misses - cachedAt[vertex] < cacheSize)
+                continue;
+
+            cachedAt[vertex] = misses;
+            misses++;
+        }
+
+        stats.ACMR = float(misses) / float(mesh.triangleCount);
+        stats.ATVR = float(misses) / float(mesh.vertexCount);
+        return stats;
+    }
+
+    // replaces a vertex stream with one holding sourceOf[i] at slot i
+    template<typename T>
+    void RemapStream(T*& stream, int components, const std::vector<int>& sourceOf)
+    {
+        if (stream == nullptr)
+            return;
+
+        T* remapped = static_cast<T*>(RL_MALLOC(sizeof(T) * components * sourceOf.size()));
+        for (size_t i = 0; i < sourceOf.size(); i++)
+            memcpy(remapped + i * components, stream + size_t(sourceOf[i]) * components, sizeof(T) * components);
+
+        RL_FREE(stream);
+        stream = remapped;
+    }
+
+    void RemapVertices(Mesh& mesh, const std::vector<int>& sourceOf)
+    {
+        RemapStream(mesh.vertices, 3, sourceOf);
+        RemapStream(mesh.texcoords, 2, sourceOf);
+        RemapStream(mesh.texcoords2, 2, sourceOf);
+        RemapStream(mesh.normals, 3, sourceOf);
+        RemapStream(mesh.tangents, 4, sourceOf);
+        RemapStream(mesh.colors, 4, sourceOf);
+
+        mesh.vertexCount = int(sourceOf.size());
+    }
+
+    // packs every attribute of a vertex side by side so whole vertices can be hashed and compared
+    size_t PackVertices(const Mesh& mesh, std::vector<uint8_t>& packed)
+    {
+        struct PackStream
+        {
+            const void* Data;
+            size_t Size;
+        };
+
+        const PackStream streams[] =
+        {
+            { mesh.vertices, sizeof(float) * 3 },
+            { mesh.texcoords, sizeof(float) * 2 },
+            { mesh.texcoords2, sizeof(float) * 2 },
+            { mesh.normals, sizeof(float) * 3 },
+            { mesh.tangents, sizeof(float) * 4 },
+            { mesh.colors, sizeof(unsigned char) * 4 },
+        };
+
+        size_t vertexSize = 0;
+        for (const PackStream& stream : streams)
+        {
+            if (stream.Data != nullptr)
+                vertexSize += stream.Size;
+        }
+
+        packed.resize(vertexSize * mesh.vertexCount);
+
+        size_t offset = 0;
+        for (const PackStream& stream : streams)
+        {
+            if (stream.Data == nullptr)
+                continue;
+
+            const uint8_t* source = static_cast<const uint8_t*>(stream.Data);
+            for (int v = 0; v < mesh.vertexCount; v++)
+                memcpy(packed.data() + v * vertexSize + offset, source + v * stream.Size, stream.Size);
+
+            offset += stream.Size;
+        }
+
+        return vertexSize;
+    }
+
+    // welds a triangle soup, false if the unique vertices do not fit 16 bit indices
+    bool GenerateIndices(Mesh& mesh)
+    {
+        std::vector<uint8_t> packed;
+        size_t vertexSize = PackVertices(mesh, packed);
+
+        size_t tableSize = 1;
+        while (tableSize < size_t(mesh.vertexCount) * 2)
+            tableSize *= 2;
+
+        // open addressing on the first vertex seen with each value
+        std::vector<int> table(tableSize, -1);
+        std::vector<int> sourceOf;
+        std::vector<unsigned short> indices(size_t(mesh.vertexCount));
+
+        for (int v = 0; v < mesh.vertexCount; v++)
+        {
+            const uint8_t* vertex = packed.data() + v * vertexSize;
+            size_t slot = size_t(MeshCache::HashBytes(vertex, vertexSize)) & (tableSize - 1);
+
+            while (table[slot] >= 0 && memcmp(packed.data() + sourceOf[table[slot]] * vertexSize, vertex, vertexSize) != 0)
+                slot = (slot + 1) & (tableSize - 1);
+
+            if (table[slot] < 0)
+            {
+                if (int(sourceOf.size()) >= MaxIndexedVertices)
+                    return false;
+
+                table[slot] = int(sourceOf.size());
+                sourceOf.push_back(v);
+            }
+
+            indices[v] = (unsigned short)table[slot];
+        }
+
+        RemapVertices(mesh, sourceOf);
+
+        mesh.indices = static_cast<unsigned short*>(RL_MALLOC(sizeof(unsigned short) * indices.size()));
+        memcpy(mesh.indices, indices.data(), sizeof(unsigned short) * indices.size());
+        return true;
+    }
+
+    // Sander, Nehab and Barczak 2007, fans around the vertex that is most likely to still be in the cache
+    // clusterStarts gets the first triangle of every run that started at a dead end
+    void Tipsify(const unsigned short* indices, int triangleCount, int vertexCount, int cacheSize, std::vector<unsigned short>& output, std::vector<int>& clusterStarts)
+    {
+        std::vector<int> live(vertexCount, 0);
+        for (int corner = 0; corner < triangleCount * 3; corner++)
+            live[indices[corner]]++;
+
+        std::vector<int> adjacencyOffsets(vertexCount + 1, 0);
+        for (int v = 0; v < vertexCount; v++)
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + live[v];
+
+        std::vector<int> adjacency(triangleCount * 3);
+        std::vector<int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (int triangle = 0; triangle < triangleCount; triangle++)
+        {
+            for (int corner = 0; corner < 3; corner++)
+                adjacency[fill[indices[triangle * 3 + corner]]++] = triangle;
+        }
+
+        std::vector<int> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<int> deadEnd;
+        std::vector<int> candidates;
+
+        output.clear();
+        output.reserve(triangleCount * 3);
+        clusterStarts.clear();
+
+        int time = cacheSize + 1;
+        int cursor = 0;
+        int fanning = 0;
+        bool newCluster = true;
+
+        while (fanning >= 0)
+        {
+            if (newCluster)
+            {
+                clusterStarts.push_back(int(output.size() / 3));
+                newCluster = false;
+            }
+
+            candidates.clear();
+            for (int a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+            {
+                int triangle = adjacency[a];
+                if (emitted[triangle])
+                    continue;
+
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    int v = indices[triangle * 3 + corner];
+                    output.push_back((unsigned short)v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+
+                    if (time - cacheTime[v] > cacheSize)
+                        cacheTime[v] = time++;
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // prefer the candidate that has been in the cache longest and will still be there after its fan
+            int best = -1;
+            int bestPriority = -1;
+            for (int v : candidates)
+            {
+                if (live[v] <= 0)
+                    continue;
+
+                int priority = 0;
+                if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                    priority = time - cacheTime[v];
+
+                if (priority > bestPriority)
+                {
+                    best = v;
+                    bestPriority = priority;
+                }
+            }
+
+            if (best < 0)
+            {
+                // dead end, back track through recently used vertices then scan for anything left
+                newCluster = true;
+
+                while (!deadEnd.empty() && best < 0)
+                {
+                    int v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (live[v] > 0)
+                        best = v;
+                }
+
+                while (best < 0 && cursor < vertexCount)
+                {
+                    if (live[cursor] > 0)
+                        best = cursor;
+                    else
+                        cursor++;
+                }
+            }
+
+            fanning = best;
+        }
+    }
+
+    // sorts the tipsify clusters so the ones facing out from the middle of the mesh draw first, they are the most likely occluders
+    void OptimizeOverdraw(const Mesh& mesh, std::vector<unsigned short>& indices, const std::vector<int>& clusterStarts)
+    {
+        int clusterCount = int(clusterStarts.size());
+        if (clusterCount < 2)
+            return;
+
+        struct Cluster
+        {
+            int Start;
+            int End;
+            float Sort;
+        };
+
+        std::vector<Cluster> clusters(clusterCount);
+        std::vector<Vector3> centroids(clusterCount);
+        std::vector<Vector3> normals(clusterCount);
+
+        Vector3 meshCentroid = { 0, 0, 0 };
+        float meshArea = 0;
+
+        for (int c = 0; c < clusterCount; c++)
+        {
+            clusters[c].Start = clusterStarts[c];
+            clusters[c].End = (c + 1 < clusterCount) ? clusterStarts[c + 1] : mesh.triangleCount;
+
+            Vector3 centroid = { 0, 0, 0 };
+            Vector3 normal = { 0, 0, 0 };
+            float area = 0;
+
+            for (int triangle = clusters[c].Start; triangle < clusters[c].End; triangle++)
+            {
+                const float* p0 = mesh.vertices + indices[triangle * 3 + 0] * 3;
+                const float* p1 = mesh.vertices + indices[triangle * 3 + 1] * 3;
+                const float* p2 = mesh.vertices + indices[triangle * 3 + 2] * 3;
+
+                Vector3 a = { p0[0], p0[1], p0[2] };
+                Vector3 b = { p1[0], p1[1], p1[2] };
+                Vector3 d = { p2[0], p2[1], p2[2] };
+
+                // the cross product is twice the area along the face normal
+                Vector3 cross = Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(d, a));
+                float triangleArea = Vector3Length(cross);
+
+                Vector3 center = Vector3Scale(Vector3Add(Vector3Add(a, b), d), 1.0f / 3.0f);
+                centroid = Vector3Add(centroid, Vector3Scale(center, triangleArea));
+                normal = Vector3Add(normal, cross);
+                area += triangleArea;
+            }
+
+            meshCentroid = Vector3Add(meshCentroid, centroid);
+            meshArea += area;
+
+            centroids[c] = (area > 0) ? Vector3Scale(centroid, 1.0f / area) : centroid;
+            normals[c] = normal;
+        }
+
+        if (meshArea > 0)
+            meshCentroid = Vector3Scale(meshCentroid, 1.0f / meshArea);
+
+        for (int c = 0; c < clusterCount; c++)
+        {
+            float length = Vector3Length(normals[c]);
+            clusters[c].Sort = (length > 0) ? Vector3DotProduct(Vector3Subtract(centroids[c], meshCentroid), normals[c]) / length : 0;
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.Sort > b.Sort; });
+
+        std::vector<unsigned short> sorted;
+        sorted.reserve(indices.size());
+        for (const Cluster& cluster : clusters)
+            sorted.insert(sorted.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+
+        indices.swap(sorted);
+    }
+
+    // numbers vertices in the order the index buffer first touches them, unused ones are dropped
+    void OptimizeVertexFetch(Mesh& mesh)
+    {
+        std::vector<int> remap(mesh.vertexCount, -1);
+        std::vector<int> sourceOf;
+        sourceOf.reserve(mesh.vertexCount);
+
+        for (int corner = 0; corner < mesh.triangleCount * 3; corner++)
+        {
+            int vertex = mesh.indices[corner];
+            if (remap[vertex] < 0)
+            {
+                remap[vertex] = int(sourceOf.size());
+                sourceOf.push_back(vertex);
+            }
+
+            mesh.indices[corner] = (unsigned short)remap[vertex];
+        }
+
+        RemapVertices(mesh, sourceOf);
+    }
+
+    bool Optimize(Mesh& mesh, const Options& options, Report* report)
+    {
+        Report result;
+        result.Before = Analyze(mesh, options.CacheSize);
+        result.After = result.Before;
+        result.Indexed = mesh.indices != nullptr;
+
+        // only plain CPU side meshes, uploaded, mapped and skinned data is left as is
+        bool owned = mesh.vertices != nullptr && mesh.vaoId == 0 && mesh.animVertices == nullptr && !MeshCache::IsMapped(mesh);
+        if (!owned || mesh.triangleCount <= 0)
+        {
+            if (report != nullptr)
+                *report = result;
+            return false;
+        }
+
+        if (mesh.indices == nullptr && options.GenerateIndices)
+            result.Indexed = GenerateIndices(mesh);
+
+        if (result.Indexed)
+        {
+            if (options.VertexCache)
+            {
+                std::vector<unsigned short> reordered;
+                std::vector<int> clusterStarts;
+                Tipsify(mesh.indices, mesh.triangleCount, mesh.vertexCount, options.CacheSize, reordered, clusterStarts);
+
+                if (options.Overdraw)
+                    OptimizeOverdraw(mesh, reordered, clusterStarts);
+
+                memcpy(mesh.indices, reordered.data(), sizeof(unsigned short) * reordered.size());
+            }
+
+            if (options.VertexFetch)
+                OptimizeVertexFetch(mesh);
+        }
+
+        result.After = Analyze(mesh, options.CacheSize);
+
+        if (report != nullptr)
+            *report = result;
+
+        return result.Indexed;
+    }
+
+    size_t QuantizedMesh::GetBytes() const
+    {
+        return sizeof(Offset) + sizeof(Scale) + Positions.size() * sizeof(uint16_t) + Normals.size() * sizeof(int8_t) + Indices.size() * sizeof(unsigned short);
+    }
+
+    float SignNotZero(float value)
+    {
+        return (value >= 0) ? 1.0f : -1.0f;
+    }
+
+    // project onto the octahedron and fold the lower half over the upper one
+    Vector2 EncodeOctahedral(Vector3 normal)
+    {
+        float sum = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+        if (sum <= 0)
+            return Vector2{ 0, 0 };
+
+        Vector2 encoded = { normal.x / sum, normal.y / sum };
+        if (normal.z < 0)
+            encoded = Vector2{ (1.0f - fabsf(encoded.y)) * SignNotZero(encoded.x), (1.0f - fabsf(encoded.x)) * SignNotZero(encoded.y) };
+
+        return encoded;
+    }
+
+    Vector3 DecodeOctahedral(Vector2 encoded)
+    {
+        Vector3 normal = { encoded.x, encoded.y, 1.0f - fabsf(encoded.x) - fabsf(encoded.y) };
+        if (normal.z < 0)
+        {
+            normal.x = (1.0f - fabsf(encoded.y)) * SignNotZero(encoded.x);
+            normal.y = (1.0f - fabsf(encoded.x)) * SignNotZero(encoded.y);
+        }
+
+        return Vector3Normalize(normal);
+    }
+
+    int8_t ToSnorm8(float value)
+    {
+        return int8_t(roundf(Clamp(value, -1.0f, 1.0f) * 127.0f));
+    }
+
+    float FromSnorm8(int8_t value)
+    {
+        return fmaxf(float(value) / 127.0f, -1.0f);
+    }
+
+    void Quantize(const Mesh& mesh, QuantizedMesh& quantized, QuantizeError* error)
+    {
+        quantized = QuantizedMesh();
+        quantized.VertexCount = mesh.vertexCount;
+        quantized.TriangleCount = mesh.triangleCount;
+
+        if (mesh.vertices == nullptr || mesh.vertexCount <= 0)
+            return;
+
+        Vector3 min = { mesh.vertices[0], mesh.vertices[1], mesh.vertices[2] };
+        Vector3 max = min;
+        for (int v = 1; v < mesh.vertexCount; v++)
+        {
+            Vector3 position = { mesh.vertices[v * 3 + 0], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2] };
+            min = Vector3Min(min, position);
+            max = Vector3Max(max, position);
+        }
+
+        // the full 16 bits span the bounds on each axis
+        Vector3 extents = Vector3Subtract(max, min);
+        quantized.Offset = min;
+        quantized.Scale = Vector3{ fmaxf(extents.x, 1e-6f), fmaxf(extents.y, 1e-6f), fmaxf(extents.z, 1e-6f) };
+
+        QuantizeError result;
+
+        quantized.Positions.resize(size_t(mesh.vertexCount) * 3);
+        for (int v = 0; v < mesh.vertexCount; v++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float offset = (&quantized.Offset.x)[axis];
+                float scale = (&quantized.Scale.x)[axis];
+                float value = mesh.vertices[v * 3 + axis];
+
+                uint16_t packed = uint16_t(roundf(Clamp((value - offset) / scale, 0.0f, 1.0f) * 65535.0f));
+                quantized.Positions[v * 3 + axis] = packed;
+
+                float restored = offset + (float(packed) / 65535.0f) * scale;
+                result.MaxPositionError = fmaxf(result.MaxPositionError, fabsf(restored - value));
+            }
+        }
+
+        if (mesh.normals != nullptr)
+        {
+            quantized.Normals.resize(size_t(mesh.vertexCount) * 2);
+            for (int v = 0; v < mesh.vertexCount; v++)
+            {
+                Vector3 normal = Vector3Normalize(Vector3{ mesh.normals[v * 3 + 0], mesh.normals[v * 3 + 1], mesh.normals[v * 3 + 2] });
+                Vector2 encoded = EncodeOctahedral(normal);
+
+                quantized.Normals[v * 2 + 0] = ToSnorm8(encoded.x);
+                quantized.Normals[v * 2 + 1] = ToSnorm8(encoded.y);
+
+                Vector3 restored = DecodeOctahedral(Vector2{ FromSnorm8(quantized.Normals[v * 2 + 0]), FromSnorm8(quantized.Normals[v * 2 + 1]) });
+                float angle = acosf(Clamp(Vector3DotProduct(normal, restored), -1.0f, 1.0f)) * RAD2DEG;
+                result.MaxNormalErrorDegrees = fmaxf(result.MaxNormalErrorDegrees, angle);
+            }
+        }
+
+        if (mesh.indices != nullptr)
+            quantized.Indices.assign(mesh.indices, mesh.indices + size_t(mesh.triangleCount) * 3);
+
+        if (error != nullptr)
+            *error = result;
+    }
+
+    void Dequantize(const QuantizedMesh& quantized, Mesh& mesh)
+    {
+        mesh.vertexCount = quantized.VertexCount;
+        mesh.triangleCount = quantized.TriangleCount;
+
+        mesh.vertices = static_cast<float*>(RL_MALLOC(sizeof(float) * 3 * quantized.VertexCount));
+        for (int v = 0; v < quantized.VertexCount; v++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+                mesh.vertices[v * 3 + axis] = (&quantized.Offset.x)[axis] + (float(quantized.Positions[v * 3 + axis]) / 65535.0f) * (&quantized.Scale.x)[axis];
+        }
+
+        if (!quantized.Normals.empty())
+        {
+            mesh.normals = static_cast<float*>(RL_MALLOC(sizeof(float) * 3 * quantized.VertexCount));
+            for (int v = 0; v < quantized.VertexCount; v++)
+            {
+                Vector3 normal = DecodeOctahedral(Vector2{ FromSnorm8(quantized.Normals[v * 2 + 0]), FromSnorm8(quantized.Normals[v * 2 + 1]) });
+                mesh.normals[v * 3 + 0] = normal.x;
+                mesh.normals[v * 3 + 1] = normal.y;
+                mesh.normals[v * 3 + 2] = normal.z;
+            }
+        }
+
+        if (!quantized.Indices.empty())
+        {
+            mesh.indices = static_cast<unsigned short*>(RL_MALLOC(sizeof(unsigned short) * quantized.Indices.size()));
+            memcpy(mesh.indices, quantized.Indices.data(), sizeof(unsigned short) * quantized.Indices.size());
+        }
+    }
+}
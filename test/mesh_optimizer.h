@@ -0,0 +1,116 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// import time mesh optimization, all CPU side and meant to run before a mesh is uploaded or cached
+namespace MeshOptimizer
+{
+    // bump when the output changes, it is folded into the mesh cache hash
+    constexpr uint32_t Version = 1;
+
+    constexpr int DefaultCacheSize = 16;
+
+    struct Options
+    {
+        // weld identical vertices of a triangle soup into an index buffer
+        bool GenerateIndices = true;
+
+        // reorder triangles for the post transform vertex cache (tipsify)
+        bool VertexCache = true;
+
+        // reorder the cache friendly clusters so outward facing ones draw first
+        bool Overdraw = true;
+
+        // renumber vertices in the order they are first used
+        bool VertexFetch = true;
+
+        int CacheSize = DefaultCacheSize;
+    };
+
+    struct Stats
+    {
+        // average cache misses per triangle, 3 is no reuse and 0.5 is about the best a regular grid can do
+        float ACMR = 0;
+
+        // average cache misses per vertex, 1 is every vertex transformed once
+        float ATVR = 0;
+
+        int VertexCount = 0;
+        int TriangleCount = 0;
+    };
+
+    struct Report
+    {
+        Stats Before;
+        Stats After;
+
+        // false when the welded mesh would not fit 16 bit indices, nothing past welding is done then
+        bool Indexed = false;
+    };
+
+    // simulates a FIFO post transform cache of the given size
+    Stats Analyze(const Mesh& mesh, int cacheSize = DefaultCacheSize);
+
+    // the mesh must own its arrays (not uploaded, not mapped), they are replaced as needed
+    bool Optimize(Mesh& mesh, const Options& options = Options(), Report* report = nullptr);
+
+    // a compact copy of the vertex data, 16 bit positions inside the mesh bounds and octahedral normals
+    // raylib uploads float streams, so this is a storage format that is expanded again before upload
+    struct QuantizedMesh
+    {
+        Vector3 Offset = { 0, 0, 0 };
+        Vector3 Scale = { 1, 1, 1 };
+
+        std::vector<uint16_t> Positions;
+        std::vector<int8_t> Normals;
+        std::vector<unsigned short> Indices;
+
+        int VertexCount = 0;
+        int TriangleCount = 0;
+
+        size_t GetBytes() const;
+    };
+
+    struct QuantizeError
+    {
+        float MaxPositionError = 0;
+        float MaxNormalErrorDegrees = 0;
+    };
+
+    void Quantize(const Mesh& mesh, QuantizedMesh& quantized, QuantizeError* error = nullptr);
+
+    // expands back into a mesh with freshly allocated position, normal and index arrays
+    void Dequantize(const QuantizedMesh& quantized, Mesh& mesh);
+}
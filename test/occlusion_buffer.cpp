@@ -0,0 +1,234 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "occlusion_buffer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <xmmintrin.h>
+
+// points with a smaller clip w than this are treated as crossing the eye
+constexpr float MinClipW = 0.001f;
+
+void OcclusionBuffer::Setup(int width, int height)
+{
+    Width = std::max(4, (width + 3) & ~3);
+    Height = std::max(1, height);
+    Depth.assign(size_t(Width) * Height, 0.0f);
+}
+
+void OcclusionBuffer::Begin(const Matrix& viewProjection)
+{
+    if (Depth.empty())
+        Setup();
+
+    ViewProjection = viewProjection;
+    std::fill(Depth.begin(), Depth.end(), 0.0f);
+    Triangles = 0;
+}
+
+bool OcclusionBuffer::Project(const Vector3& point, ScreenVertex& vertex) const
+{
+    const Matrix& m = ViewProjection;
+    float x = m.m0 * point.x + m.m4 * point.y + m.m8 * point.z + m.m12;
+    float y = m.m1 * point.x + m.m5 * point.y + m.m9 * point.z + m.m13;
+    float w = m.m3 * point.x + m.m7 * point.y + m.m11 * point.z + m.m15;
+
+    if (w < MinClipW)
+        return false;
+
+    vertex.InvW = 1.0f / w;
+    vertex.X = (x * vertex.InvW * 0.5f + 0.5f) * Width;
+    vertex.Y = (0.5f - y * vertex.InvW * 0.5f) * Height;
+    return true;
+}
+
+void OcclusionBuffer::RasterizeBox(const Vector3 corners[8])
+{
+    // corner i has max x when bit 0 is set, max y for bit 1, max z for bit 2
+    static const int faces[6][4] =
+    {
+        { 0, 2, 6, 4 }, { 1, 5, 7, 3 },
+        { 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+        { 0, 1, 3, 2 }, { 4, 6, 7, 5 },
+    };
+
+    for (const int* face : faces)
+    {
+        RasterizeTriangle(corners[face[0]], corners[face[1]], corners[face[2]]);
+        RasterizeTriangle(corners[face[0]], corners[face[2]], corners[face[3]]);
+    }
+}
+
+void OcclusionBuffer::RasterizeTriangle(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+    ScreenVertex v0, v1, v2;
+    if (!Project(a, v0) || !Project(b, v1) || !Project(c, v2))
+        return;
+
+    float area = (v1.X - v0.X) * (v2.Y - v0.Y) - (v1.Y - v0.Y) * (v2.X - v0.X);
+    if (fabsf(area) < 1e-6f)
+        return;
+
+    // both windings are drawn, the nearer surface wins, so flip to one orientation
+    if (area < 0)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    int minX = std::max(0, int(floorf(std::min(std::min(v0.X, v1.X), v2.X))));
+    int maxX = std::min(Width - 1, int(ceilf(std::max(std::max(v0.X, v1.X), v2.X))));
+    int minY = std::max(0, int(floorf(std::min(std::min(v0.Y, v1.Y), v2.Y))));
+    int maxY = std::min(Height - 1, int(ceilf(std::max(std::max(v0.Y, v1.Y), v2.Y))));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    Triangles++;
+
+    // edge functions as A * x + B * y + C, positive inside
+    float edgeA[3], edgeB[3], edgeC[3];
+    const ScreenVertex* verts[3] = { &v0, &v1, &v2 };
+    for (int i = 0; i < 3; i++)
+    {
+        const ScreenVertex& from = *verts[(i + 1) % 3];
+        const ScreenVertex& to = *verts[(i + 2) % 3];
+        edgeA[i] = from.Y - to.Y;
+        edgeB[i] = to.X - from.X;
+        edgeC[i] = -(edgeA[i] * from.X + edgeB[i] * from.Y);
+    }
+
+    // 1/w is a plane in screen space, weighted by the barycentrics from the edge functions
+    float inverseArea = 1.0f / area;
+    float depthA = (edgeA[0] * v0.InvW + edgeA[1] * v1.InvW + edgeA[2] * v2.InvW) * inverseArea;
+    float depthB = (edgeB[0] * v0.InvW + edgeB[1] * v1.InvW + edgeB[2] * v2.InvW) * inverseArea;
+    float depthC = (edgeC[0] * v0.InvW + edgeC[1] * v1.InvW + edgeC[2] * v2.InvW) * inverseArea;
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 columnOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+    __m128 stepA0 = _mm_set1_ps(edgeA[0]), stepA1 = _mm_set1_ps(edgeA[1]), stepA2 = _mm_set1_ps(edgeA[2]);
+    __m128 stepDepth = _mm_set1_ps(depthA);
+
+    int startX = minX & ~3;
+
+    for (int y = minY; y <= maxY; y++)
+    {
+        float centerY = y + 0.5f;
+        float* row = Depth.data() + size_t(y) * Width;
+
+        __m128 columnX = _mm_add_ps(_mm_set1_ps(float(startX)), columnOffsets);
+
+        __m128 e0 = _mm_add_ps(_mm_mul_ps(stepA0, columnX), _mm_set1_ps(edgeB[0] * centerY + edgeC[0]));
+        __m128 e1 = _mm_add_ps(_mm_mul_ps(stepA1, columnX), _mm_set1_ps(edgeB[1] * centerY + edgeC[1]));
+        __m128 e2 = _mm_add_ps(_mm_mul_ps(stepA2, columnX), _mm_set1_ps(edgeB[2] * centerY + edgeC[2]));
+        __m128 depth = _mm_add_ps(_mm_mul_ps(stepDepth, columnX), _mm_set1_ps(depthB * centerY + depthC));
+
+        // advancing 4 pixels adds 4 steps
+        __m128 step4 = _mm_set1_ps(4.0f);
+        __m128 e0Step = _mm_mul_ps(stepA0, step4);
+        __m128 e1Step = _mm_mul_ps(stepA1, step4);
+        __m128 e2Step = _mm_mul_ps(stepA2, step4);
+        __m128 depthStep = _mm_mul_ps(stepDepth, step4);
+
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+
+            if (_mm_movemask_ps(inside) != 0)
+            {
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_max_ps(current, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+            }
+
+            e0 = _mm_add_ps(e0, e0Step);
+            e1 = _mm_add_ps(e1, e1Step);
+            e2 = _mm_add_ps(e2, e2Step);
+            depth = _mm_add_ps(depth, depthStep);
+        }
+    }
+}
+
+bool OcclusionBuffer::IsVisible(const BoundingBox& box) const
+{
+    if (Depth.empty())
+        return true;
+
+    float minX = float(Width), maxX = -1, minY = float(Height), maxY = -1;
+    float nearest = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        Vector3 corner = { (i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z };
+
+        // anything reaching the eye can't be proven hidden
+        ScreenVertex vertex;
+        if (!Project(corner, vertex))
+            return true;
+
+        minX = std::min(minX, vertex.X);
+        maxX = std::max(maxX, vertex.X);
+        minY = std::min(minY, vertex.Y);
+        maxY = std::max(maxY, vertex.Y);
+        nearest = std::max(nearest, vertex.InvW);
+    }
+
+    // every pixel the box touches, even partly
+    int x0 = std::max(0, int(floorf(minX)));
+    int x1 = std::min(Width - 1, int(floorf(maxX)));
+    int y0 = std::max(0, int(floorf(minY)));
+    int y1 = std::min(Height - 1, int(floorf(maxY)));
+    if (x0 > x1 || y0 > y1)
+        return true;
+
+    __m128 boxDepth = _mm_set1_ps(nearest);
+    __m128 first = _mm_set1_ps(float(x0) - 0.5f);
+    __m128 last = _mm_set1_ps(float(x1) + 0.5f);
+    __m128 columnOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+    int startX = x0 & ~3;
+
+    for (int y = y0; y <= y1; y++)
+    {
+        const float* row = Depth.data() + size_t(y) * Width;
+
+        for (int x = startX; x <= x1; x += 4)
+        {
+            __m128 columns = _mm_add_ps(_mm_set1_ps(float(x)), columnOffsets);
+            __m128 inRange = _mm_and_ps(_mm_cmpgt_ps(columns, first), _mm_cmplt_ps(columns, last));
+
+            // a pixel with no occluder in front of the box's nearest point means it can be seen
+            __m128 open = _mm_cmple_ps(_mm_loadu_ps(row + x), boxDepth);
+            if (_mm_movemask_ps(_mm_and_ps(open, inRange)) != 0)
+                return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,82 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <vector>
+
+// a low resolution CPU depth buffer that occluder boxes are rasterized into and candidate bounds are tested against
+// depth is stored as 1/w so it interpolates linearly across the screen, bigger is nearer and 0 is empty
+class OcclusionBuffer
+{
+public:
+    static constexpr int DefaultWidth = 256;
+    static constexpr int DefaultHeight = 128;
+
+    // width is rounded up to a multiple of 4 so rows can be processed 4 pixels at a time
+    void Setup(int width = DefaultWidth, int height = DefaultHeight);
+
+    // clears the depth and sets the matrix that takes world space to clip space
+    void Begin(const Matrix& viewProjection);
+
+    // rasterize the 12 triangles of a box given by its 8 world space corners, corner i is at max x when bit 0 is set, max y for bit 1 and max z for bit 2
+    void RasterizeBox(const Vector3 corners[8]);
+
+    // rasterize one world space triangle, triangles crossing the near plane are skipped, which only ever loses occlusion
+    void RasterizeTriangle(const Vector3& a, const Vector3& b, const Vector3& c);
+
+    // false only when every pixel the box covers has an occluder nearer than the nearest point of the box
+    bool IsVisible(const BoundingBox& box) const;
+
+    inline int GetWidth() const { return Width; }
+    inline int GetHeight() const { return Height; }
+    inline const float* GetDepth() const { return Depth.data(); }
+
+    inline size_t GetTriangleCount() const { return Triangles; }
+
+private:
+    struct ScreenVertex
+    {
+        float X;
+        float Y;
+        float InvW;
+    };
+
+    int Width = 0;
+    int Height = 0;
+    std::vector<float> Depth;
+
+    Matrix ViewProjection = { 0 };
+    size_t Triangles = 0;
+
+    // false when the point is behind or too close to the eye to project
+    bool Project(const Vector3& point, ScreenVertex& vertex) const;
+};
@@ -0,0 +1,138 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "occlusion_culling.h"
+#include "occluder_component.h"
+
+#include "drawable_component.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace OcclusionCulling
+{
+    OcclusionBuffer Buffer;
+    bool Enabled = true;
+
+    std::vector<Drawable3DComponent*> Occluders;
+    size_t DrawnOccluders = 0;
+
+    void AddOccluder(Drawable3DComponent* drawable)
+    {
+        if (std::find(Occluders.begin(), Occluders.end(), drawable) != Occluders.end())
+            return;
+
+        Occluders.push_back(drawable);
+        drawable->Occluder = true;
+    }
+
+    void RemoveOccluder(Drawable3DComponent* drawable)
+    {
+        auto itr = std::find(Occluders.begin(), Occluders.end(), drawable);
+        if (itr == Occluders.end())
+            return;
+
+        *itr = Occluders.back();
+        Occluders.pop_back();
+        drawable->Occluder = false;
+    }
+
+    void OnOccluderAdded(Component* component)
+    {
+        for (Component* drawable : ComponentManager::FindComponents(Drawable3DComponent::GetComponentId(), component->EntityId))
+            AddOccluder(static_cast<Drawable3DComponent*>(drawable));
+    }
+
+    void OnOccluderRemoved(Component* component)
+    {
+        for (Component* drawable : ComponentManager::FindComponents(Drawable3DComponent::GetComponentId(), component->EntityId))
+            RemoveOccluder(static_cast<Drawable3DComponent*>(drawable));
+    }
+
+    void OnDrawableAdded(Component* component)
+    {
+        if (ComponentManager::FindComponent(OccluderComponent::GetComponentId(), component->EntityId) != nullptr)
+            AddOccluder(static_cast<Drawable3DComponent*>(component));
+    }
+
+    void OnDrawableRemoved(Component* component)
+    {
+        RemoveOccluder(static_cast<Drawable3DComponent*>(component));
+    }
+
+    void Setup()
+    {
+        Buffer.Setup();
+        Occluders.clear();
+
+        ComponentManager::DoForEachEntity<OccluderComponent>([](OccluderComponent* component) { OnOccluderAdded(component); });
+
+        ComponentManager::AddAddObserver<OccluderComponent>(OnOccluderAdded);
+        ComponentManager::AddRemoveObserver<OccluderComponent>(OnOccluderRemoved);
+        ComponentManager::AddAddObserver<Drawable3DComponent>(OnDrawableAdded);
+        ComponentManager::AddRemoveObserver<Drawable3DComponent>(OnDrawableRemoved);
+    }
+
+    void SetEnabled(bool enabled)
+    {
+        Enabled = enabled;
+    }
+
+    bool IsEnabled()
+    {
+        return Enabled;
+    }
+
+    void Rasterize(const Matrix& viewProjection, const Frustum& frustum)
+    {
+        Buffer.Begin(viewProjection);
+        DrawnOccluders = 0;
+
+        for (Drawable3DComponent* drawable : Occluders)
+        {
+            if (!drawable->Active || !FrustumContainsBox(frustum, drawable->GetWorldBounds()))
+                continue;
+
+            Vector3 corners[8];
+            drawable->GetWorldCorners(corners);
+            Buffer.RasterizeBox(corners);
+
+            DrawnOccluders++;
+        }
+    }
+
+    size_t GetOccluderCount()
+    {
+        return DrawnOccluders;
+    }
+
+    const OcclusionBuffer& GetBuffer()
+    {
+        return Buffer;
+    }
+}
@@ -0,0 +1,83 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "primitive_mesh_cache.h"
+#include "primitive_meshes.h"
+#include "resource_manager.h"
+
+#include <map>
+
+namespace PrimitiveMeshCache
+{
+    std::map<uint64_t, Mesh> Meshes;
+
+    ResourceManager::MaterialHandle SharedMaterial;
+
+    const Mesh& Get(DrawShape shape, uint16_t sizeClass, int tessellation)
+    {
+        // boxes and planes don't tessellate, keep them to one entry
+        if (shape == DrawShape::Box || shape == DrawShape::Plane)
+            tessellation = 1;
+
+        uint64_t key = (uint64_t(shape) << 48) | (uint64_t(sizeClass) << 32) | uint32_t(tessellation);
+
+        auto itr = Meshes.find(key);
+        if (itr != Meshes.end())
+            return itr->second;
+
+        return Meshes[key] = PrimitiveMeshes::GenUnitShapeMesh(shape, sizeClass, tessellation);
+    }
+
+    Material& GetMaterial()
+    {
+        // acquired again when the resource manager was shut down under the cache
+        Material* material = ResourceManager::Get(SharedMaterial);
+        if (material == nullptr)
+        {
+            SharedMaterial = ResourceManager::AcquireDefaultMaterial();
+            material = ResourceManager::Get(SharedMaterial);
+        }
+
+        return *material;
+    }
+
+    size_t GetMeshCount()
+    {
+        return Meshes.size();
+    }
+
+    void Clear()
+    {
+        for (auto& entry : Meshes)
+            UnloadMesh(entry.second);
+
+        Meshes.clear();
+
+        ResourceManager::Release(SharedMaterial);
+    }
+}
@@ -0,0 +1,52 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "draw_shape.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// unit meshes for the built in shapes, generated once per (shape, size class, tessellation) and shared by everything that draws them
+namespace PrimitiveMeshCache
+{
+    // generates the mesh on first use, the reference stays valid until Clear
+    const Mesh& Get(DrawShape shape, uint16_t sizeClass, int tessellation);
+
+    // the resource manager's default material, also used by meshes without one of their own
+    // tint a copy of its maps, the reference is only good until the next material is acquired
+    Material& GetMaterial();
+
+    size_t GetMeshCount();
+
+    // unloads every mesh and releases the material, call before closing the window
+    void Clear();
+}
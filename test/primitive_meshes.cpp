@@ -0,0 +1,203 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "primitive_meshes.h"
+#include "shape_batch_builder.h"
+
+#include "raymath.h"
+
+#include <math.h>
+
+namespace PrimitiveMeshes
+{
+    struct MeshWriter
+    {
+        Mesh& Target;
+        int Vertex = 0;
+
+        MeshWriter(Mesh& mesh) : Target(mesh) {}
+
+        void Add(const Vector3& position, const Vector3& normal, float u, float v)
+        {
+            Target.vertices[Vertex * 3 + 0] = position.x;
+            Target.vertices[Vertex * 3 + 1] = position.y;
+            Target.vertices[Vertex * 3 + 2] = position.z;
+
+            Target.normals[Vertex * 3 + 0] = normal.x;
+            Target.normals[Vertex * 3 + 1] = normal.y;
+            Target.normals[Vertex * 3 + 2] = normal.z;
+
+            Target.texcoords[Vertex * 2 + 0] = u;
+            Target.texcoords[Vertex * 2 + 1] = v;
+
+            Vertex++;
+        }
+    };
+
+    Mesh GenMeshTaperedCylinder(float bottomRadius, float topRadius, float height, int slices)
+    {
+        Mesh mesh = { 0 };
+
+        bool bottomCap = bottomRadius > 0;
+        bool topCap = topRadius > 0;
+
+        mesh.triangleCount = slices * (2 + (bottomCap ? 1 : 0) + (topCap ? 1 : 0));
+        mesh.vertexCount = mesh.triangleCount * 3;
+        mesh.vertices = (float*)RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+        mesh.normals = (float*)RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+        mesh.texcoords = (float*)RL_MALLOC(mesh.vertexCount * 2 * sizeof(float));
+
+        MeshWriter writer(mesh);
+
+        // the side normal leans toward the narrow end
+        float slope = (bottomRadius - topRadius) / (height != 0 ? height : 1);
+
+        for (int i = 0; i < slices; i++)
+        {
+            float u0 = float(i) / slices;
+            float u1 = float(i + 1) / slices;
+
+            float a0 = u0 * 2 * PI;
+            float a1 = u1 * 2 * PI;
+
+            Vector3 ring0 = { cosf(a0), 0, sinf(a0) };
+            Vector3 ring1 = { cosf(a1), 0, sinf(a1) };
+
+            Vector3 bottom0 = Vector3Scale(ring0, bottomRadius);
+            Vector3 bottom1 = Vector3Scale(ring1, bottomRadius);
+            Vector3 top0 = Vector3Add(Vector3Scale(ring0, topRadius), Vector3{ 0, height, 0 });
+            Vector3 top1 = Vector3Add(Vector3Scale(ring1, topRadius), Vector3{ 0, height, 0 });
+
+            Vector3 normal0 = Vector3Normalize(Vector3{ ring0.x, slope, ring0.z });
+            Vector3 normal1 = Vector3Normalize(Vector3{ ring1.x, slope, ring1.z });
+
+            writer.Add(bottom0, normal0, u0, 0);
+            writer.Add(top0, normal0, u0, 1);
+            writer.Add(bottom1, normal1, u1, 0);
+
+            writer.Add(bottom1, normal1, u1, 0);
+            writer.Add(top0, normal0, u0, 1);
+            writer.Add(top1, normal1, u1, 1);
+
+            if (bottomCap)
+            {
+                Vector3 down = { 0, -1, 0 };
+                writer.Add(Vector3Zero(), down, 0.5f, 0.5f);
+                writer.Add(bottom0, down, 0.5f + ring0.x * 0.5f, 0.5f + ring0.z * 0.5f);
+                writer.Add(bottom1, down, 0.5f + ring1.x * 0.5f, 0.5f + ring1.z * 0.5f);
+            }
+
+            if (topCap)
+            {
+                Vector3 up = { 0, 1, 0 };
+                writer.Add(Vector3{ 0, height, 0 }, up, 0.5f, 0.5f);
+                writer.Add(top1, up, 0.5f + ring1.x * 0.5f, 0.5f + ring1.z * 0.5f);
+                writer.Add(top0, up, 0.5f + ring0.x * 0.5f, 0.5f + ring0.z * 0.5f);
+            }
+        }
+
+        UploadMesh(&mesh, false);
+        return mesh;
+    }
+
+    int GetDefaultTessellation(DrawShape shape)
+    {
+        switch (shape)
+        {
+        case DrawShape::Sphere:
+            return 16;
+        case DrawShape::Cylinder:
+            return 32;
+        default:
+            return 1;
+        }
+    }
+
+    int GetLODCount(DrawShape shape)
+    {
+        return (shape == DrawShape::Sphere || shape == DrawShape::Cylinder) ? 3 : 1;
+    }
+
+    int GetLODTessellation(DrawShape shape, int level)
+    {
+        // each level roughly halves the segment count
+        static const int sphereSegments[] = { 16, 10, 6 };
+        static const int cylinderSegments[] = { 32, 16, 8 };
+
+        if (level < 0)
+            level = 0;
+        if (level >= GetLODCount(shape))
+            level = GetLODCount(shape) - 1;
+
+        switch (shape)
+        {
+        case DrawShape::Sphere:
+            return sphereSegments[level];
+        case DrawShape::Cylinder:
+            return cylinderSegments[level];
+        default:
+            return GetDefaultTessellation(shape);
+        }
+    }
+
+    float GetLODScreenSize(int level)
+    {
+        static const float screenSizes[] = { 128, 32 };
+
+        if (level < 0 || level >= int(sizeof(screenSizes) / sizeof(screenSizes[0])))
+            return 0;
+
+        return screenSizes[level];
+    }
+
+    Mesh GenUnitShapeMesh(DrawShape shape, uint16_t sizeClass, int tessellation)
+    {
+        if (tessellation < 3)
+            tessellation = 3;
+
+        switch (shape)
+        {
+        case DrawShape::Sphere:
+            return GenMeshSphere(1, tessellation, tessellation);
+
+        case DrawShape::Cylinder:
+        {
+            float top = 0, bottom = 0;
+            ShapeBatch::GetCylinderRadii(sizeClass, top, bottom);
+            return GenMeshTaperedCylinder(bottom, top, 1, tessellation);
+        }
+
+        case DrawShape::Plane:
+            return GenMeshPlane(1, 1, 1, 1);
+
+        case DrawShape::Box:
+        default:
+            return GenMeshCube(1, 1, 1);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "draw_shape.h"
+
+#include "raylib.h"
+
+#include <stdint.h>
+
+// generators for the unit meshes the built in shapes are drawn from
+namespace PrimitiveMeshes
+{
+    // a cylinder up the Y axis from the origin with different top and bottom radii, uploaded to the GPU
+    Mesh GenMeshTaperedCylinder(float bottomRadius, float topRadius, float height, int slices);
+
+    // the tessellation the immediate mode raylib functions use for a shape, rings and slices for spheres, slices for cylinders
+    int GetDefaultTessellation(DrawShape shape);
+
+    // spheres and cylinders get coarser tessellations as they shrink on screen, boxes and planes have a single level
+    int GetLODCount(DrawShape shape);
+    int GetLODTessellation(DrawShape shape, int level);
+
+    // the smallest projected size in pixels a level is used at
+    float GetLODScreenSize(int level);
+
+    // the unit mesh for a shape and size class (see ShapeBatch::GetSizeClass), uploaded to the GPU
+    Mesh GenUnitShapeMesh(DrawShape shape, uint16_t sizeClass, int tessellation);
+}
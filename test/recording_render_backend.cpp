@@ -0,0 +1,194 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "recording_render_backend.h"
+#include "primitive_mesh_cache.h"
+#include "primitive_meshes.h"
+#include "shader_uniform_cache.h"
+
+void RecordingRenderBackend::SetViewport(int width, int height)
+{
+    ViewportWidth = width;
+    ViewportHeight = height;
+}
+
+void RecordingRenderBackend::SetInstancing(bool supported)
+{
+    Instancing = supported;
+}
+
+void RecordingRenderBackend::SetLogging(bool enabled)
+{
+    Logging = enabled;
+}
+
+void RecordingRenderBackend::Clear()
+{
+    Commands.clear();
+    Frames.clear();
+    Current = FrameStats();
+}
+
+const RecordingRenderBackend::FrameStats& RecordingRenderBackend::GetLastFrame() const
+{
+    return Frames.empty() ? Empty : Frames.back();
+}
+
+size_t RecordingRenderBackend::CountCommands(CommandType type) const
+{
+    const FrameStats& frame = GetLastFrame();
+    if (frame.FirstCommand + frame.Commands > Commands.size())
+        return 0;
+
+    size_t count = 0;
+    for (size_t i = frame.FirstCommand; i < frame.FirstCommand + frame.Commands; i++)
+    {
+        if (Commands[i].Type == type)
+            count++;
+    }
+    return count;
+}
+
+int RecordingRenderBackend::GetViewportWidth()
+{
+    return ViewportWidth;
+}
+
+int RecordingRenderBackend::GetViewportHeight()
+{
+    return ViewportHeight;
+}
+
+bool RecordingRenderBackend::SupportsInstancing()
+{
+    return Instancing;
+}
+
+void RecordingRenderBackend::Record(CommandType type, uint8_t flags, uint16_t variant, uint32_t resource, uint32_t count)
+{
+    Current.Commands++;
+
+    if (!Logging)
+        return;
+
+    Command command;
+    command.Type = type;
+    command.Flags = flags;
+    command.Variant = variant;
+    command.Resource = resource;
+    command.Count = count;
+    Commands.push_back(command);
+}
+
+void RecordingRenderBackend::BeginView(const Camera3D&)
+{
+    Record(CommandType::BeginView, 0, 0, 0, 0);
+    ViewStart = std::chrono::high_resolution_clock::now();
+}
+
+void RecordingRenderBackend::EndView()
+{
+    Current.SubmitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - ViewStart).count();
+    Record(CommandType::EndView, 0, 0, 0, 0);
+
+    // without the log the range can't be looked up, so it is left empty
+    if (!Logging)
+        Current.Commands = 0;
+
+    Frames.push_back(Current);
+
+    Current = FrameStats();
+    Current.FirstCommand = Commands.size();
+}
+
+void RecordingRenderBackend::SetBackfaceCulling(bool enabled)
+{
+    Record(CommandType::SetBackfaceCulling, enabled ? 1 : 0, 0, 0, 0);
+    Current.StateChanges++;
+}
+
+void RecordingRenderBackend::PushMatrix(const Matrix&)
+{
+    Record(CommandType::PushMatrix, 0, 0, 0, 0);
+    Current.MatrixPushes++;
+}
+
+void RecordingRenderBackend::PopMatrix()
+{
+    Record(CommandType::PopMatrix, 0, 0, 0, 0);
+}
+
+void RecordingRenderBackend::DrawMesh(const Mesh& mesh, const Material&, const Matrix&)
+{
+    Record(CommandType::DrawMesh, 0, 0, mesh.vaoId, uint32_t(mesh.triangleCount));
+
+    Current.DrawCalls++;
+    Current.Triangles += size_t(mesh.triangleCount);
+}
+
+void RecordingRenderBackend::DrawShapeGroup(const ShapeBatchBuilder&, const ShapeBatchBuilder::Group& group)
+{
+    if (group.Count == 0)
+        return;
+
+    // the same unit mesh the instanced path would draw
+    const Mesh& mesh = PrimitiveMeshCache::Get(group.Shape, group.SizeClass, PrimitiveMeshes::GetLODTessellation(group.Shape, group.LOD));
+    Record(CommandType::DrawShapeGroup, group.LOD, uint16_t(group.Shape), mesh.vaoId, uint32_t(group.Count));
+
+    Current.DrawCalls++;
+    Current.InstancedDraws++;
+    Current.Instances += group.Count;
+    Current.Triangles += size_t(mesh.triangleCount) * group.Count;
+}
+
+void RecordingRenderBackend::UpdateMeshBuffer(const Mesh& mesh, int index, const void*, int size)
+{
+    Record(CommandType::UpdateMeshBuffer, uint8_t(index), 0, mesh.vaoId, uint32_t(size));
+
+    Current.BufferUpdates++;
+    Current.UploadBytes += size_t(size);
+}
+
+void RecordingRenderBackend::UpdateTexture(const Texture2D& texture, int width, int height, const void*)
+{
+    uint32_t bytes = uint32_t(GetPixelDataSize(width, height, texture.format));
+    Record(CommandType::UpdateTexture, 0, 0, texture.id, bytes);
+
+    Current.BufferUpdates++;
+    Current.UploadBytes += bytes;
+}
+
+void RecordingRenderBackend::SetUniform(const Shader& shader, int location, const void*, int uniformType, int count)
+{
+    uint32_t bytes = uint32_t(ShaderUniformCache::GetUniformSize(uniformType) * count);
+    Record(CommandType::SetUniform, uint8_t(uniformType), uint16_t(location), shader.id, bytes);
+
+    Current.UniformUploads++;
+    Current.UploadBytes += bytes;
+}
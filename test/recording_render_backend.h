@@ -0,0 +1,151 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+#include "render_backend.h"
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// draws nothing, every call is appended to a compact log and counted per frame
+// for capturing what a scene submits and timing submission without a window or GL context
+class RecordingRenderBackend : public RenderBackend
+{
+public:
+    enum class CommandType : uint8_t
+    {
+        BeginView,
+        EndView,
+        SetBackfaceCulling,
+        PushMatrix,
+        PopMatrix,
+        DrawMesh,
+        DrawShapeGroup,
+        UpdateMeshBuffer,
+        UpdateTexture,
+        SetUniform,
+    };
+
+    // 12 bytes per call, the data behind the call is not kept
+    struct Command
+    {
+        CommandType Type = CommandType::BeginView;
+
+        // the culling state, a shape group's LOD, the vertex buffer slot of a buffer update or the uniform type
+        uint8_t Flags = 0;
+
+        // the shape of a shape group, or the uniform location
+        uint16_t Variant = 0;
+
+        // vao, texture or shader id
+        uint32_t Resource = 0;
+
+        // triangles for a mesh, instances for a shape group, bytes for uploads
+        uint32_t Count = 0;
+    };
+
+    // a frame ends at EndView, calls made between views count towards the next one
+    struct FrameStats
+    {
+        size_t FirstCommand = 0;
+        size_t Commands = 0;
+
+        size_t DrawCalls = 0;
+        size_t InstancedDraws = 0;
+        size_t Instances = 0;
+        size_t Triangles = 0;
+
+        size_t MatrixPushes = 0;
+        size_t StateChanges = 0;
+        size_t UniformUploads = 0;
+        size_t BufferUpdates = 0;
+        size_t UploadBytes = 0;
+
+        // wall time from BeginView to EndView, everything the render system did in between
+        double SubmitMs = 0;
+    };
+
+    void SetViewport(int width, int height);
+    void SetInstancing(bool supported);
+
+    // when off only the frame counts are kept, for long runs
+    void SetLogging(bool enabled);
+
+    // drops the log and every frame
+    void Clear();
+
+    inline const std::vector<Command>& GetCommands() const { return Commands; }
+    inline const std::vector<FrameStats>& GetFrames() const { return Frames; }
+
+    // the last frame that reached EndView, empty before the first
+    const FrameStats& GetLastFrame() const;
+
+    // how many commands of a type the last finished frame recorded
+    size_t CountCommands(CommandType type) const;
+
+    int GetViewportWidth() override;
+    int GetViewportHeight() override;
+
+    bool SupportsInstancing() override;
+
+    void BeginView(const Camera3D& camera) override;
+    void EndView() override;
+
+    void SetBackfaceCulling(bool enabled) override;
+
+    void PushMatrix(const Matrix& transform) override;
+    void PopMatrix() override;
+
+    void DrawMesh(const Mesh& mesh, const Material& material, const Matrix& transform) override;
+    void DrawShapeGroup(const ShapeBatchBuilder& builder, const ShapeBatchBuilder::Group& group) override;
+
+    void UpdateMeshBuffer(const Mesh& mesh, int index, const void* data, int size) override;
+    void UpdateTexture(const Texture2D& texture, int width, int height, const void* data) override;
+
+    void SetUniform(const Shader& shader, int location, const void* value, int uniformType, int count) override;
+
+private:
+    int ViewportWidth = 1280;
+    int ViewportHeight = 900;
+    bool Instancing = true;
+    bool Logging = true;
+
+    std::vector<Command> Commands;
+    std::vector<FrameStats> Frames;
+
+    FrameStats Current;
+    FrameStats Empty;
+
+    std::chrono::high_resolution_clock::time_point ViewStart;
+
+    void Record(CommandType type, uint8_t flags, uint16_t variant, uint32_t resource, uint32_t count);
+};
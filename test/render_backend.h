@@ -0,0 +1,76 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+#include "shape_batch_builder.h"
+
+#include "raylib.h"
+
+// the calls draw submission ends in, everything the render system, drawables and batch paths send to the GPU goes through here
+// GLRenderBackend hands them to raylib and rlgl, RecordingRenderBackend only logs them
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    // the backend draws go to until Set is called again, set one before RenderSystem::Setup
+    static RenderBackend& Get();
+    static void Set(RenderBackend* backend);
+
+    virtual void Setup() {}
+    virtual void Shutdown() {}
+
+    // the size of what is being drawn to, for aspect and screen space LOD
+    virtual int GetViewportWidth() = 0;
+    virtual int GetViewportHeight() = 0;
+
+    virtual bool SupportsInstancing() = 0;
+
+    virtual void BeginView(const Camera3D& camera) = 0;
+    virtual void EndView() = 0;
+
+    // anything batched under the old state is flushed first
+    virtual void SetBackfaceCulling(bool enabled) = 0;
+
+    // multiplies onto the current model matrix until the matching pop
+    virtual void PushMatrix(const Matrix& transform) = 0;
+    virtual void PopMatrix() = 0;
+
+    virtual void DrawMesh(const Mesh& mesh, const Material& material, const Matrix& transform) = 0;
+
+    // one instanced draw for a group from the builder
+    virtual void DrawShapeGroup(const ShapeBatchBuilder& builder, const ShapeBatchBuilder::Group& group) = 0;
+
+    // the index is raylib's vertex buffer slot
+    virtual void UpdateMeshBuffer(const Mesh& mesh, int index, const void* data, int size) = 0;
+    virtual void UpdateTexture(const Texture2D& texture, int width, int height, const void* data) = 0;
+
+    virtual void SetUniform(const Shader& shader, int location, const void* value, int uniformType, int count) = 0;
+};
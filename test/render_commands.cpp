@@ -0,0 +1,132 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "render_commands.h"
+#include "job_system.h"
+#include "transform_hierarchy.h"
+
+#include "drawable_component.h"
+#include "transform_component.h"
+
+namespace RenderCommands
+{
+    std::vector<TransformComponent*> Roots;
+
+    void UpdateTransforms()
+    {
+        Roots.clear();
+        for (const TransformHierarchy::Node& node : TransformHierarchy::Nodes)
+        {
+            if (node.Transform != nullptr && node.Parent == TransformHierarchy::InvalidNode)
+                Roots.push_back(node.Transform);
+        }
+
+        // subtrees don't share any transforms, so each can be updated on its own thread, parents before children
+        JobSystem::ParallelFor(Roots.size(), TransformGrain, [](size_t begin, size_t end, size_t)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    for (TransformComponent* transform : Roots[i]->GetSubtree())
+                        transform->GetWorldMatrix();
+                }
+            });
+    }
+
+    void Extract(const RenderView& view, Drawable3DComponent* const* drawables, size_t count, RenderCommandList& list)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Drawable3DComponent* drawable = drawables[i];
+
+            // baked drawables are drawn with their batch
+            if (!drawable->Active || drawable->StaticBatched)
+                continue;
+
+            const BoundingBox& bounds = drawable->GetWorldBounds();
+            if (!view.FrustumCulled && !FrustumContainsBox(view.ViewFrustum, bounds))
+            {
+                list.Culled++;
+                continue;
+            }
+
+            // occluders would hide themselves
+            if (view.Occlusion != nullptr && !drawable->Occluder && !view.Occlusion->IsVisible(bounds))
+            {
+                list.Occluded++;
+                continue;
+            }
+
+            // the level feeds into the geometry id, so pick it before the key is made
+            int level = drawable->UpdateLOD(view.Camera, view.ViewportHeight);
+            list.DrawablesPerLOD[level]++;
+
+            Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+            uint32_t depth = DrawKey::QuantizeDepth(Vector3Distance(center, view.Camera.position), view.FarPlane);
+
+            list.Items.push_back(DrawItem{ DrawKey::Make(drawable->GetPipeline(), drawable->GetGeometryId(), drawable->GetMaterialId(), depth), drawable });
+        }
+    }
+
+    void Build(const RenderView& view, const std::vector<Drawable3DComponent*>& drawables, std::vector<RenderCommandList>& lists)
+    {
+        lists.resize(JobSystem::GetThreadCount());
+        for (RenderCommandList& list : lists)
+            list.Clear();
+
+        JobSystem::ParallelFor(drawables.size(), ExtractGrain, [&view, &drawables, &lists](size_t begin, size_t end, size_t threadIndex)
+            {
+                Extract(view, drawables.data() + begin, end - begin, lists[threadIndex]);
+            });
+    }
+
+    void Merge(const std::vector<RenderCommandList>& lists, RenderQueue& queue)
+    {
+        size_t total = 0;
+        for (const RenderCommandList& list : lists)
+            total += list.Items.size();
+
+        queue.Clear();
+        queue.Reserve(total);
+
+        for (const RenderCommandList& list : lists)
+            queue.Append(list.Items.data(), list.Items.size());
+
+        // which thread extracted an item depends on timing, the sort puts them back in state order
+        queue.Sort();
+    }
+}
+
+void RenderCommandList::Clear()
+{
+    Items.clear();
+    Culled = 0;
+    Occluded = 0;
+
+    for (size_t& count : DrawablesPerLOD)
+        count = 0;
+}
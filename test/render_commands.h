@@ -0,0 +1,88 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "bounds.h"
+#include "lod.h"
+#include "occlusion_buffer.h"
+#include "render_queue.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <vector>
+
+class Drawable3DComponent;
+
+// everything extraction needs to know about the view, so it never has to touch rlgl or the window
+struct RenderView
+{
+    Camera3D Camera = { 0 };
+    Frustum ViewFrustum = { 0 };
+    float ViewportHeight = 0;
+    float FarPlane = 1000;
+
+    // the drawables were already frustum culled for this view by the VisibilitySystem
+    bool FrustumCulled = false;
+
+    // when set, drawables that pass the frustum test are also tested against it
+    const OcclusionBuffer* Occlusion = nullptr;
+};
+
+// the draw items one thread produced
+struct RenderCommandList
+{
+    std::vector<DrawItem> Items;
+    size_t Culled = 0;
+    size_t Occluded = 0;
+    size_t DrawablesPerLOD[LOD::MaxLevels] = { 0 };
+
+    void Clear();
+};
+
+// the CPU side of a frame in phases: update transforms, extract draw items in parallel, merge and sort
+// the GL submit stays on the main thread in the RenderSystem
+namespace RenderCommands
+{
+    // hierarchy roots per job when updating transforms, drawables per job when extracting
+    constexpr size_t TransformGrain = 64;
+    constexpr size_t ExtractGrain = 512;
+
+    // bring every world matrix up to date, one hierarchy subtree per job, so extraction only ever reads them
+    void UpdateTransforms();
+
+    // cull, pick the LOD and make the sort key for each drawable, only writes to the drawables themselves and the list
+    void Extract(const RenderView& view, Drawable3DComponent* const* drawables, size_t count, RenderCommandList& list);
+
+    // run extraction on the job pool, lists is resized to one per thread
+    void Build(const RenderView& view, const std::vector<Drawable3DComponent*>& drawables, std::vector<RenderCommandList>& lists);
+
+    // append every list to the queue and sort it
+    void Merge(const std::vector<RenderCommandList>& lists, RenderQueue& queue);
+}
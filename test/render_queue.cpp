@@ -0,0 +1,82 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "render_queue.h"
+
+#include <string.h>
+
+void RenderQueue::Sort()
+{
+    size_t count = Items.size();
+    if (count < 2)
+        return;
+
+    // build every byte histogram in one pass
+    uint32_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (const DrawItem& item : Items)
+    {
+        for (int pass = 0; pass < 8; pass++)
+            histograms[pass][(item.Key >> (pass * 8)) & 0xFF]++;
+    }
+
+    Scratch.resize(count);
+    DrawItem* source = Items.data();
+    DrawItem* destination = Scratch.data();
+
+    for (int pass = 0; pass < 8; pass++)
+    {
+        uint32_t* histogram = histograms[pass];
+
+        // every item has the same value for this byte, nothing to move
+        if (histogram[(source[0].Key >> (pass * 8)) & 0xFF] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++)
+        {
+            uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const DrawItem& item = source[i];
+            destination[histogram[(item.Key >> (pass * 8)) & 0xFF]++] = item;
+        }
+
+        DrawItem* swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != Items.data())
+        Items.swap(Scratch);
+}
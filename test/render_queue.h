@@ -0,0 +1,117 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class Drawable3DComponent;
+
+// the fixed function state a draw needs, pipeline changes are the most expensive so they sort first
+enum class RenderPipeline : uint8_t
+{
+    Opaque = 0,
+    DoubleSided = 1,
+};
+
+// 64 bit sort keys, most significant first
+//   63..60  pipeline state
+//   59..44  geometry (shape or mesh)
+//   43..24  material
+//   23..0   depth, front to back
+namespace DrawKey
+{
+    constexpr int PipelineShift = 60;
+    constexpr int GeometryShift = 44;
+    constexpr int MaterialShift = 24;
+
+    constexpr uint64_t PipelineMask = 0xF;
+    constexpr uint64_t GeometryMask = 0xFFFF;
+    constexpr uint64_t MaterialMask = 0xFFFFF;
+    constexpr uint64_t DepthMask = 0xFFFFFF;
+
+    // geometry ids below this are reserved for the built in shapes, one block per shape indexed by size class
+    constexpr uint16_t ShapeGeometryBlock = 1024;
+    constexpr uint16_t FirstMeshGeometry = ShapeGeometryBlock * 4;
+
+    inline uint16_t MakeShapeGeometry(uint8_t shape, uint16_t sizeClass) { return uint16_t(shape * ShapeGeometryBlock + sizeClass + 1); }
+    inline bool IsShapeGeometry(uint16_t geometry) { return geometry != 0 && geometry < FirstMeshGeometry; }
+
+    inline uint64_t Make(RenderPipeline pipeline, uint16_t geometry, uint32_t material, uint32_t depth)
+    {
+        return ((uint64_t(pipeline) & PipelineMask) << PipelineShift) |
+            ((uint64_t(geometry) & GeometryMask) << GeometryShift) |
+            ((uint64_t(material) & MaterialMask) << MaterialShift) |
+            (uint64_t(depth) & DepthMask);
+    }
+
+    // quantize a view distance into the depth bits
+    inline uint32_t QuantizeDepth(float distance, float farPlane)
+    {
+        float normalized = distance / farPlane;
+        if (normalized < 0)
+            normalized = 0;
+        else if (normalized > 1)
+            normalized = 1;
+
+        return uint32_t(normalized * float(DepthMask));
+    }
+
+    inline RenderPipeline GetPipeline(uint64_t key) { return RenderPipeline((key >> PipelineShift) & PipelineMask); }
+    inline uint16_t GetGeometry(uint64_t key) { return uint16_t((key >> GeometryShift) & GeometryMask); }
+    inline uint32_t GetMaterial(uint64_t key) { return uint32_t((key >> MaterialShift) & MaterialMask); }
+}
+
+struct DrawItem
+{
+    uint64_t Key = 0;
+    Drawable3DComponent* Drawable = nullptr;
+};
+
+// collects draw items for a frame and sorts them by key so state changes happen once per group
+class RenderQueue
+{
+public:
+    inline void Clear() { Items.clear(); }
+
+    inline void Add(uint64_t key, Drawable3DComponent* drawable) { Items.push_back(DrawItem{ key, drawable }); }
+    inline void Append(const DrawItem* items, size_t count) { Items.insert(Items.end(), items, items + count); }
+    inline void Reserve(size_t count) { Items.reserve(count); }
+
+    // LSD radix sort on the key, bytes that are the same for every item are skipped
+    void Sort();
+
+    inline const std::vector<DrawItem>& GetItems() const { return Items; }
+    inline size_t Size() const { return Items.size(); }
+
+private:
+    std::vector<DrawItem> Items;
+    std::vector<DrawItem> Scratch;
+};
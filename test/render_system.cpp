@@ -32,25 +32,122 @@
 #include "drawable_component.h"
 #include "transform_component.h"
 #include "camera_component.h"
+#include "bounds.h"
+#include "render_backend.h"
+#include "shape_pretransform.h"
+#include "primitive_mesh_cache.h"
+#include "static_batch_system.h"
+#include "render_commands.h"
+#include "occlusion_culling.h"
+#include "visibility_system.h"
 
 #include "raylib.h"
+#include "rlgl.h"
+
+#include <unordered_map>
 
 namespace RenderSystem
 {
     Camera3D ViewCam = { 0 };
+    uint64_t ViewCameraEntity = 0;
+    Frustum ViewFrustum = { 0 };
+    Matrix ViewProjection = { 0 };
+
+    std::vector<Drawable3DComponent*> VisibleSet;
+    RenderQueue Queue;
+    RenderStats Stats;
+
+    // every drawable in one flat list so extraction can split it across threads
+    std::vector<Drawable3DComponent*> Drawables;
+    std::unordered_map<Drawable3DComponent*, size_t> DrawableLookup;
+
+    std::vector<RenderCommandList> CommandLists;
+
+    ShapeBatchBuilder ShapeBatches;
+    bool UseInstancing = true;
+    bool UsePretransform = true;
+
+    void OnDrawableAdded(Component* component)
+    {
+        Drawable3DComponent* drawable = static_cast<Drawable3DComponent*>(component);
+
+        DrawableLookup[drawable] = Drawables.size();
+        Drawables.push_back(drawable);
+    }
+
+    void OnDrawableRemoved(Component* component)
+    {
+        auto itr = DrawableLookup.find(static_cast<Drawable3DComponent*>(component));
+        if (itr == DrawableLookup.end())
+            return;
+
+        size_t index = itr->second;
+        DrawableLookup.erase(itr);
+
+        if (index != Drawables.size() - 1)
+        {
+            Drawables[index] = Drawables.back();
+            DrawableLookup[Drawables[index]] = index;
+        }
+        Drawables.pop_back();
+    }
+
+    void Setup()
+    {
+        RenderBackend::Get().Setup();
+        ShapePretransform::Setup();
+
+        Drawables.clear();
+        DrawableLookup.clear();
+
+        ComponentManager::DoForEachEntity<Drawable3DComponent>([](Drawable3DComponent* drawable) { OnDrawableAdded(drawable); });
+
+        ComponentManager::AddAddObserver<Drawable3DComponent>(OnDrawableAdded);
+        ComponentManager::AddRemoveObserver<Drawable3DComponent>(OnDrawableRemoved);
+    }
+
+    void Shutdown()
+    {
+        RenderBackend::Get().Shutdown();
+        ShapePretransform::Shutdown();
+        StaticBatchSystem::Shutdown();
+        PrimitiveMeshCache::Clear();
+    }
+
+    void SetInstancing(bool enabled)
+    {
+        UseInstancing = enabled;
+    }
+
+    bool IsInstancing()
+    {
+        return UseInstancing && RenderBackend::Get().SupportsInstancing();
+    }
+
+    void SetPretransform(bool enabled)
+    {
+        UsePretransform = enabled;
+    }
+
+    bool IsPretransforming()
+    {
+        return UsePretransform && !IsInstancing();
+    }
 
-    void Begin(uint64_t cameraEntityId)
+    Camera3D GetCameraView(uint64_t cameraEntityId)
     {
+        Camera3D view = { 0 };
+
         CameraComponent* camera = ComponentManager::MustGetComponent<CameraComponent>(cameraEntityId);
-        ViewCam.fovy = 45;
+        view.fovy = camera->FOVY;
 
         // a camera entity must have a the transform component, if it doesn't we add one and get the default
         TransformComponent* cameraTransform = ComponentManager::MustGetComponent<TransformComponent>(camera);
 
-        Matrix cameraMat = cameraTransform->GetWorldMatrix();
-        ViewCam.position = Vector3Transform(Vector3Zero(), cameraMat);
-        ViewCam.target = Vector3Transform(Vector3{ 0, 1, 0 }, cameraMat);
-        ViewCam.up = Vector3Subtract(Vector3Transform(Vector3{ 0, 0, 1 }, cameraMat), ViewCam.position);
+        Matrix cameraMat = camera->Interpolation.Get(cameraTransform->GetWorldMatrix(), cameraTransform->GetWorldVersion());
+        view.position = Vector3Transform(Vector3Zero(), cameraMat);
+        view.target = Vector3Transform(Vector3{ 0, 1, 0 }, cameraMat);
+        view.up = Vector3Subtract(Vector3Transform(Vector3{ 0, 0, 1 }, cameraMat), view.position);
 
 // 
 //         // copy the transform vectors to the raylib camera
@@ -58,21 +155,218 @@ namespace RenderSystem
 //         ViewCam.target = Vector3Add(cameraTransform->GetPosition(), cameraTransform->GetForwardVector());
 //         ViewCam.up = cameraTransform->GetUpVector();
 
-        BeginMode3D(ViewCam);
+        return view;
     }
 
-    void Draw()
+    void Begin(uint64_t cameraEntityId, float aspect)
+    {
+        ViewCam = GetCameraView(cameraEntityId);
+        ViewCameraEntity = cameraEntityId;
+
+        if (aspect <= 0)
+            aspect = float(RenderBackend::Get().GetViewportWidth()) / float(RenderBackend::Get().GetViewportHeight());
+
+        ViewProjection = GetCameraViewProjection(ViewCam, aspect, float(RL_CULL_DISTANCE_NEAR), float(RL_CULL_DISTANCE_FAR));
+        ViewFrustum = FrustumFromMatrix(ViewProjection);
+
+        RenderBackend::Get().BeginView(ViewCam);
+    }
+
+    void SetPipeline(RenderPipeline pipeline)
+    {
+        RenderBackend::Get().SetBackfaceCulling(pipeline != RenderPipeline::DoubleSided);
+
+        Stats.PipelineChanges++;
+    }
+
+    // a batch holding an occluder would be hidden by itself
+    bool ContainsOccluder(const StaticBatchSystem::StaticBatch& batch)
+    {
+        for (Drawable3DComponent* member : batch.Members)
+        {
+            if (member->Occluder)
+                return true;
+        }
+        return false;
+    }
+
+    void FlushShapeBatches()
+    {
+        ShapeBatches.Build();
+
+        if (!IsInstancing())
+        {
+            Stats.PretransformDraws += ShapePretransform::DrawGroups(ShapeBatches);
+            for (const ShapeBatchBuilder::Group& group : ShapeBatches.GetGroups())
+                Stats.PretransformShapes += group.Count;
+
+            ShapeBatches.Clear();
+            return;
+        }
+
+        for (const ShapeBatchBuilder::Group& group : ShapeBatches.GetGroups())
+        {
+            RenderBackend::Get().DrawShapeGroup(ShapeBatches, group);
+
+            Stats.InstancedDraws++;
+            Stats.InstancedShapes += group.Count;
+        }
+
+        ShapeBatches.Clear();
+    }
+
+    void Submit()
     {
-        // TODO, get the visible set
-        ComponentManager::DoForEachEntity<Drawable3DComponent>([](Drawable3DComponent* drawable)
+        RenderPipeline currentPipeline = RenderPipeline::Opaque;
+        bool batchShapes = IsInstancing() || IsPretransforming();
+
+        ShapeBatches.Clear();
+
+        for (const DrawItem& item : Queue.GetItems())
+        {
+            RenderPipeline pipeline = DrawKey::GetPipeline(item.Key);
+            if (pipeline != currentPipeline)
+            {
+                // shapes collected so far were meant for the old state
+                FlushShapeBatches();
+
+                SetPipeline(pipeline);
+                currentPipeline = pipeline;
+            }
+
+            if (batchShapes && DrawKey::IsShapeGeometry(DrawKey::GetGeometry(item.Key)))
             {
-                if (drawable->Active)
-                    drawable->Draw(ViewCam);
-            });
+                // only shape components use the shape geometry ids
+                ShapeComponent* shape = static_cast<ShapeComponent*>(item.Drawable);
+                Color color = shape->MustGetComponent<ColorComponent>()->GetColor();
+
+                ShapeBatches.Add(shape->ObjectShape, shape->ObjectSize, uint8_t(shape->GetLOD()), shape->GetDrawMatrix(), color, DrawKey::GetMaterial(item.Key), pipeline);
+                continue;
+            }
+
+            item.Drawable->Draw(ViewCam);
+        }
+
+        FlushShapeBatches();
+
+        for (const StaticBatchSystem::StaticBatch& batch : StaticBatchSystem::GetBatches())
+        {
+            if (batch.Members.empty())
+                continue;
+
+            if (!FrustumContainsBox(ViewFrustum, batch.Bounds))
+            {
+                Stats.Culled += batch.Members.size();
+                continue;
+            }
+
+            if (OcclusionCulling::IsEnabled() && !ContainsOccluder(batch) && !OcclusionCulling::GetBuffer().IsVisible(batch.Bounds))
+            {
+                Stats.Occluded += batch.Members.size();
+                continue;
+            }
+
+            if (batch.Pipeline != currentPipeline)
+            {
+                SetPipeline(batch.Pipeline);
+                currentPipeline = batch.Pipeline;
+            }
+
+            StaticBatchSystem::DrawBatch(batch);
+
+            Stats.StaticBatchDraws++;
+            Stats.Visible += batch.Members.size();
+        }
+
+        if (currentPipeline != RenderPipeline::Opaque)
+            SetPipeline(RenderPipeline::Opaque);
+    }
+
+    void Prepare()
+    {
+        VisibleSet.clear();
+        Stats = RenderStats();
+
+        RenderView view;
+        view.Camera = ViewCam;
+        view.ViewFrustum = ViewFrustum;
+        view.ViewportHeight = float(RenderBackend::Get().GetViewportHeight());
+        view.FarPlane = float(RL_CULL_DISTANCE_FAR);
+
+        RenderCommands::UpdateTransforms();
+
+        if (OcclusionCulling::IsEnabled())
+        {
+            OcclusionCulling::Rasterize(ViewProjection, ViewFrustum);
+            view.Occlusion = &OcclusionCulling::GetBuffer();
+
+            Stats.Occluders = OcclusionCulling::GetOccluderCount();
+        }
+
+        // the visibility pass has already culled this camera's drawables against its frustum
+        const VisibilitySystem::CameraView* precomputed = VisibilitySystem::FindView(ViewCameraEntity);
+        if (precomputed != nullptr)
+        {
+            view.FrustumCulled = true;
+            Stats.Culled += precomputed->Culled;
+        }
+
+        RenderCommands::Build(view, precomputed != nullptr ? precomputed->Visible : Drawables, CommandLists);
+        RenderCommands::Merge(CommandLists, Queue);
+
+        for (const RenderCommandList& list : CommandLists)
+        {
+            Stats.Culled += list.Culled;
+            Stats.Occluded += list.Occluded;
+            for (int level = 0; level < LOD::MaxLevels; level++)
+                Stats.DrawablesPerLOD[level] += list.DrawablesPerLOD[level];
+        }
+
+        VisibleSet.reserve(Queue.Size());
+        for (const DrawItem& item : Queue.GetItems())
+        {
+            VisibleSet.push_back(item.Drawable);
+
+            // mesh lookups can generate meshes, so this stays off the worker threads
+            Stats.TrianglesPerLOD[item.Drawable->GetLOD()] += item.Drawable->GetTriangleCount();
+        }
+
+        Stats.Visible = VisibleSet.size();
+    }
+
+    void Draw()
+    {
+        Prepare();
+        Submit();
+    }
+
+    const Camera3D& GetViewCamera()
+    {
+        return ViewCam;
+    }
+
+    const std::vector<Drawable3DComponent*>& GetDrawables()
+    {
+        return Drawables;
+    }
+
+    const RenderQueue& GetRenderQueue()
+    {
+        return Queue;
+    }
+
+    const RenderStats& GetStats()
+    {
+        return Stats;
+    }
+
+    const std::vector<Drawable3DComponent*>& GetVisibleSet()
+    {
+        return VisibleSet;
     }
 
     void End()
     {
-        EndMode3D();
+        RenderBackend::Get().EndView();
     }
 }
\ No newline at end of file
@@ -30,11 +30,81 @@
 
 #include "entity.h"
 #include "components.h"
+#include "render_queue.h"
+#include "lod.h"
+
+#include "raylib.h"
+
+#include <vector>
+
+class Drawable3DComponent;
 
 // an example system that renders all drawables
 namespace RenderSystem
 {
-    void Begin(uint64_t cameraEntityId);
+    struct RenderStats
+    {
+        size_t Visible = 0;
+        size_t Culled = 0;
+        size_t PipelineChanges = 0;
+
+        // drawables that passed the frustum test but were behind an occluder, and the occluders drawn
+        size_t Occluded = 0;
+        size_t Occluders = 0;
+
+        // instanced shape draw calls and the shapes they covered
+        size_t InstancedDraws = 0;
+        size_t InstancedShapes = 0;
+
+        // shapes transformed on the CPU into streaming buffers when instancing is not available
+        size_t PretransformDraws = 0;
+        size_t PretransformShapes = 0;
+
+        // draw calls for static batches, their members count as visible or culled with the batch
+        size_t StaticBatchDraws = 0;
+
+        // what was submitted at each level of detail
+        size_t DrawablesPerLOD[LOD::MaxLevels] = { 0 };
+        size_t TrianglesPerLOD[LOD::MaxLevels] = { 0 };
+    };
+
+    // call after the window is created, loads the instanced shape path when the GL version supports it
+    void Setup();
+    void Shutdown();
+
+    // shapes are drawn instanced when enabled and available, otherwise one at a time
+    void SetInstancing(bool enabled);
+    bool IsInstancing();
+
+    // without instancing, shapes can still be batched by transforming them on the CPU
+    void SetPretransform(bool enabled);
+    bool IsPretransforming();
+
+    // aspect is the width over height of the target being drawn to, 0 uses the window
+    void Begin(uint64_t cameraEntityId, float aspect = 0);
+
+    // the raylib camera for a camera entity, from its world transform
+    Camera3D GetCameraView(uint64_t cameraEntityId);
+
+    // the CPU side of Draw: transforms, parallel extraction into per thread command lists, merge and sort, no GL calls
+    void Prepare();
+
+    // Prepare and then submit the queue on this thread
     void Draw();
     void End();
+
+    // the camera set up by the last call to Begin
+    const Camera3D& GetViewCamera();
+
+    // counts from the last call to Draw
+    const RenderStats& GetStats();
+
+    // the drawables that passed the frustum test in the last call to Draw
+    const std::vector<Drawable3DComponent*>& GetVisibleSet();
+
+    // every drawable component, in no particular order
+    const std::vector<Drawable3DComponent*>& GetDrawables();
+
+    // the sorted draw items submitted by the last call to Draw
+    const RenderQueue& GetRenderQueue();
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "resource_manager.h"
+
+#include "rlgl.h"
+
+#include <unordered_map>
+
+namespace ResourceManager
+{
+    template<class T>
+    class ResourcePool
+    {
+    public:
+        struct Entry
+        {
+            T Resource;
+            std::string Key;
+            uint32_t RefCount = 0;
+            uint32_t Generation = 0;
+            size_t Bytes = 0;
+
+            // overrides the pool's unload for resources that were not allocated the usual way
+            void(*Unload)(T) = nullptr;
+        };
+
+        std::vector<Entry> Entries;
+        std::vector<uint32_t> FreeSlots;
+        std::unordered_map<std::string, uint32_t> Keys;
+
+        Entry* Find(Handle<T> handle)
+        {
+            if (handle.Index >= Entries.size())
+                return nullptr;
+
+            Entry& entry = Entries[handle.Index];
+            if (entry.RefCount == 0 || entry.Generation != handle.Generation)
+                return nullptr;
+
+            return &entry;
+        }
+
+        Handle<T> FindKey(const std::string& key)
+        {
+            auto itr = Keys.find(key);
+            if (itr == Keys.end())
+                return Handle<T>();
+
+            Entry& entry = Entries[itr->second];
+            entry.RefCount++;
+            return Handle<T>{ itr->second, entry.Generation };
+        }
+
+        Handle<T> Acquire(const std::string& key, const std::function<T()>& create, const std::function<size_t(const T&)>& getBytes, void(*customUnload)(T) = nullptr)
+        {
+            Handle<T> existing = FindKey(key);
+            if (existing.IsValid())
+                return existing;
+
+            uint32_t index = 0;
+            if (!FreeSlots.empty())
+            {
+                index = FreeSlots.back();
+                FreeSlots.pop_back();
+            }
+            else
+            {
+                index = uint32_t(Entries.size());
+                Entries.emplace_back();
+            }
+
+            Entry& entry = Entries[index];
+            entry.Resource = create();
+            entry.Key = key;
+            entry.RefCount = 1;
+            entry.Bytes = getBytes(entry.Resource);
+            entry.Unload = customUnload;
+
+            Keys[key] = index;
+            return Handle<T>{ index, entry.Generation };
+        }
+
+        Handle<T> Retain(Handle<T> handle)
+        {
+            Entry* entry = Find(handle);
+            if (entry == nullptr)
+                return Handle<T>();
+
+            entry->RefCount++;
+            return handle;
+        }
+
+        void Release(Handle<T>& handle, void(*unload)(T))
+        {
+            Entry* entry = Find(handle);
+            handle = Handle<T>();
+
+            if (entry == nullptr)
+                return;
+
+            entry->RefCount--;
+            if (entry->RefCount > 0)
+                return;
+
+            Free(uint32_t(entry - Entries.data()), unload);
+        }
+
+        void Free(uint32_t index, void(*unload)(T))
+        {
+            Entry& entry = Entries[index];
+            if (entry.Unload != nullptr)
+                entry.Unload(entry.Resource);
+            else
+                unload(entry.Resource);
+
+            Keys.erase(entry.Key);
+            entry = Entry{ T(), std::string(), 0, entry.Generation + 1, 0, nullptr };
+            FreeSlots.push_back(index);
+        }
+
+        void Clear(void(*unload)(T))
+        {
+            for (uint32_t index = 0; index < Entries.size(); index++)
+            {
+                if (Entries[index].RefCount > 0)
+                    Free(index, unload);
+            }
+        }
+
+        void GetInfo(ResourceType type, std::vector<ResourceInfo>& info) const
+        {
+            for (const Entry& entry : Entries)
+            {
+                if (entry.RefCount > 0)
+                    info.push_back(ResourceInfo{ type, entry.Key, entry.RefCount, entry.Bytes });
+            }
+        }
+    };
+
+    ResourcePool<Mesh> Meshes;
+    ResourcePool<Material> Materials;
+    ResourcePool<Shader> Shaders;
+    ResourcePool<Model> Models;
+
+    size_t GetMeshBytes(const Mesh& mesh)
+    {
+        size_t vertexBytes = 0;
+        if (mesh.vertices != nullptr)
+            vertexBytes += sizeof(float) * 3;
+        if (mesh.texcoords != nullptr)
+            vertexBytes += sizeof(float) * 2;
+        if (mesh.texcoords2 != nullptr)
+            vertexBytes += sizeof(float) * 2;
+        if (mesh.normals != nullptr)
+            vertexBytes += sizeof(float) * 3;
+        if (mesh.tangents != nullptr)
+            vertexBytes += sizeof(float) * 4;
+        if (mesh.colors != nullptr)
+            vertexBytes += 4;
+
+        size_t indexBytes = (mesh.indices != nullptr) ? size_t(mesh.triangleCount) * 3 * sizeof(unsigned short) : 0;
+
+        return size_t(mesh.vertexCount) * vertexBytes + indexBytes;
+    }
+
+    size_t GetMaterialBytes(const Material& material)
+    {
+        if (material.maps == nullptr)
+            return 0;
+
+        // the default white texture is shared by everything, so it is not counted
+        size_t bytes = 0;
+        for (int i = 0; i < MAX_MATERIAL_MAPS; i++)
+        {
+            const Texture2D& texture = material.maps[i].texture;
+            if (texture.id != 0 && texture.id != rlGetTextureIdDefault())
+                bytes += GetPixelDataSize(texture.width, texture.height, texture.format);
+        }
+
+        return bytes;
+    }
+
+    size_t GetModelBytes(const Model& model)
+    {
+        size_t bytes = 0;
+        for (int i = 0; i < model.meshCount; i++)
+            bytes += GetMeshBytes(model.meshes[i]);
+
+        for (int i = 0; i < model.materialCount; i++)
+            bytes += GetMaterialBytes(model.materials[i]);
+
+        return bytes;
+    }
+
+    // a material owns its textures, but its shader is a shared resource of its own so UnloadMaterial can't be used
+    void UnloadSharedMaterial(Material material)
+    {
+        if (material.maps == nullptr)
+            return;
+
+        for (int i = 0; i < MAX_MATERIAL_MAPS; i++)
+        {
+            unsigned int textureId = material.maps[i].texture.id;
+            if (textureId != 0 && textureId != rlGetTextureIdDefault())
+                rlUnloadTexture(textureId);
+        }
+
+        RL_FREE(material.maps);
+    }
+
+    size_t GetShaderBytes(const Shader&)
+    {
+        return 0;
+    }
+
+    MeshHandle AcquireMesh(const std::string& key, const std::function<Mesh()>& create, void(*unload)(Mesh))
+    {
+        return Meshes.Acquire(key, create, GetMeshBytes, unload);
+    }
+
+    MaterialHandle AcquireMaterial(const std::string& key, const std::function<Material()>& create)
+    {
+        return Materials.Acquire(key, create, GetMaterialBytes);
+    }
+
+    MaterialHandle AcquireDefaultMaterial()
+    {
+        return Materials.Acquire("default", []() { return LoadMaterialDefault(); }, GetMaterialBytes);
+    }
+
+    std::string GetShaderKey(const char* vsFileName, const char* fsFileName)
+    {
+        std::string vs = (vsFileName != nullptr) ? vsFileName : "";
+        std::string fs = (fsFileName != nullptr) ? fsFileName : "";
+
+        return vs + "|" + fs;
+    }
+
+    ShaderHandle AcquireShader(const char* vsFileName, const char* fsFileName)
+    {
+        return Shaders.Acquire(GetShaderKey(vsFileName, fsFileName), [vsFileName, fsFileName]() { return LoadShader(vsFileName, fsFileName); }, GetShaderBytes);
+    }
+
+    ShaderHandle AcquireShader(const std::string& key, const std::function<Shader()>& create)
+    {
+        return Shaders.Acquire(key, create, GetShaderBytes);
+    }
+
+    MeshHandle FindMesh(const std::string& key)
+    {
+        return Meshes.FindKey(key);
+    }
+
+    ShaderHandle FindShader(const std::string& key)
+    {
+        return Shaders.FindKey(key);
+    }
+
+    ModelHandle AcquireModel(const char* fileName)
+    {
+        return Models.Acquire(fileName, [fileName]() { return LoadModel(fileName); }, GetModelBytes);
+    }
+
+    MeshHandle Retain(MeshHandle handle) { return Meshes.Retain(handle); }
+    MaterialHandle Retain(MaterialHandle handle) { return Materials.Retain(handle); }
+    ShaderHandle Retain(ShaderHandle handle) { return Shaders.Retain(handle); }
+    ModelHandle Retain(ModelHandle handle) { return Models.Retain(handle); }
+
+    void Release(MeshHandle& handle) { Meshes.Release(handle, UnloadMesh); }
+    void Release(MaterialHandle& handle) { Materials.Release(handle, UnloadSharedMaterial); }
+    void Release(ShaderHandle& handle) { Shaders.Release(handle, UnloadShader); }
+    void Release(ModelHandle& handle) { Models.Release(handle, UnloadModel); }
+
+    Mesh* Get(MeshHandle handle)
+    {
+        auto* entry = Meshes.Find(handle);
+        return (entry != nullptr) ? &entry->Resource : nullptr;
+    }
+
+    Material* Get(MaterialHandle handle)
+    {
+        auto* entry = Materials.Find(handle);
+        return (entry != nullptr) ? &entry->Resource : nullptr;
+    }
+
+    Shader* Get(ShaderHandle handle)
+    {
+        auto* entry = Shaders.Find(handle);
+        return (entry != nullptr) ? &entry->Resource : nullptr;
+    }
+
+    Model* Get(ModelHandle handle)
+    {
+        auto* entry = Models.Find(handle);
+        return (entry != nullptr) ? &entry->Resource : nullptr;
+    }
+
+    void GetResourceInfo(std::vector<ResourceInfo>& info)
+    {
+        Meshes.GetInfo(ResourceType::Mesh, info);
+        Materials.GetInfo(ResourceType::Material, info);
+        Shaders.GetInfo(ResourceType::Shader, info);
+        Models.GetInfo(ResourceType::Model, info);
+    }
+
+    size_t GetMemoryUsage()
+    {
+        std::vector<ResourceInfo> info;
+        GetResourceInfo(info);
+
+        size_t bytes = 0;
+        for (const ResourceInfo& resource : info)
+            bytes += resource.Bytes;
+
+        return bytes;
+    }
+
+    size_t GetResourceCount()
+    {
+        std::vector<ResourceInfo> info;
+        GetResourceInfo(info);
+        return info.size();
+    }
+
+    void Shutdown()
+    {
+        // models and materials can reference shaders, so those go last
+        Models.Clear(UnloadModel);
+        Meshes.Clear(UnloadMesh);
+        Materials.Clear(UnloadSharedMaterial);
+        Shaders.Clear(UnloadShader);
+    }
+}
@@ -0,0 +1,119 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// shared GPU resources, deduplicated by key or path and freed when the last reference is released
+namespace ResourceManager
+{
+    enum class ResourceType
+    {
+        Mesh,
+        Material,
+        Shader,
+        Model
+    };
+
+    // the generation catches handles that outlived their resource when a slot gets reused
+    template<class T>
+    struct Handle
+    {
+        static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+        uint32_t Index = InvalidIndex;
+        uint32_t Generation = 0;
+
+        inline bool IsValid() const { return Index != InvalidIndex; }
+        inline bool operator==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+        inline bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    using MeshHandle = Handle<Mesh>;
+    using MaterialHandle = Handle<Material>;
+    using ShaderHandle = Handle<Shader>;
+    using ModelHandle = Handle<Model>;
+
+    struct ResourceInfo
+    {
+        ResourceType Type = ResourceType::Mesh;
+        std::string Key;
+        uint32_t RefCount = 0;
+        size_t Bytes = 0;
+    };
+
+    // resources built in code, create only runs the first time a key is seen
+    // unload replaces UnloadMesh for meshes whose arrays were not allocated by raylib
+    MeshHandle AcquireMesh(const std::string& key, const std::function<Mesh()>& create, void(*unload)(Mesh) = nullptr);
+    MaterialHandle AcquireMaterial(const std::string& key, const std::function<Material()>& create);
+    MaterialHandle AcquireDefaultMaterial();
+
+    // resources loaded from disk, keyed by their paths
+    ShaderHandle AcquireShader(const char* vsFileName, const char* fsFileName);
+    ShaderHandle AcquireShader(const std::string& key, const std::function<Shader()>& create);
+    ModelHandle AcquireModel(const char* fileName);
+
+    std::string GetShaderKey(const char* vsFileName, const char* fsFileName);
+
+    // a new reference to an already loaded resource, or an invalid handle when the key is not loaded
+    MeshHandle FindMesh(const std::string& key);
+    ShaderHandle FindShader(const std::string& key);
+
+    // another reference to a resource that is already held
+    MeshHandle Retain(MeshHandle handle);
+    MaterialHandle Retain(MaterialHandle handle);
+    ShaderHandle Retain(ShaderHandle handle);
+    ModelHandle Retain(ModelHandle handle);
+
+    // drops a reference and clears the handle, the last one unloads the resource
+    void Release(MeshHandle& handle);
+    void Release(MaterialHandle& handle);
+    void Release(ShaderHandle& handle);
+    void Release(ModelHandle& handle);
+
+    // nullptr for invalid or stale handles, the pointer is only good until the next acquire of the same type
+    Mesh* Get(MeshHandle handle);
+    Material* Get(MaterialHandle handle);
+    Shader* Get(ShaderHandle handle);
+    Model* Get(ModelHandle handle);
+
+    // approximate CPU side bytes of everything that is loaded, GPU copies are about the same size
+    size_t GetMemoryUsage();
+    size_t GetResourceCount();
+    void GetResourceInfo(std::vector<ResourceInfo>& info);
+
+    // unloads everything regardless of references
+    void Shutdown();
+}
@@ -0,0 +1,137 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "shader_uniform_cache.h"
+#include "render_backend.h"
+
+#include <string.h>
+
+void ShaderUniformCache::Setup(const Shader& shader)
+{
+    Clear();
+    CachedShader = shader;
+}
+
+void ShaderUniformCache::Clear()
+{
+    CachedShader = Shader{ 0 };
+    Uniforms.clear();
+    Names.clear();
+    Shadow.clear();
+    ResetCounters();
+}
+
+size_t ShaderUniformCache::GetUniformSize(int uniformType)
+{
+    switch (uniformType)
+    {
+    case SHADER_UNIFORM_VEC2:
+    case SHADER_UNIFORM_IVEC2:
+        return sizeof(float) * 2;
+
+    case SHADER_UNIFORM_VEC3:
+    case SHADER_UNIFORM_IVEC3:
+        return sizeof(float) * 3;
+
+    case SHADER_UNIFORM_VEC4:
+    case SHADER_UNIFORM_IVEC4:
+        return sizeof(float) * 4;
+
+    default:
+        return sizeof(float);
+    }
+}
+
+ShaderUniformCache::Handle ShaderUniformCache::Register(const char* name, int uniformType, int count)
+{
+    auto itr = Names.find(name);
+    if (itr != Names.end())
+        return itr->second;
+
+    Uniform uniform;
+    uniform.Location = GetShaderLocation(CachedShader, name);
+    uniform.Type = uniformType;
+    uniform.Count = count;
+    uniform.Offset = Shadow.size();
+    uniform.Size = GetUniformSize(uniformType) * count;
+
+    Shadow.resize(Shadow.size() + uniform.Size);
+
+    Handle handle = Handle(Uniforms.size());
+    Uniforms.push_back(uniform);
+    Names[name] = handle;
+
+    return handle;
+}
+
+ShaderUniformCache::Handle ShaderUniformCache::Find(const char* name) const
+{
+    auto itr = Names.find(name);
+    return itr == Names.end() ? InvalidHandle : itr->second;
+}
+
+int ShaderUniformCache::GetLocation(Handle handle) const
+{
+    if (handle < 0 || handle >= Handle(Uniforms.size()))
+        return -1;
+
+    return Uniforms[handle].Location;
+}
+
+bool ShaderUniformCache::Set(Handle handle, const void* value)
+{
+    if (handle < 0 || handle >= Handle(Uniforms.size()))
+        return false;
+
+    Uniform& uniform = Uniforms[handle];
+
+    // the shader optimized it out, nothing to send
+    if (uniform.Location < 0)
+        return false;
+
+    uint8_t* shadow = Shadow.data() + uniform.Offset;
+    if (uniform.Valid && memcmp(shadow, value, uniform.Size) == 0)
+    {
+        SkippedUploads++;
+        return false;
+    }
+
+    memcpy(shadow, value, uniform.Size);
+    uniform.Valid = true;
+
+    RenderBackend::Get().SetUniform(CachedShader, uniform.Location, value, uniform.Type, uniform.Count);
+    IssuedUploads++;
+
+    return true;
+}
+
+void ShaderUniformCache::Invalidate()
+{
+    for (Uniform& uniform : Uniforms)
+        uniform.Valid = false;
+}
@@ -0,0 +1,88 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// resolves a shader's uniform locations once and keeps a shadow copy of every value it has uploaded
+// GL keeps uniform values per program, so a value that matches the shadow never needs to be sent again
+class ShaderUniformCache
+{
+public:
+    using Handle = int;
+    static constexpr Handle InvalidHandle = -1;
+
+    void Setup(const Shader& shader);
+    void Clear();
+
+    // looks the location up the first time a name is seen, later calls return the same handle
+    Handle Register(const char* name, int uniformType, int count = 1);
+    Handle Find(const char* name) const;
+
+    int GetLocation(Handle handle) const;
+
+    // uploads only when the value differs from the last upload, returns true if it was sent
+    bool Set(Handle handle, const void* value);
+
+    // forget the shadow values, the next Set on every uniform uploads
+    void Invalidate();
+
+    inline size_t GetIssuedUploads() const { return IssuedUploads; }
+    inline size_t GetSkippedUploads() const { return SkippedUploads; }
+    inline void ResetCounters() { IssuedUploads = SkippedUploads = 0; }
+
+    static size_t GetUniformSize(int uniformType);
+
+private:
+    struct Uniform
+    {
+        int Location = -1;
+        int Type = 0;
+        int Count = 1;
+        size_t Offset = 0;
+        size_t Size = 0;
+        bool Valid = false;
+    };
+
+    Shader CachedShader = { 0 };
+    std::vector<Uniform> Uniforms;
+    std::unordered_map<std::string, Handle> Names;
+
+    // the last uploaded value of every uniform, packed back to back
+    std::vector<uint8_t> Shadow;
+
+    size_t IssuedUploads = 0;
+    size_t SkippedUploads = 0;
+};
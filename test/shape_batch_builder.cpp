@@ -0,0 +1,264 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "shape_batch_builder.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <xmmintrin.h>
+
+namespace ShapeBatch
+{
+    uint16_t GetSizeClass(DrawShape shape, const Vector3& size)
+    {
+        if (shape != DrawShape::Cylinder)
+            return 0;
+
+        float radius = std::max(size.x, size.y);
+        if (radius <= 0)
+            return 0;
+
+        int top = std::clamp(int(roundf(size.x / radius * TaperSteps)), 0, TaperSteps);
+        int bottom = std::clamp(int(roundf(size.y / radius * TaperSteps)), 0, TaperSteps);
+
+        return uint16_t(top * (TaperSteps + 1) + bottom);
+    }
+
+    Vector3 GetUnitScale(DrawShape shape, const Vector3& size)
+    {
+        switch (shape)
+        {
+        case DrawShape::Sphere:
+        {
+            float radius = std::max(std::max(size.x, size.y), size.z);
+            return Vector3{ radius, radius, radius };
+        }
+
+        case DrawShape::Cylinder:
+        {
+            // x and y are the top and bottom radius, z is the height along Y
+            float radius = std::max(size.x, size.y);
+            return Vector3{ radius, size.z, radius };
+        }
+
+        case DrawShape::Plane:
+            return Vector3{ size.x, 1, size.y };
+
+        case DrawShape::Box:
+        default:
+            return size;
+        }
+    }
+
+    void GetCylinderRadii(uint16_t sizeClass, float& top, float& bottom)
+    {
+        top = float(sizeClass / (TaperSteps + 1)) / TaperSteps;
+        bottom = float(sizeClass % (TaperSteps + 1)) / TaperSteps;
+    }
+}
+
+void ShapeBatchBuilder::Clear()
+{
+    Groups.clear();
+    GroupKeys.clear();
+    Pending.clear();
+    Instances.clear();
+}
+
+size_t ShapeBatchBuilder::FindGroup(DrawShape shape, uint16_t sizeClass, uint8_t lod, uint32_t material, RenderPipeline pipeline)
+{
+    uint64_t key = (uint64_t(pipeline) << 60) | (uint64_t(shape) << 56) | (uint64_t(lod) << 48) | (uint64_t(sizeClass) << 32) | material;
+
+    // input usually arrives sorted, so the last group is the likely match
+    if (!GroupKeys.empty() && GroupKeys.back() == key)
+        return GroupKeys.size() - 1;
+
+    auto itr = std::find(GroupKeys.begin(), GroupKeys.end(), key);
+    if (itr != GroupKeys.end())
+        return size_t(itr - GroupKeys.begin());
+
+    Group group;
+    group.Shape = shape;
+    group.SizeClass = sizeClass;
+    group.LOD = lod;
+    group.Material = material;
+    group.Pipeline = pipeline;
+
+    Groups.push_back(group);
+    GroupKeys.push_back(key);
+    return Groups.size() - 1;
+}
+
+void ShapeBatchBuilder::Add(DrawShape shape, const Vector3& size, uint8_t lod, const Matrix& world, Color tint, uint32_t material, RenderPipeline pipeline)
+{
+    PendingInstance pending;
+    pending.Group = FindGroup(shape, ShapeBatch::GetSizeClass(shape, size), lod, material, pipeline);
+
+    Vector3 scale = ShapeBatch::GetUnitScale(shape, size);
+    float16 transform = MatrixToFloatV(MatrixMultiply(MatrixScale(scale.x, scale.y, scale.z), world));
+    std::copy(transform.v, transform.v + 16, pending.Instance.Transform);
+    pending.Instance.Tint = tint;
+
+    Pending.push_back(pending);
+    Groups[pending.Group].Count++;
+}
+
+void ShapeBatchBuilder::Build()
+{
+    size_t offset = 0;
+    for (Group& group : Groups)
+    {
+        group.First = offset;
+        offset += group.Count;
+    }
+
+    // counting sort into the group ranges
+    Instances.resize(offset);
+    std::vector<size_t> cursor(Groups.size());
+    for (size_t i = 0; i < Groups.size(); i++)
+        cursor[i] = Groups[i].First;
+
+    for (const PendingInstance& pending : Pending)
+        Instances[cursor[pending.Group]++] = pending.Instance;
+
+    Pending.clear();
+}
+
+void ShapeVertexStream::Clear()
+{
+    Positions.clear();
+    Normals.clear();
+    Colors.clear();
+    VertexCount = 0;
+}
+
+void ShapeVertexStream::Append(const Mesh& unitMesh, const ShapeInstance* instances, size_t count)
+{
+    if (unitMesh.vertices == nullptr || unitMesh.vertexCount <= 0 || count == 0)
+        return;
+
+    int corners = (unitMesh.indices != nullptr) ? unitMesh.triangleCount * 3 : unitMesh.vertexCount;
+
+    size_t first = size_t(VertexCount);
+    VertexCount += int(corners * count);
+
+    Positions.resize(size_t(VertexCount) * 3);
+    Normals.resize(size_t(VertexCount) * 3);
+    Colors.resize(size_t(VertexCount));
+
+    TransformedPositions.resize(size_t(unitMesh.vertexCount));
+    TransformedNormals.resize(size_t(unitMesh.vertexCount));
+
+    float* outPosition = Positions.data() + first * 3;
+    float* outNormal = Normals.data() + first * 3;
+    Color* outColor = Colors.data() + first;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* m = instances[i].Transform;
+
+        // the transform is column major, a point is x * column0 + y * column1 + z * column2 + column3
+        __m128 column0 = _mm_loadu_ps(m + 0);
+        __m128 column1 = _mm_loadu_ps(m + 4);
+        __m128 column2 = _mm_loadu_ps(m + 8);
+        __m128 column3 = _mm_loadu_ps(m + 12);
+
+        for (int v = 0; v < unitMesh.vertexCount; v++)
+        {
+            const float* source = unitMesh.vertices + v * 3;
+            __m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(column0, _mm_load1_ps(source + 0)), _mm_mul_ps(column1, _mm_load1_ps(source + 1))),
+                _mm_add_ps(_mm_mul_ps(column2, _mm_load1_ps(source + 2)), column3));
+
+            _mm_store_ps(TransformedPositions[v].V, position);
+        }
+
+        if (unitMesh.normals != nullptr)
+        {
+            // the inverse transpose without the divide by the determinant (the columns' cross products), scales are undone by the normalize
+            Vector3 a = { m[0], m[1], m[2] };
+            Vector3 b = { m[4], m[5], m[6] };
+            Vector3 c = { m[8], m[9], m[10] };
+
+            Vector3 normal0 = Vector3CrossProduct(b, c);
+            Vector3 normal1 = Vector3CrossProduct(c, a);
+            Vector3 normal2 = Vector3CrossProduct(a, b);
+
+            // mirrored transforms would turn the normals inside out
+            float flip = (Vector3DotProduct(a, normal0) < 0) ? -1.0f : 1.0f;
+
+            __m128 normalColumn0 = _mm_mul_ps(_mm_setr_ps(normal0.x, normal0.y, normal0.z, 0), _mm_set1_ps(flip));
+            __m128 normalColumn1 = _mm_mul_ps(_mm_setr_ps(normal1.x, normal1.y, normal1.z, 0), _mm_set1_ps(flip));
+            __m128 normalColumn2 = _mm_mul_ps(_mm_setr_ps(normal2.x, normal2.y, normal2.z, 0), _mm_set1_ps(flip));
+
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 threeHalves = _mm_set1_ps(1.5f);
+            const __m128 epsilon = _mm_set1_ps(1e-20f);
+
+            for (int v = 0; v < unitMesh.vertexCount; v++)
+            {
+                const float* source = unitMesh.normals + v * 3;
+                __m128 normal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalColumn0, _mm_load1_ps(source + 0)), _mm_mul_ps(normalColumn1, _mm_load1_ps(source + 1))),
+                    _mm_mul_ps(normalColumn2, _mm_load1_ps(source + 2)));
+
+                // w is 0, so the horizontal sum of the squares is the squared length in every lane
+                __m128 squared = _mm_mul_ps(normal, normal);
+                squared = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+                squared = _mm_add_ps(_mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 0, 3, 2))), epsilon);
+
+                // the estimate plus one newton step is plenty for lighting
+                __m128 inverse = _mm_rsqrt_ps(squared);
+                inverse = _mm_mul_ps(inverse, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, squared), _mm_mul_ps(inverse, inverse))));
+
+                _mm_store_ps(TransformedNormals[v].V, _mm_mul_ps(normal, inverse));
+            }
+        }
+
+        for (int corner = 0; corner < corners; corner++)
+        {
+            int v = (unitMesh.indices != nullptr) ? unitMesh.indices[corner] : corner;
+
+            memcpy(outPosition, TransformedPositions[v].V, sizeof(float) * 3);
+            outPosition += 3;
+
+            if (unitMesh.normals != nullptr)
+            {
+                memcpy(outNormal, TransformedNormals[v].V, sizeof(float) * 3);
+            }
+            else
+            {
+                outNormal[0] = 0;
+                outNormal[1] = 1;
+                outNormal[2] = 0;
+            }
+            outNormal += 3;
+
+            *outColor++ = instances[i].Tint;
+        }
+    }
+}
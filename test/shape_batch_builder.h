@@ -0,0 +1,136 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "draw_shape.h"
+#include "render_queue.h"
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// everything needed to draw shapes from shared unit meshes, without touching the GPU
+namespace ShapeBatch
+{
+    // cylinder top/bottom radius ratios are rounded to this many steps so similar cones share a mesh
+    constexpr int TaperSteps = 16;
+    constexpr int SizeClassCount = (TaperSteps + 1) * (TaperSteps + 1);
+
+    // the part of a shape's proportions a scale can't express, only tapered cylinders have one
+    uint16_t GetSizeClass(DrawShape shape, const Vector3& size);
+
+    // the scale that maps the unit mesh for a shape onto the size it is drawn at
+    Vector3 GetUnitScale(DrawShape shape, const Vector3& size);
+
+    // the radii of the unit cylinder (height 1) for a size class
+    void GetCylinderRadii(uint16_t sizeClass, float& top, float& bottom);
+}
+
+// per instance data, laid out the way the instanced shader reads it
+struct ShapeInstance
+{
+    float Transform[16];
+    Color Tint;
+};
+
+// sorts shapes into groups that can each be drawn with one instanced call
+class ShapeBatchBuilder
+{
+public:
+    struct Group
+    {
+        DrawShape Shape = DrawShape::Box;
+        uint16_t SizeClass = 0;
+        uint8_t LOD = 0;
+        uint32_t Material = 0;
+        RenderPipeline Pipeline = RenderPipeline::Opaque;
+
+        // range in GetInstances()
+        size_t First = 0;
+        size_t Count = 0;
+    };
+
+    void Clear();
+
+    // world is the drawable's world matrix, the unit scale for the shape is applied here
+    void Add(DrawShape shape, const Vector3& size, uint8_t lod, const Matrix& world, Color tint, uint32_t material, RenderPipeline pipeline);
+
+    // lay the instances out contiguously per group
+    void Build();
+
+    inline const std::vector<Group>& GetGroups() const { return Groups; }
+    inline const std::vector<ShapeInstance>& GetInstances() const { return Instances; }
+
+private:
+    struct PendingInstance
+    {
+        size_t Group;
+        ShapeInstance Instance;
+    };
+
+    std::vector<Group> Groups;
+    std::vector<uint64_t> GroupKeys;
+    std::vector<PendingInstance> Pending;
+    std::vector<ShapeInstance> Instances;
+
+    size_t FindGroup(DrawShape shape, uint16_t sizeClass, uint8_t lod, uint32_t material, RenderPipeline pipeline);
+};
+
+// shapes transformed on the CPU into plain triangle lists, for drawing many shapes at once without instancing
+class ShapeVertexStream
+{
+public:
+    void Clear();
+
+    // transforms the unit mesh by every instance transform (SSE) and appends the triangles, indexed meshes are expanded
+    void Append(const Mesh& unitMesh, const ShapeInstance* instances, size_t count);
+
+    inline int GetVertexCount() const { return VertexCount; }
+    inline const float* GetPositions() const { return Positions.data(); }
+    inline const float* GetNormals() const { return Normals.data(); }
+    inline const Color* GetColors() const { return Colors.data(); }
+
+private:
+    struct alignas(16) Float4
+    {
+        float V[4];
+    };
+
+    std::vector<float> Positions;
+    std::vector<float> Normals;
+    std::vector<Color> Colors;
+    int VertexCount = 0;
+
+    // one instance worth of transformed unit mesh vertices, before the indices are expanded
+    std::vector<Float4> TransformedPositions;
+    std::vector<Float4> TransformedNormals;
+};
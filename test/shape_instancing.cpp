@@ -0,0 +1,183 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "shape_instancing.h"
+#include "primitive_mesh_cache.h"
+#include "primitive_meshes.h"
+
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <map>
+
+namespace ShapeInstancing
+{
+#define GLSL_VERSION            330
+
+    struct InstancedMesh
+    {
+        // owned by the PrimitiveMeshCache
+        const Mesh* UnitMesh = nullptr;
+
+        // per instance transforms and colors, bound into the unit mesh's vertex array
+        unsigned int InstanceBuffer = 0;
+        size_t Capacity = 0;
+    };
+
+    Shader InstanceShader = { 0 };
+    int InstanceTransformLoc = -1;
+    int InstanceColorLoc = -1;
+
+    bool Available = false;
+
+    std::map<uint32_t, InstancedMesh> Meshes;
+
+    bool Setup()
+    {
+        if (Available)
+            return true;
+
+        if (rlGetVersion() != RL_OPENGL_33)
+            return false;
+
+        // no fragment shader, the default one multiplies the texture, colDiffuse and the instance color
+        InstanceShader = LoadShader(TextFormat("resources/shaders/glsl%i/base_lighting_instanced.vs", GLSL_VERSION), nullptr);
+        if (InstanceShader.id == 0 || InstanceShader.id == rlGetShaderIdDefault())
+            return false;
+
+        InstanceTransformLoc = GetShaderLocationAttrib(InstanceShader, "instanceTransform");
+        InstanceColorLoc = GetShaderLocationAttrib(InstanceShader, "instanceColor");
+        if (InstanceTransformLoc < 0 || InstanceColorLoc < 0)
+        {
+            UnloadShader(InstanceShader);
+            InstanceShader = Shader{ 0 };
+            return false;
+        }
+
+        Available = true;
+        return true;
+    }
+
+    void Shutdown()
+    {
+        for (auto& entry : Meshes)
+        {
+            if (entry.second.InstanceBuffer != 0)
+                rlUnloadVertexBuffer(entry.second.InstanceBuffer);
+        }
+        Meshes.clear();
+
+        if (Available)
+            UnloadShader(InstanceShader);
+
+        InstanceShader = Shader{ 0 };
+        Available = false;
+    }
+
+    bool IsAvailable()
+    {
+        return Available;
+    }
+
+    InstancedMesh& GetMesh(DrawShape shape, uint16_t sizeClass, uint8_t lod)
+    {
+        uint32_t key = (uint32_t(shape) << 24) | (uint32_t(lod) << 16) | sizeClass;
+
+        auto itr = Meshes.find(key);
+        if (itr != Meshes.end())
+            return itr->second;
+
+        InstancedMesh& mesh = Meshes[key];
+        mesh.UnitMesh = &PrimitiveMeshCache::Get(shape, sizeClass, PrimitiveMeshes::GetLODTessellation(shape, lod));
+        return mesh;
+    }
+
+    void UploadInstances(InstancedMesh& mesh, const ShapeInstance* instances, size_t count)
+    {
+        int size = int(count * sizeof(ShapeInstance));
+
+        if (count <= mesh.Capacity)
+        {
+            rlUpdateVertexBuffer(mesh.InstanceBuffer, (void*)instances, size, 0);
+            return;
+        }
+
+        // grow the buffer and point the vertex array's instance attributes at the new one
+        if (mesh.InstanceBuffer != 0)
+            rlUnloadVertexBuffer(mesh.InstanceBuffer);
+
+        rlEnableVertexArray(mesh.UnitMesh->vaoId);
+        mesh.InstanceBuffer = rlLoadVertexBuffer((void*)instances, size, true);
+        mesh.Capacity = count;
+
+        for (int i = 0; i < 4; i++)
+        {
+            rlEnableVertexAttribute(InstanceTransformLoc + i);
+            rlSetVertexAttribute(InstanceTransformLoc + i, 4, RL_FLOAT, false, sizeof(ShapeInstance), (void*)(i * sizeof(Vector4)));
+            rlSetVertexAttributeDivisor(InstanceTransformLoc + i, 1);
+        }
+
+        rlEnableVertexAttribute(InstanceColorLoc);
+        rlSetVertexAttribute(InstanceColorLoc, 4, RL_UNSIGNED_BYTE, true, sizeof(ShapeInstance), (void*)offsetof(ShapeInstance, Tint));
+        rlSetVertexAttributeDivisor(InstanceColorLoc, 1);
+
+        rlDisableVertexBuffer();
+        rlDisableVertexArray();
+    }
+
+    void DrawGroup(const ShapeBatchBuilder& builder, const ShapeBatchBuilder::Group& group)
+    {
+        if (!Available || group.Count == 0)
+            return;
+
+        InstancedMesh& mesh = GetMesh(group.Shape, group.SizeClass, group.LOD);
+        UploadInstances(mesh, builder.GetInstances().data() + group.First, group.Count);
+
+        rlEnableShader(InstanceShader.id);
+
+        Matrix modelView = MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview());
+        rlSetUniformMatrix(InstanceShader.locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(modelView, rlGetMatrixProjection()));
+
+        float white[4] = { 1, 1, 1, 1 };
+        rlSetUniform(InstanceShader.locs[SHADER_LOC_COLOR_DIFFUSE], white, SHADER_UNIFORM_VEC4, 1);
+
+        rlActiveTextureSlot(0);
+        rlEnableTexture(rlGetTextureIdDefault());
+
+        rlEnableVertexArray(mesh.UnitMesh->vaoId);
+
+        if (mesh.UnitMesh->indices != nullptr)
+            rlDrawVertexArrayElementsInstanced(0, mesh.UnitMesh->triangleCount * 3, nullptr, int(group.Count));
+        else
+            rlDrawVertexArrayInstanced(0, mesh.UnitMesh->vertexCount, int(group.Count));
+
+        rlDisableVertexArray();
+        rlDisableTexture();
+        rlDisableShader();
+    }
+}
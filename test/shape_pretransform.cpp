@@ -0,0 +1,161 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "shape_pretransform.h"
+#include "primitive_mesh_cache.h"
+#include "primitive_meshes.h"
+#include "render_backend.h"
+
+#include "raymath.h"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace ShapePretransform
+{
+    Mesh StreamMeshes[StreamBufferCount] = { 0 };
+    int NextStream = 0;
+    bool Loaded = false;
+
+    ShapeVertexStream Vertices;
+    std::vector<size_t> GroupOrder;
+
+    // raylib buffer slots for the streams that change every draw
+    constexpr int PositionBuffer = 0;
+    constexpr int NormalBuffer = 2;
+    constexpr int ColorBuffer = 3;
+
+    void Setup()
+    {
+        if (Loaded)
+            return;
+
+        for (Mesh& mesh : StreamMeshes)
+        {
+            mesh = Mesh{ 0 };
+            mesh.vertexCount = StreamVertices;
+            mesh.triangleCount = StreamVertices / 3;
+
+            // texcoords are never streamed, shapes use the default white texture
+            mesh.vertices = (float*)RL_CALLOC(StreamVertices * 3, sizeof(float));
+            mesh.texcoords = (float*)RL_CALLOC(StreamVertices * 2, sizeof(float));
+            mesh.normals = (float*)RL_CALLOC(StreamVertices * 3, sizeof(float));
+            mesh.colors = (unsigned char*)RL_CALLOC(StreamVertices * 4, sizeof(unsigned char));
+
+            UploadMesh(&mesh, true);
+        }
+
+        NextStream = 0;
+        Loaded = true;
+    }
+
+    void Shutdown()
+    {
+        if (Loaded)
+        {
+            for (Mesh& mesh : StreamMeshes)
+                UnloadMesh(mesh);
+        }
+
+        for (Mesh& mesh : StreamMeshes)
+            mesh = Mesh{ 0 };
+
+        Vertices = ShapeVertexStream();
+        Loaded = false;
+    }
+
+    size_t DrawStream(Material& material)
+    {
+        size_t draws = 0;
+
+        for (int first = 0; first < Vertices.GetVertexCount(); first += StreamVertices)
+        {
+            int count = std::min(StreamVertices, Vertices.GetVertexCount() - first);
+
+            Mesh& mesh = StreamMeshes[NextStream];
+            NextStream = (NextStream + 1) % StreamBufferCount;
+
+            RenderBackend& backend = RenderBackend::Get();
+            backend.UpdateMeshBuffer(mesh, PositionBuffer, Vertices.GetPositions() + first * 3, count * 3 * sizeof(float));
+            backend.UpdateMeshBuffer(mesh, NormalBuffer, Vertices.GetNormals() + first * 3, count * 3 * sizeof(float));
+            backend.UpdateMeshBuffer(mesh, ColorBuffer, Vertices.GetColors() + first, count * sizeof(Color));
+
+            // the buffers are sized for the full stream, only draw what was written
+            Mesh draw = mesh;
+            draw.vertexCount = count;
+            draw.triangleCount = count / 3;
+
+            backend.DrawMesh(draw, material, MatrixIdentity());
+            draws++;
+        }
+
+        Vertices.Clear();
+        return draws;
+    }
+
+    size_t DrawGroups(const ShapeBatchBuilder& builder)
+    {
+        const std::vector<ShapeBatchBuilder::Group>& groups = builder.GetGroups();
+        if (!Loaded || groups.empty())
+            return 0;
+
+        // the builder keeps groups in the order they were first seen, gather them by material
+        GroupOrder.resize(groups.size());
+        for (size_t i = 0; i < groups.size(); i++)
+            GroupOrder[i] = i;
+
+        std::stable_sort(GroupOrder.begin(), GroupOrder.end(), [&groups](size_t a, size_t b) { return groups[a].Material < groups[b].Material; });
+
+        // the colors are in the vertices, so a copy of the shared material's maps draws white
+        Material material = PrimitiveMeshCache::GetMaterial();
+        MaterialMap maps[MAX_MATERIAL_MAPS];
+        memcpy(maps, material.maps, sizeof(maps));
+        maps[MAP_DIFFUSE].color = WHITE;
+        material.maps = maps;
+
+        size_t draws = 0;
+        Vertices.Clear();
+
+        for (size_t i = 0; i < GroupOrder.size(); i++)
+        {
+            const ShapeBatchBuilder::Group& group = groups[GroupOrder[i]];
+            if (group.Count == 0)
+                continue;
+
+            const Mesh& unitMesh = PrimitiveMeshCache::Get(group.Shape, group.SizeClass, PrimitiveMeshes::GetLODTessellation(group.Shape, group.LOD));
+            Vertices.Append(unitMesh, builder.GetInstances().data() + group.First, group.Count);
+
+            bool lastOfMaterial = i + 1 == GroupOrder.size() || groups[GroupOrder[i + 1]].Material != group.Material;
+            if (lastOfMaterial)
+                draws += DrawStream(material);
+        }
+
+        return draws;
+    }
+}
@@ -0,0 +1,54 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "shape_batch_builder.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+
+// draws the groups from a ShapeBatchBuilder by transforming them on the CPU into streaming vertex buffers
+// the fallback when instancing is not available, one draw call per material and buffer's worth of vertices
+namespace ShapePretransform
+{
+    // vertices in each streaming buffer, more than this in one material is split across draws
+    constexpr int StreamVertices = 3 * 32768;
+
+    // buffers are cycled so a draw does not wait on the GPU still reading the previous one
+    constexpr int StreamBufferCount = 3;
+
+    // creates the streaming buffers, call after the window is created
+    void Setup();
+    void Shutdown();
+
+    // must be called between BeginMode3D and EndMode3D, with the pipeline state for the groups already set
+    // returns the number of draw calls
+    size_t DrawGroups(const ShapeBatchBuilder& builder);
+}
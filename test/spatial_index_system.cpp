@@ -0,0 +1,186 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "spatial_index_system.h"
+
+#include "drawable_component.h"
+#include "transform_component.h"
+
+#include <unordered_map>
+
+namespace SpatialIndexSystem
+{
+    struct IndexEntry
+    {
+        uint64_t EntityId = 0;
+        TransformComponent* Transform = nullptr;
+        int32_t Proxy = DynamicBVH::NullNode;
+        uint32_t WorldVersion = 0;
+        bool BoundsDirty = true;
+    };
+
+    DynamicBVH Tree;
+
+    std::vector<IndexEntry> Entries;
+    std::unordered_map<uint64_t, size_t> EntryLookup;
+
+    BoundingBox ComputeEntityBounds(IndexEntry& entry)
+    {
+        const std::vector<Component*>& drawables = ComponentManager::FindComponents(Drawable3DComponent::GetComponentId(), entry.EntityId);
+
+        bool first = true;
+        BoundingBox bounds = { 0 };
+        for (Component* component : drawables)
+        {
+            const BoundingBox& drawableBounds = static_cast<Drawable3DComponent*>(component)->GetWorldBounds();
+            bounds = first ? drawableBounds : BoundingBoxUnion(bounds, drawableBounds);
+            first = false;
+        }
+
+        if (first)
+        {
+            Vector3 position = entry.Transform->GetWorldPosition();
+            bounds = BoundingBox{ position, position };
+        }
+
+        return bounds;
+    }
+
+    void OnTransformAdded(Component* component)
+    {
+        IndexEntry entry;
+        entry.EntityId = component->EntityId;
+        entry.Transform = static_cast<TransformComponent*>(component);
+
+        EntryLookup[entry.EntityId] = Entries.size();
+        Entries.push_back(entry);
+    }
+
+    void OnTransformRemoved(Component* component)
+    {
+        auto itr = EntryLookup.find(component->EntityId);
+        if (itr == EntryLookup.end() || Entries[itr->second].Transform != component)
+            return;
+
+        size_t index = itr->second;
+        if (Entries[index].Proxy != DynamicBVH::NullNode)
+            Tree.DestroyProxy(Entries[index].Proxy);
+
+        EntryLookup.erase(itr);
+
+        if (index != Entries.size() - 1)
+        {
+            Entries[index] = Entries.back();
+            EntryLookup[Entries[index].EntityId] = index;
+        }
+        Entries.pop_back();
+    }
+
+    void OnDrawableChanged(Component* component)
+    {
+        Invalidate(component->EntityId);
+    }
+
+    void Setup()
+    {
+        Tree.Clear();
+        Entries.clear();
+        EntryLookup.clear();
+
+        ComponentManager::DoForEachEntity<TransformComponent>([](TransformComponent* transform) { OnTransformAdded(transform); });
+
+        ComponentManager::AddAddObserver<TransformComponent>(OnTransformAdded);
+        ComponentManager::AddRemoveObserver<TransformComponent>(OnTransformRemoved);
+        ComponentManager::AddAddObserver<Drawable3DComponent>(OnDrawableChanged);
+        ComponentManager::AddRemoveObserver<Drawable3DComponent>(OnDrawableChanged);
+    }
+
+    void Invalidate(uint64_t entityId)
+    {
+        auto itr = EntryLookup.find(entityId);
+        if (itr != EntryLookup.end())
+            Entries[itr->second].BoundsDirty = true;
+    }
+
+    void Update()
+    {
+        for (IndexEntry& entry : Entries)
+        {
+            // refreshes the world matrix if a parent moved it
+            entry.Transform->GetWorldMatrix();
+
+            uint32_t version = entry.Transform->GetWorldVersion();
+            if (!entry.BoundsDirty && version == entry.WorldVersion && entry.Proxy != DynamicBVH::NullNode)
+                continue;
+
+            BoundingBox bounds = ComputeEntityBounds(entry);
+
+            if (entry.Proxy == DynamicBVH::NullNode)
+                entry.Proxy = Tree.CreateProxy(bounds, entry.EntityId);
+            else
+                Tree.MoveProxy(entry.Proxy, bounds);
+
+            entry.WorldVersion = version;
+            entry.BoundsDirty = false;
+        }
+    }
+
+    void QueryBox(const BoundingBox& box, std::vector<uint64_t>& entities)
+    {
+        Tree.QueryBox(box, entities);
+    }
+
+    void QuerySphere(const Vector3& center, float radius, std::vector<uint64_t>& entities)
+    {
+        Tree.QuerySphere(center, radius, entities);
+    }
+
+    void QueryFrustum(const Frustum& frustum, std::vector<uint64_t>& entities)
+    {
+        Tree.QueryFrustum(frustum, entities);
+    }
+
+    void RayCast(const Ray& ray, float maxDistance, std::vector<DynamicBVH::RayHit>& hits)
+    {
+        Tree.RayCast(ray, maxDistance, hits);
+    }
+
+    uint64_t Pick(const Ray& ray, float maxDistance)
+    {
+        DynamicBVH::RayHit hit;
+        if (!Tree.RayCastClosest(ray, maxDistance, hit))
+            return uint64_t(-1);
+
+        return hit.UserData;
+    }
+
+    const DynamicBVH& GetTree()
+    {
+        return Tree;
+    }
+}
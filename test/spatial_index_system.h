@@ -0,0 +1,60 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "entity.h"
+#include "components.h"
+#include "dynamic_bvh.h"
+
+#include "raylib.h"
+
+#include <vector>
+
+// keeps a DynamicBVH of every entity with a transform, for culling, gameplay and picking queries
+// an entity's bounds are the union of its drawables, or its world position if it has none
+namespace SpatialIndexSystem
+{
+    void Setup();
+
+    // refit entities whose transform changed since the last update
+    void Update();
+
+    // force an entity's bounds to be recomputed, for changes the transform doesn't see like a new shape size
+    void Invalidate(uint64_t entityId);
+
+    void QueryBox(const BoundingBox& box, std::vector<uint64_t>& entities);
+    void QuerySphere(const Vector3& center, float radius, std::vector<uint64_t>& entities);
+    void QueryFrustum(const Frustum& frustum, std::vector<uint64_t>& entities);
+    void RayCast(const Ray& ray, float maxDistance, std::vector<DynamicBVH::RayHit>& hits);
+
+    // the entity nearest along the ray, or uint64_t(-1)
+    uint64_t Pick(const Ray& ray, float maxDistance);
+
+    const DynamicBVH& GetTree();
+}
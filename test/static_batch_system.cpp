@@ -0,0 +1,412 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "static_batch_system.h"
+#include "static_batch_component.h"
+
+#include "drawable_component.h"
+#include "bounds.h"
+#include "render_backend.h"
+
+#include "raymath.h"
+
+#include <algorithm>
+#include <string.h>
+#include <unordered_map>
+
+namespace StaticBatchSystem
+{
+    struct MemberState
+    {
+        size_t Batch = 0;
+
+        // what was baked, compared every update to find members that changed
+        const Mesh* Source = nullptr;
+        Material* SourceMaterial = nullptr;
+
+        // the mesh behind Source, a component can swap its mesh without the pointer to it changing
+        const float* SourceVertices = nullptr;
+        unsigned int SourceVao = 0;
+        Matrix World = { 0 };
+        Color Tint = WHITE;
+        int VertexCount = 0;
+        RenderPipeline Pipeline = RenderPipeline::Opaque;
+        uint32_t MaterialId = 0;
+    };
+
+    std::vector<StaticBatch> Batches;
+    std::unordered_map<Drawable3DComponent*, MemberState> Members;
+
+    // drawables are baked on the next update, so sizes and shapes set right after they are added are picked up
+    std::vector<Drawable3DComponent*> Pending;
+
+    size_t Rebuilds = 0;
+
+    size_t FindBatch(RenderPipeline pipeline, uint32_t materialId, int vertexCount)
+    {
+        for (size_t i = 0; i < Batches.size(); i++)
+        {
+            StaticBatch& batch = Batches[i];
+            if (batch.Members.empty() || (batch.Pipeline == pipeline && batch.MaterialId == materialId && batch.VertexCount + vertexCount <= MaxBatchVertices))
+            {
+                batch.Pipeline = pipeline;
+                batch.MaterialId = materialId;
+                return i;
+            }
+        }
+
+        StaticBatch batch;
+        batch.Pipeline = pipeline;
+        batch.MaterialId = materialId;
+        Batches.push_back(batch);
+        return Batches.size() - 1;
+    }
+
+    void InsertMember(Drawable3DComponent* drawable, MemberState& state)
+    {
+        state.Batch = FindBatch(state.Pipeline, state.MaterialId, state.VertexCount);
+
+        StaticBatch& batch = Batches[state.Batch];
+        batch.Members.push_back(drawable);
+        batch.VertexCount += state.VertexCount;
+        batch.Dirty = true;
+    }
+
+    void ExtractMember(Drawable3DComponent* drawable, MemberState& state)
+    {
+        StaticBatch& batch = Batches[state.Batch];
+
+        auto itr = std::find(batch.Members.begin(), batch.Members.end(), drawable);
+        if (itr != batch.Members.end())
+            batch.Members.erase(itr);
+
+        batch.VertexCount -= state.VertexCount;
+        batch.Dirty = true;
+    }
+
+    // fills the state from the drawable, returns false if it can't be baked
+    bool ReadMember(Drawable3DComponent* drawable, MemberState& state)
+    {
+        Matrix model = MatrixIdentity();
+        Material* material = nullptr;
+        const Mesh* mesh = drawable->GetStaticMesh(model, material);
+        if (mesh == nullptr || material == nullptr || mesh->vertices == nullptr || mesh->vertexCount > MaxBatchVertices)
+            return false;
+
+        state.Source = mesh;
+        state.SourceMaterial = material;
+        state.SourceVertices = mesh->vertices;
+        state.SourceVao = mesh->vaoId;
+        state.World = model;
+        state.Tint = drawable->GetTint();
+        state.VertexCount = mesh->vertexCount;
+        state.Pipeline = drawable->GetPipeline();
+        state.MaterialId = drawable->GetMaterialId();
+        return true;
+    }
+
+    void AddMember(Drawable3DComponent* drawable)
+    {
+        MemberState state;
+        if (!ReadMember(drawable, state))
+            return;
+
+        MemberState& member = Members[drawable];
+        member = state;
+        InsertMember(drawable, member);
+
+        drawable->StaticBatched = true;
+    }
+
+    void RemoveMember(Drawable3DComponent* drawable)
+    {
+        auto pending = std::find(Pending.begin(), Pending.end(), drawable);
+        if (pending != Pending.end())
+            Pending.erase(pending);
+
+        auto itr = Members.find(drawable);
+        if (itr == Members.end())
+            return;
+
+        ExtractMember(drawable, itr->second);
+        Members.erase(itr);
+
+        drawable->StaticBatched = false;
+    }
+
+    bool MemberChanged(const MemberState& baked, const MemberState& current)
+    {
+        return baked.Source != current.Source ||
+            baked.SourceVertices != current.SourceVertices ||
+            baked.SourceVao != current.SourceVao ||
+            baked.VertexCount != current.VertexCount ||
+            baked.SourceMaterial != current.SourceMaterial ||
+            baked.Pipeline != current.Pipeline ||
+            baked.MaterialId != current.MaterialId ||
+            memcmp(&baked.Tint, &current.Tint, sizeof(Color)) != 0 ||
+            memcmp(&baked.World, &current.World, sizeof(Matrix)) != 0;
+    }
+
+    // the normal matrix without the divide by the determinant, so flattened (zero scale) axes don't produce NaNs
+    Matrix GetNormalMatrix(const Matrix& model)
+    {
+        float a = model.m0, b = model.m4, c = model.m8;
+        float d = model.m1, e = model.m5, f = model.m9;
+        float g = model.m2, h = model.m6, i = model.m10;
+
+        Matrix normal = MatrixIdentity();
+        normal.m0 = e * i - f * h;
+        normal.m4 = f * g - d * i;
+        normal.m8 = d * h - e * g;
+        normal.m1 = c * h - b * i;
+        normal.m5 = a * i - c * g;
+        normal.m9 = b * g - a * h;
+        normal.m2 = b * f - c * e;
+        normal.m6 = c * d - a * f;
+        normal.m10 = a * e - b * d;
+
+        // mirrored transforms would turn the normals inside out
+        float determinant = a * normal.m0 + b * normal.m4 + c * normal.m8;
+        if (determinant < 0)
+            normal = MatrixMultiply(normal, MatrixScale(-1, -1, -1));
+
+        return normal;
+    }
+
+    void RebuildBatch(StaticBatch& batch)
+    {
+        if (batch.BatchMesh.vertices != nullptr)
+            UnloadMesh(batch.BatchMesh);
+
+        batch.BatchMesh = Mesh{ 0 };
+        batch.Dirty = false;
+        Rebuilds++;
+
+        if (batch.Members.empty())
+            return;
+
+        int vertexCount = 0;
+        int indexCount = 0;
+        for (Drawable3DComponent* drawable : batch.Members)
+        {
+            const Mesh& source = *Members[drawable].Source;
+            vertexCount += source.vertexCount;
+            indexCount += (source.indices != nullptr) ? source.triangleCount * 3 : source.vertexCount;
+        }
+
+        Mesh& mesh = batch.BatchMesh;
+        mesh.vertexCount = vertexCount;
+        mesh.triangleCount = indexCount / 3;
+        mesh.vertices = (float*)RL_MALLOC(vertexCount * 3 * sizeof(float));
+        mesh.normals = (float*)RL_MALLOC(vertexCount * 3 * sizeof(float));
+        mesh.texcoords = (float*)RL_MALLOC(vertexCount * 2 * sizeof(float));
+        mesh.colors = (unsigned char*)RL_MALLOC(vertexCount * 4 * sizeof(unsigned char));
+        mesh.indices = (unsigned short*)RL_MALLOC(indexCount * sizeof(unsigned short));
+
+        int vertex = 0;
+        int index = 0;
+        bool first = true;
+
+        for (Drawable3DComponent* drawable : batch.Members)
+        {
+            const MemberState& state = Members[drawable];
+            const Mesh& source = *state.Source;
+            Matrix normalMatrix = GetNormalMatrix(state.World);
+
+            for (int v = 0; v < source.vertexCount; v++)
+            {
+                Vector3 position = { source.vertices[v * 3 + 0], source.vertices[v * 3 + 1], source.vertices[v * 3 + 2] };
+                position = Vector3Transform(position, state.World);
+
+                mesh.vertices[(vertex + v) * 3 + 0] = position.x;
+                mesh.vertices[(vertex + v) * 3 + 1] = position.y;
+                mesh.vertices[(vertex + v) * 3 + 2] = position.z;
+
+                Vector3 normal = { 0, 1, 0 };
+                if (source.normals != nullptr)
+                    normal = Vector3Normalize(Vector3Transform(Vector3{ source.normals[v * 3 + 0], source.normals[v * 3 + 1], source.normals[v * 3 + 2] }, normalMatrix));
+
+                mesh.normals[(vertex + v) * 3 + 0] = normal.x;
+                mesh.normals[(vertex + v) * 3 + 1] = normal.y;
+                mesh.normals[(vertex + v) * 3 + 2] = normal.z;
+
+                mesh.texcoords[(vertex + v) * 2 + 0] = (source.texcoords != nullptr) ? source.texcoords[v * 2 + 0] : 0;
+                mesh.texcoords[(vertex + v) * 2 + 1] = (source.texcoords != nullptr) ? source.texcoords[v * 2 + 1] : 0;
+
+                // the tint is baked in, so members with different colors can share a batch
+                unsigned char* color = mesh.colors + (vertex + v) * 4;
+                color[0] = state.Tint.r;
+                color[1] = state.Tint.g;
+                color[2] = state.Tint.b;
+                color[3] = state.Tint.a;
+
+                if (source.colors != nullptr)
+                {
+                    for (int channel = 0; channel < 4; channel++)
+                        color[channel] = (unsigned char)((color[channel] * source.colors[v * 4 + channel]) / 255);
+                }
+            }
+
+            if (source.indices != nullptr)
+            {
+                for (int i = 0; i < source.triangleCount * 3; i++)
+                    mesh.indices[index++] = (unsigned short)(vertex + source.indices[i]);
+            }
+            else
+            {
+                for (int i = 0; i < source.vertexCount; i++)
+                    mesh.indices[index++] = (unsigned short)(vertex + i);
+            }
+
+            vertex += source.vertexCount;
+
+            const BoundingBox& bounds = drawable->GetWorldBounds();
+            batch.Bounds = first ? bounds : BoundingBoxUnion(batch.Bounds, bounds);
+
+            if (first)
+                batch.BatchMaterial = *state.SourceMaterial;
+            first = false;
+        }
+
+        UploadMesh(&mesh, false);
+    }
+
+    void OnStaticAdded(Component* component)
+    {
+        for (Component* drawable : ComponentManager::FindComponents(Drawable3DComponent::GetComponentId(), component->EntityId))
+            Pending.push_back(static_cast<Drawable3DComponent*>(drawable));
+    }
+
+    void OnStaticRemoved(Component* component)
+    {
+        for (Component* drawable : ComponentManager::FindComponents(Drawable3DComponent::GetComponentId(), component->EntityId))
+            RemoveMember(static_cast<Drawable3DComponent*>(drawable));
+    }
+
+    void OnDrawableAdded(Component* component)
+    {
+        if (ComponentManager::FindComponent(StaticBatchComponent::GetComponentId(), component->EntityId) != nullptr)
+            Pending.push_back(static_cast<Drawable3DComponent*>(component));
+    }
+
+    void OnDrawableRemoved(Component* component)
+    {
+        RemoveMember(static_cast<Drawable3DComponent*>(component));
+    }
+
+    void Setup()
+    {
+        ComponentManager::DoForEachEntity<StaticBatchComponent>([](StaticBatchComponent* component) { OnStaticAdded(component); });
+
+        ComponentManager::AddAddObserver<StaticBatchComponent>(OnStaticAdded);
+        ComponentManager::AddRemoveObserver<StaticBatchComponent>(OnStaticRemoved);
+        ComponentManager::AddAddObserver<Drawable3DComponent>(OnDrawableAdded);
+        ComponentManager::AddRemoveObserver<Drawable3DComponent>(OnDrawableRemoved);
+    }
+
+    void Update()
+    {
+        Rebuilds = 0;
+
+        for (Drawable3DComponent* drawable : Pending)
+        {
+            if (Members.find(drawable) == Members.end())
+                AddMember(drawable);
+        }
+        Pending.clear();
+
+        std::vector<Drawable3DComponent*> removed;
+
+        for (auto& entry : Members)
+        {
+            MemberState current;
+            if (!ReadMember(entry.first, current))
+            {
+                removed.push_back(entry.first);
+                continue;
+            }
+
+            MemberState& baked = entry.second;
+            if (!MemberChanged(baked, current))
+                continue;
+
+            // pull it out and put it back, it may need a different batch now
+            ExtractMember(entry.first, baked);
+            baked = current;
+            InsertMember(entry.first, baked);
+        }
+
+        // members that can no longer be baked go back to being drawn one at a time
+        for (Drawable3DComponent* drawable : removed)
+            RemoveMember(drawable);
+
+        for (StaticBatch& batch : Batches)
+        {
+            if (batch.Dirty)
+                RebuildBatch(batch);
+        }
+    }
+
+    void DrawBatch(const StaticBatch& batch)
+    {
+        if (batch.BatchMesh.vertices == nullptr || batch.BatchMaterial.maps == nullptr)
+            return;
+
+        // the members' colors are in the vertex colors, the white goes on a copy of the maps so drawables sharing the material keep theirs
+        Material material = batch.BatchMaterial;
+        MaterialMap maps[MAX_MATERIAL_MAPS];
+        memcpy(maps, material.maps, sizeof(maps));
+        maps[MAP_DIFFUSE].color = WHITE;
+        material.maps = maps;
+
+        RenderBackend::Get().DrawMesh(batch.BatchMesh, material, MatrixIdentity());
+    }
+
+    const std::vector<StaticBatch>& GetBatches()
+    {
+        return Batches;
+    }
+
+    size_t GetRebuildCount()
+    {
+        return Rebuilds;
+    }
+
+    void Shutdown()
+    {
+        for (StaticBatch& batch : Batches)
+        {
+            if (batch.BatchMesh.vertices != nullptr)
+                UnloadMesh(batch.BatchMesh);
+        }
+
+        Batches.clear();
+        Members.clear();
+        Pending.clear();
+    }
+}
@@ -0,0 +1,79 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "components.h"
+#include "render_queue.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <vector>
+
+class Drawable3DComponent;
+
+// merges the drawables of entities with a StaticBatchComponent into pre-transformed meshes, one set per pipeline and material
+// a batch is only rebuilt when one of its members moves or changes
+namespace StaticBatchSystem
+{
+    // batches use 16 bit indices
+    constexpr int MaxBatchVertices = 65535;
+
+    struct StaticBatch
+    {
+        RenderPipeline Pipeline = RenderPipeline::Opaque;
+        uint32_t MaterialId = 0;
+
+        std::vector<Drawable3DComponent*> Members;
+        int VertexCount = 0;
+
+        Mesh BatchMesh = { 0 };
+        BoundingBox Bounds = { 0 };
+
+        // borrowed from the first member, its diffuse color is baked into the vertex colors
+        Material BatchMaterial = { 0 };
+        bool Dirty = true;
+    };
+
+    void Setup();
+
+    // check members for changes and rebuild the batches they are in
+    void Update();
+
+    // draw one batch, the caller sets the pipeline state
+    void DrawBatch(const StaticBatch& batch);
+
+    const std::vector<StaticBatch>& GetBatches();
+
+    // batches rebuilt by the last update
+    size_t GetRebuildCount();
+
+    // unloads every batch mesh, call before closing the window
+    void Shutdown();
+}
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "components.h"
+#include "transform_hierarchy.h"
 
 #include "raylib.h"
 #include "raymath.h"
@@ -48,39 +49,94 @@ private:
     Matrix WorldMatrix = { 0 };
     Matrix GlWorldMatrix = { 0 };
 
+    // bumped every time the world matrix is recomputed, lets other systems cache data derived from it
+    uint32_t WorldVersion = 0;
+
 public:
     DEFINE_COMPONENT(TransformComponent);
 
-    TransformComponent* Parent = nullptr;
+    // index of this transform's links in the TransformHierarchy pool
+    int32_t HierarchyIndex = TransformHierarchy::InvalidNode;
+
+    void OnCreate() override
+    {
+        EnsureHierarchyNode();
+    }
+
+    void OnDestroy() override
+    {
+        TransformHierarchy::Free(HierarchyIndex);
+        HierarchyIndex = TransformHierarchy::InvalidNode;
+    }
+
+    int32_t EnsureHierarchyNode()
+    {
+        if (HierarchyIndex == TransformHierarchy::InvalidNode)
+            HierarchyIndex = TransformHierarchy::Allocate(this);
+
+        return HierarchyIndex;
+    }
+
+    TransformComponent* GetParent() const
+    {
+        if (HierarchyIndex == TransformHierarchy::InvalidNode)
+            return nullptr;
+
+        int32_t parent = TransformHierarchy::GetNode(HierarchyIndex).Parent;
+        if (parent == TransformHierarchy::InvalidNode)
+            return nullptr;
+
+        return TransformHierarchy::GetNode(parent).Transform;
+    }
+
+    bool HasChildren() const
+    {
+        return HierarchyIndex != TransformHierarchy::InvalidNode && TransformHierarchy::GetNode(HierarchyIndex).FirstChild != TransformHierarchy::InvalidNode;
+    }
 
-    std::vector<TransformComponent*> Children;
+    // direct children only
+    TransformHierarchy::ChildRange GetChildren() const
+    {
+        return TransformHierarchy::ChildRange(HierarchyIndex);
+    }
+
+    // this transform and everything below it, depth first
+    TransformHierarchy::SubtreeRange GetSubtree()
+    {
+        return TransformHierarchy::SubtreeRange(EnsureHierarchyNode());
+    }
 
     void AddChild(TransformComponent* child)
     {
-        Children.push_back(child);
-        child->Parent = this;
+        TransformHierarchy::Attach(EnsureHierarchyNode(), child->EnsureHierarchyNode());
+        child->SetDirty();
     }
 
     void SetDirty()
     {
-        Dirty = true;
-        for (TransformComponent* child : Children)
-            child->SetDirty();
+        if (HierarchyIndex == TransformHierarchy::InvalidNode)
+        {
+            Dirty = true;
+            return;
+        }
+
+        for (TransformComponent* transform : GetSubtree())
+            transform->Dirty = true;
     }
 
     void RemoveChild(TransformComponent* child)
     {
-        auto itr = std::find(Children.begin(), Children.end(), child);
-        if (itr != Children.end())
-            Children.erase(itr);
+        if (child->GetParent() != this)
+            return;
 
-        if (child->Parent == this)
-            child->Parent = nullptr;
+        TransformHierarchy::Detach(child->HierarchyIndex);
+        child->SetDirty();
     }
 
     void Detach()
     {
-        if (Parent == nullptr)
+        TransformComponent* parent = GetParent();
+        if (parent == nullptr)
             return;
 
         Matrix worldTransform = GetWorldMatrix();
@@ -92,7 +148,7 @@ public:
         Forward = Vector3Transform(Vector3{ 0 , 1 , 0 }, WorldMatrix);
         Up = Vector3Transform(Vector3{ 0, 0 , 1 }, WorldMatrix);
 
-        Parent->RemoveChild(this);
+        parent->RemoveChild(this);
     }
 
     const Vector3& GetPosition() const { return Position; }
@@ -119,13 +175,18 @@ public:
     // destroy this entity (and all other components) and all children
     void DestoryWithChilren()
     {
-        for (TransformComponent* child : Children)
+        int32_t child = HasChildren() ? TransformHierarchy::GetNode(HierarchyIndex).FirstChild : TransformHierarchy::InvalidNode;
+        while (child != TransformHierarchy::InvalidNode)
         {
-            child->DestoryWithChilren();
+            // grab the next link before the child detaches itself
+            int32_t next = TransformHierarchy::GetNode(child).NextSibling;
+            TransformHierarchy::GetNode(child).Transform->DestoryWithChilren();
+            child = next;
         }
 
-        if (Parent != nullptr)
-            Parent->RemoveChild(this);
+        TransformComponent* parent = GetParent();
+        if (parent != nullptr)
+            parent->RemoveChild(this);
 
         EntityManger::ReleaseEntity(EntityId);
     }
@@ -138,10 +199,20 @@ public:
         SetDirty();
     }
 
+    // set the whole local frame at once, used by systems that compute movement in bulk
+    void SetLocalFrame(const Vector3& position, const Vector3& forward, const Vector3& up)
+    {
+        Position = position;
+        Forward = forward;
+        Up = up;
+        SetDirty();
+    }
+
     bool IsDirty()
     {
-        if (Parent != nullptr)
-            return Parent->IsDirty() || Dirty;
+        TransformComponent* parent = GetParent();
+        if (parent != nullptr)
+            return parent->IsDirty() || Dirty;
 
         return Dirty;
     }
@@ -166,12 +237,14 @@ public:
     void UpdateWorldMatrix()
     {
         Matrix parentMatrix = MatrixIdentity();
-        if (Parent != nullptr)
-            parentMatrix = Parent->GetWorldMatrix();
+        TransformComponent* parent = GetParent();
+        if (parent != nullptr)
+            parentMatrix = parent->GetWorldMatrix();
 
         WorldMatrix = MatrixMultiply(GetLocalMatrix(), parentMatrix);
         GlWorldMatrix = MatrixTranspose(WorldMatrix);
 
+        WorldVersion++;
         Dirty = false;
     }
 
@@ -184,6 +257,8 @@ public:
         return WorldMatrix;
     }
 
+    uint32_t GetWorldVersion() const { return WorldVersion; }
+
     const Matrix& GetGLWorldMatrix()
     {
         if (!IsDirty())
@@ -0,0 +1,154 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "transform_hierarchy.h"
+#include "transform_component.h"
+
+namespace TransformHierarchy
+{
+    std::vector<Node> Nodes;
+
+    // free slots are chained through NextSibling
+    int32_t FreeHead = InvalidNode;
+
+    int32_t Allocate(TransformComponent* transform)
+    {
+        int32_t index = FreeHead;
+        if (index != InvalidNode)
+        {
+            FreeHead = Nodes[index].NextSibling;
+            Nodes[index] = Node();
+        }
+        else
+        {
+            index = int32_t(Nodes.size());
+            Nodes.emplace_back();
+        }
+
+        Nodes[index].Transform = transform;
+        return index;
+    }
+
+    void Free(int32_t index)
+    {
+        if (index == InvalidNode)
+            return;
+
+        Detach(index);
+
+        // orphan any children, they become roots
+        int32_t child = Nodes[index].FirstChild;
+        while (child != InvalidNode)
+        {
+            Node& childNode = Nodes[child];
+            int32_t next = childNode.NextSibling;
+
+            childNode.Parent = InvalidNode;
+            childNode.NextSibling = InvalidNode;
+            childNode.PrevSibling = InvalidNode;
+            child = next;
+        }
+
+        Nodes[index] = Node();
+        Nodes[index].NextSibling = FreeHead;
+        FreeHead = index;
+    }
+
+    void Attach(int32_t parent, int32_t child)
+    {
+        Detach(child);
+
+        Node& parentNode = Nodes[parent];
+        Node& childNode = Nodes[child];
+
+        childNode.Parent = parent;
+        childNode.NextSibling = parentNode.FirstChild;
+        if (parentNode.FirstChild != InvalidNode)
+            Nodes[parentNode.FirstChild].PrevSibling = child;
+
+        parentNode.FirstChild = child;
+    }
+
+    void Detach(int32_t child)
+    {
+        Node& childNode = Nodes[child];
+        if (childNode.Parent == InvalidNode)
+            return;
+
+        if (childNode.PrevSibling != InvalidNode)
+            Nodes[childNode.PrevSibling].NextSibling = childNode.NextSibling;
+        else
+            Nodes[childNode.Parent].FirstChild = childNode.NextSibling;
+
+        if (childNode.NextSibling != InvalidNode)
+            Nodes[childNode.NextSibling].PrevSibling = childNode.PrevSibling;
+
+        childNode.Parent = InvalidNode;
+        childNode.NextSibling = InvalidNode;
+        childNode.PrevSibling = InvalidNode;
+    }
+
+    void Compact()
+    {
+        std::vector<int32_t> remap(Nodes.size(), InvalidNode);
+        std::vector<int32_t> order;
+        order.reserve(Nodes.size());
+
+        for (int32_t root = 0; root < int32_t(Nodes.size()); root++)
+        {
+            if (Nodes[root].Transform == nullptr || Nodes[root].Parent != InvalidNode)
+                continue;
+
+            for (int32_t node = root; node != InvalidNode; node = NextInSubtree(node, root))
+            {
+                remap[node] = int32_t(order.size());
+                order.push_back(node);
+            }
+        }
+
+        auto map = [&remap](int32_t index) { return index == InvalidNode ? InvalidNode : remap[index]; };
+
+        std::vector<Node> compacted(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const Node& node = Nodes[order[i]];
+            Node& newNode = compacted[i];
+
+            newNode.Transform = node.Transform;
+            newNode.Parent = map(node.Parent);
+            newNode.FirstChild = map(node.FirstChild);
+            newNode.NextSibling = map(node.NextSibling);
+            newNode.PrevSibling = map(node.PrevSibling);
+
+            newNode.Transform->HierarchyIndex = int32_t(i);
+        }
+
+        Nodes.swap(compacted);
+        FreeHead = InvalidNode;
+    }
+}
@@ -0,0 +1,139 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class TransformComponent;
+
+// parent, first child and sibling links for every transform, stored as indices in one flat pool
+// attaching and detaching are O(1) and never allocate
+namespace TransformHierarchy
+{
+    constexpr int32_t InvalidNode = -1;
+
+    struct Node
+    {
+        TransformComponent* Transform = nullptr;
+
+        int32_t Parent = InvalidNode;
+        int32_t FirstChild = InvalidNode;
+        int32_t NextSibling = InvalidNode;
+        int32_t PrevSibling = InvalidNode;
+    };
+
+    extern std::vector<Node> Nodes;
+
+    int32_t Allocate(TransformComponent* transform);
+    void Free(int32_t index);
+
+    // links child as the first child of parent, removing it from any previous parent
+    void Attach(int32_t parent, int32_t child);
+    void Detach(int32_t child);
+
+    /// <summary>
+    /// Reorder the pool depth first and drop free slots, after this every subtree walk reads memory in order.
+    /// Any stored node indices are invalidated, transforms are updated with their new index.
+    /// </summary>
+    void Compact();
+
+    inline Node& GetNode(int32_t index) { return Nodes[index]; }
+
+    // next node in a depth first walk of the subtree under root, or InvalidNode when done
+    inline int32_t NextInSubtree(int32_t current, int32_t root)
+    {
+        if (Nodes[current].FirstChild != InvalidNode)
+            return Nodes[current].FirstChild;
+
+        while (current != root)
+        {
+            const Node& node = Nodes[current];
+            if (node.NextSibling != InvalidNode)
+                return node.NextSibling;
+
+            current = node.Parent;
+        }
+
+        return InvalidNode;
+    }
+
+    class SubtreeIterator
+    {
+    public:
+        SubtreeIterator(int32_t current, int32_t root) : Current(current), Root(root) {}
+
+        TransformComponent* operator*() const { return Nodes[Current].Transform; }
+        bool operator!=(const SubtreeIterator& other) const { return Current != other.Current; }
+        SubtreeIterator& operator++() { Current = NextInSubtree(Current, Root); return *this; }
+
+    private:
+        int32_t Current;
+        int32_t Root;
+    };
+
+    // a node and everything below it, depth first
+    class SubtreeRange
+    {
+    public:
+        SubtreeRange(int32_t root) : Root(root) {}
+
+        SubtreeIterator begin() const { return SubtreeIterator(Root, Root); }
+        SubtreeIterator end() const { return SubtreeIterator(InvalidNode, Root); }
+
+    private:
+        int32_t Root;
+    };
+
+    class ChildIterator
+    {
+    public:
+        ChildIterator(int32_t current) : Current(current) {}
+
+        TransformComponent* operator*() const { return Nodes[Current].Transform; }
+        bool operator!=(const ChildIterator& other) const { return Current != other.Current; }
+        ChildIterator& operator++() { Current = Nodes[Current].NextSibling; return *this; }
+
+    private:
+        int32_t Current;
+    };
+
+    // the direct children of a node
+    class ChildRange
+    {
+    public:
+        ChildRange(int32_t parent) : Parent(parent) {}
+
+        ChildIterator begin() const { return ChildIterator(Parent == InvalidNode ? InvalidNode : Nodes[Parent].FirstChild); }
+        ChildIterator end() const { return ChildIterator(InvalidNode); }
+
+    private:
+        int32_t Parent;
+    };
+}
@@ -0,0 +1,251 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "visibility_system.h"
+#include "job_system.h"
+#include "render_commands.h"
+#include "render_system.h"
+#include "render_backend.h"
+
+#include "camera_component.h"
+#include "drawable_component.h"
+
+#include "rlgl.h"
+
+#include <map>
+#include <xmmintrin.h>
+
+namespace VisibilitySystem
+{
+    std::vector<CameraView> Views;
+    std::map<uint64_t, float> ViewAspects;
+
+    // the planes of one group of cameras, structure of arrays and padded to a multiple of 4 with planes nothing is outside of
+    struct PlaneGroup
+    {
+        size_t FirstView = 0;
+        size_t ViewCount = 0;
+        size_t PlaneCount = 0;
+
+        alignas(16) float X[CamerasPerGroup * 6 + 4];
+        alignas(16) float Y[CamerasPerGroup * 6 + 4];
+        alignas(16) float Z[CamerasPerGroup * 6 + 4];
+        alignas(16) float W[CamerasPerGroup * 6 + 4];
+    };
+    std::vector<PlaneGroup> Groups;
+
+    // [thread][view] so extraction threads never share a list
+    std::vector<std::vector<std::vector<Drawable3DComponent*>>> ThreadVisible;
+    std::vector<std::vector<size_t>> ThreadCulled;
+
+    constexpr size_t VisibilityGrain = 512;
+
+    void OnDrawableRemoved(Component*)
+    {
+        // the lists would hold a dangling pointer
+        Views.clear();
+    }
+
+    void Setup()
+    {
+        Views.clear();
+        ComponentManager::AddRemoveObserver<Drawable3DComponent>(OnDrawableRemoved);
+    }
+
+    void SetViewAspect(uint64_t cameraEntity, float aspect)
+    {
+        ViewAspects[cameraEntity] = aspect;
+    }
+
+    void BuildViews()
+    {
+        float screenAspect = float(RenderBackend::Get().GetViewportWidth()) / float(RenderBackend::Get().GetViewportHeight());
+
+        Views.clear();
+        ComponentManager::DoForEachEntity<CameraComponent>([screenAspect](CameraComponent* camera)
+            {
+                if (!camera->Active)
+                    return;
+
+                CameraView view;
+                view.CameraEntity = camera->EntityId;
+                view.Camera = RenderSystem::GetCameraView(camera->EntityId);
+
+                auto aspect = ViewAspects.find(camera->EntityId);
+                view.Aspect = (aspect != ViewAspects.end()) ? aspect->second : screenAspect;
+                view.ViewFrustum = FrustumFromCamera(view.Camera, view.Aspect, float(RL_CULL_DISTANCE_NEAR), float(RL_CULL_DISTANCE_FAR));
+
+                Views.push_back(view);
+            });
+
+        Groups.clear();
+        for (size_t first = 0; first < Views.size(); first += CamerasPerGroup)
+        {
+            PlaneGroup group;
+            group.FirstView = first;
+            group.ViewCount = std::min(CamerasPerGroup, Views.size() - first);
+            group.PlaneCount = group.ViewCount * 6;
+
+            for (size_t v = 0; v < group.ViewCount; v++)
+            {
+                for (size_t p = 0; p < 6; p++)
+                {
+                    const Vector4& plane = Views[first + v].ViewFrustum.Planes[p];
+                    group.X[v * 6 + p] = plane.x;
+                    group.Y[v * 6 + p] = plane.y;
+                    group.Z[v * 6 + p] = plane.z;
+                    group.W[v * 6 + p] = plane.w;
+                }
+            }
+
+            // padding planes have no normal and a positive distance, so every box is inside them
+            while (group.PlaneCount % 4 != 0)
+            {
+                group.X[group.PlaneCount] = group.Y[group.PlaneCount] = group.Z[group.PlaneCount] = 0;
+                group.W[group.PlaneCount] = 1;
+                group.PlaneCount++;
+            }
+
+            Groups.push_back(group);
+        }
+    }
+
+    // one bit per plane the box is completely outside of
+    inline uint64_t ClassifyBox(const PlaneGroup& group, __m128 centerX, __m128 centerY, __m128 centerZ, __m128 extentX, __m128 extentY, __m128 extentZ)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        uint64_t outside = 0;
+        for (size_t p = 0; p < group.PlaneCount; p += 4)
+        {
+            __m128 x = _mm_load_ps(group.X + p);
+            __m128 y = _mm_load_ps(group.Y + p);
+            __m128 z = _mm_load_ps(group.Z + p);
+            __m128 w = _mm_load_ps(group.W + p);
+
+            // distance of the corner furthest along each normal: n.c + |n|.e + w
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, centerX), _mm_mul_ps(y, centerY)), _mm_add_ps(_mm_mul_ps(z, centerZ), w));
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, x), extentX), _mm_mul_ps(_mm_andnot_ps(signMask, y), extentY)), _mm_mul_ps(_mm_andnot_ps(signMask, z), extentZ));
+
+            outside |= uint64_t(_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, reach), zero))) << p;
+        }
+
+        return outside;
+    }
+
+    void Classify(Drawable3DComponent* const* drawables, size_t count, size_t threadIndex)
+    {
+        std::vector<std::vector<Drawable3DComponent*>>& visible = ThreadVisible[threadIndex];
+        std::vector<size_t>& culled = ThreadCulled[threadIndex];
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Drawable3DComponent* drawable = drawables[i];
+            if (!drawable->Active || drawable->StaticBatched)
+                continue;
+
+            // one bounds fetch shared by every camera
+            const BoundingBox& bounds = drawable->GetWorldBounds();
+            __m128 centerX = _mm_set1_ps((bounds.min.x + bounds.max.x) * 0.5f);
+            __m128 centerY = _mm_set1_ps((bounds.min.y + bounds.max.y) * 0.5f);
+            __m128 centerZ = _mm_set1_ps((bounds.min.z + bounds.max.z) * 0.5f);
+            __m128 extentX = _mm_set1_ps((bounds.max.x - bounds.min.x) * 0.5f);
+            __m128 extentY = _mm_set1_ps((bounds.max.y - bounds.min.y) * 0.5f);
+            __m128 extentZ = _mm_set1_ps((bounds.max.z - bounds.min.z) * 0.5f);
+
+            for (const PlaneGroup& group : Groups)
+            {
+                uint64_t outside = ClassifyBox(group, centerX, centerY, centerZ, extentX, extentY, extentZ);
+
+                for (size_t v = 0; v < group.ViewCount; v++)
+                {
+                    if (((outside >> (v * 6)) & 0x3F) == 0)
+                        visible[group.FirstView + v].push_back(drawable);
+                    else
+                        culled[group.FirstView + v]++;
+                }
+            }
+        }
+    }
+
+    void Update()
+    {
+        // bounds depend on world matrices, bring them all up to date before the threads read them
+        RenderCommands::UpdateTransforms();
+
+        BuildViews();
+
+        size_t threads = JobSystem::GetThreadCount();
+        ThreadVisible.resize(threads);
+        ThreadCulled.resize(threads);
+        for (size_t t = 0; t < threads; t++)
+        {
+            ThreadVisible[t].resize(Views.size());
+            for (std::vector<Drawable3DComponent*>& list : ThreadVisible[t])
+                list.clear();
+
+            ThreadCulled[t].assign(Views.size(), 0);
+        }
+
+        if (Views.empty())
+            return;
+
+        const std::vector<Drawable3DComponent*>& drawables = RenderSystem::GetDrawables();
+        JobSystem::ParallelFor(drawables.size(), VisibilityGrain, [&drawables](size_t begin, size_t end, size_t threadIndex)
+            {
+                Classify(drawables.data() + begin, end - begin, threadIndex);
+            });
+
+        for (size_t v = 0; v < Views.size(); v++)
+        {
+            CameraView& view = Views[v];
+            for (size_t t = 0; t < threads; t++)
+            {
+                view.Visible.insert(view.Visible.end(), ThreadVisible[t][v].begin(), ThreadVisible[t][v].end());
+                view.Culled += ThreadCulled[t][v];
+            }
+        }
+    }
+
+    const std::vector<CameraView>& GetViews()
+    {
+        return Views;
+    }
+
+    const CameraView* FindView(uint64_t cameraEntity)
+    {
+        for (const CameraView& view : Views)
+        {
+            if (view.CameraEntity == cameraEntity)
+                return &view;
+        }
+
+        return nullptr;
+    }
+}
@@ -0,0 +1,73 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "entity.h"
+#include "components.h"
+#include "bounds.h"
+
+#include "raylib.h"
+
+#include <stddef.h>
+#include <vector>
+
+class Drawable3DComponent;
+
+// classifies every drawable against the frusta of all active cameras in one pass
+// bounds are fetched once per drawable and tested against up to 10 cameras' planes at a time, four planes per SIMD op
+namespace VisibilitySystem
+{
+    // 6 planes each, so a group of cameras fits in one 64 bit outside mask
+    constexpr size_t CamerasPerGroup = 10;
+
+    struct CameraView
+    {
+        uint64_t CameraEntity = 0;
+        Camera3D Camera = { 0 };
+        float Aspect = 1;
+        Frustum ViewFrustum = { 0 };
+
+        std::vector<Drawable3DComponent*> Visible;
+        size_t Culled = 0;
+    };
+
+    void Setup();
+
+    // cameras default to the window's aspect ratio, set it for views drawn to a differently shaped target
+    void SetViewAspect(uint64_t cameraEntity, float aspect);
+
+    // call once per frame before drawing, after anything that moves cameras or drawables
+    // the RenderSystem draws from these lists instead of culling again, removing a drawable drops them until the next update
+    void Update();
+
+    const std::vector<CameraView>& GetViews();
+
+    // the view computed for a camera by the last Update, or nullptr
+    const CameraView* FindView(uint64_t cameraEntity);
+}
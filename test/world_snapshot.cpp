@@ -0,0 +1,655 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#include "world_snapshot.h"
+
+#include "automover_component.h"
+#include "camera_component.h"
+#include "color_component.h"
+#include "drawable_component.h"
+#include "flight_data_component.h"
+#include "look_at_component.h"
+#include "occluder_component.h"
+#include "static_batch_component.h"
+#include "transform_component.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+
+namespace WorldSnapshot
+{
+    // blocks start on this boundary so records can be read in place
+    constexpr uint64_t BlockAlignment = 16;
+
+    const char FileMagic[4] = { 'R', 'W', 'L', 'D' };
+
+    // fixed size fields only, everything in the file is written and read as raw bytes
+    struct FileHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t BlockCount;
+        uint32_t EntityCount;
+    };
+
+    struct BlockEntry
+    {
+        uint32_t Type;
+        uint32_t RecordSize;
+        uint64_t Count;
+        uint64_t Offset;
+    };
+
+    // entity fields are indices into the entity block, -1 when there is no entity
+    struct TransformRecord
+    {
+        uint32_t Entity;
+        int32_t Parent;
+
+        // kept for parents outside the snapshot, uint64_t(-1) when there is no parent
+        uint64_t ParentId;
+
+        Vector3 Position;
+        Vector3 Forward;
+        Vector3 Up;
+    };
+
+    struct ColorRecord
+    {
+        uint32_t Entity;
+        Color Value;
+    };
+
+    struct ShapeRecord
+    {
+        uint32_t Entity;
+        uint32_t Shape;
+        Vector3 Size;
+        Vector3 Offset;
+        Vector3 Rotation;
+    };
+
+    struct AutoMoverRecord
+    {
+        uint32_t Entity;
+        uint32_t UseHeading;
+        Vector3 LinearSpeed;
+        Vector3 AngularSpeed;
+    };
+
+    struct LookAtRecord
+    {
+        uint32_t Entity;
+        int32_t Target;
+
+        // kept for targets outside the snapshot
+        uint64_t TargetId;
+    };
+
+    struct CameraRecord
+    {
+        uint32_t Entity;
+        float FOVY;
+    };
+
+    struct FlightDataRecord
+    {
+        uint32_t Entity;
+        float Speed;
+        float RotationSpeed;
+        uint8_t UseMouseButton;
+        uint8_t UseHeading;
+        uint8_t Padding[2];
+    };
+
+    // components with no data of their own
+    struct MarkerRecord
+    {
+        uint32_t Entity;
+    };
+
+    // the record size each block type must have, 0 for stages without a block of their own
+    const uint32_t RecordSizes[] =
+    {
+        sizeof(uint64_t),
+        sizeof(TransformRecord),
+        0,
+        sizeof(ColorRecord),
+        sizeof(ShapeRecord),
+        sizeof(AutoMoverRecord),
+        sizeof(LookAtRecord),
+        sizeof(CameraRecord),
+        sizeof(FlightDataRecord),
+        sizeof(MarkerRecord),
+        sizeof(MarkerRecord),
+    };
+
+    struct PendingBlock
+    {
+        uint32_t Type = 0;
+        uint32_t RecordSize = 0;
+        const void* Data = nullptr;
+        uint64_t Count = 0;
+    };
+
+    // calls func with every component of a type, on the listed entities or everywhere
+    template<class T>
+    void ForEachComponent(const std::vector<uint64_t>* entities, std::function<void(T*)> func)
+    {
+        if (entities == nullptr)
+        {
+            ComponentManager::DoForEachEntity<T>(func);
+            return;
+        }
+
+        for (uint64_t entity : *entities)
+        {
+            for (Component* component : ComponentManager::FindComponents(T::GetComponentId(), entity))
+                func(static_cast<T*>(component));
+        }
+    }
+
+    bool WriteBlocks(const char* fileName, const std::vector<PendingBlock>& blocks, uint32_t entityCount, size_t& bytes)
+    {
+        FileHeader header = { { 0 }, Version, uint32_t(blocks.size()), entityCount };
+        memcpy(header.Magic, FileMagic, sizeof(FileMagic));
+
+        std::vector<BlockEntry> entries(blocks.size());
+
+        uint64_t offset = (sizeof(FileHeader) + sizeof(BlockEntry) * blocks.size() + BlockAlignment - 1) & ~(BlockAlignment - 1);
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            entries[i].Type = blocks[i].Type;
+            entries[i].RecordSize = blocks[i].RecordSize;
+            entries[i].Count = blocks[i].Count;
+            entries[i].Offset = offset;
+            offset = (offset + blocks[i].Count * blocks[i].RecordSize + BlockAlignment - 1) & ~(BlockAlignment - 1);
+        }
+
+        // write to the side and swap it in, so a reader never maps a half written file
+        std::string tempName = std::string(fileName) + ".tmp";
+        FILE* file = fopen(tempName.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+        written = written && fwrite(entries.data(), sizeof(BlockEntry), entries.size(), file) == entries.size();
+
+        static const uint8_t padding[BlockAlignment] = { 0 };
+        uint64_t position = sizeof(header) + sizeof(BlockEntry) * entries.size();
+        for (size_t i = 0; i < blocks.size() && written; i++)
+        {
+            size_t size = size_t(blocks[i].Count * blocks[i].RecordSize);
+
+            written = fwrite(padding, 1, size_t(entries[i].Offset - position), file) == size_t(entries[i].Offset - position);
+            written = written && fwrite(blocks[i].Data, 1, size, file) == size;
+            position = entries[i].Offset + size;
+        }
+
+        written = fclose(file) == 0 && written;
+
+        remove(fileName);
+        if (!written || rename(tempName.c_str(), fileName) != 0)
+        {
+            remove(tempName.c_str());
+            return false;
+        }
+
+        bytes = size_t(position);
+        return true;
+    }
+
+    template<class R>
+    void AddBlock(std::vector<PendingBlock>& blocks, uint32_t type, const std::vector<R>& records)
+    {
+        if (records.empty())
+            return;
+
+        PendingBlock block;
+        block.Type = type;
+        block.RecordSize = sizeof(R);
+        block.Data = records.data();
+        block.Count = records.size();
+        blocks.push_back(block);
+    }
+
+    bool Save(const char* fileName, const std::vector<uint64_t>* only, Stats* stats)
+    {
+        std::vector<uint64_t> entities;
+        std::unordered_map<uint64_t, uint32_t> indices;
+
+        auto addEntity = [&entities, &indices](uint64_t id)
+        {
+            if (indices.emplace(id, uint32_t(entities.size())).second)
+                entities.push_back(id);
+        };
+
+        if (only != nullptr)
+        {
+            indices.reserve(only->size());
+            for (uint64_t id : *only)
+                addEntity(id);
+        }
+        else
+        {
+            // every entity with something to save, transforms first since nearly everything has one
+            auto collect = [&addEntity](Component* component) { addEntity(component->EntityId); };
+            ComponentManager::DoForEachEntity(TransformComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(ColorComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(Drawable3DComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(AutoMoverComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(LookAtComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(CameraComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(FlightDataComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(OccluderComponent::GetComponentId(), collect);
+            ComponentManager::DoForEachEntity(StaticBatchComponent::GetComponentId(), collect);
+        }
+
+        auto indexOf = [&indices](uint64_t id) -> int32_t
+        {
+            auto itr = indices.find(id);
+            return (itr != indices.end()) ? int32_t(itr->second) : -1;
+        };
+
+        std::vector<TransformRecord> transforms;
+        ForEachComponent<TransformComponent>(only, [&](TransformComponent* transform)
+            {
+                TransformComponent* parent = transform->GetParent();
+                transforms.push_back(TransformRecord{ uint32_t(indexOf(transform->EntityId)), (parent != nullptr) ? indexOf(parent->EntityId) : -1,
+                    (parent != nullptr) ? parent->EntityId : uint64_t(-1), transform->GetPosition(), transform->GetForwardVector(), transform->GetUpVector() });
+            });
+
+        std::vector<ColorRecord> colors;
+        ForEachComponent<ColorComponent>(only, [&](ColorComponent* color)
+            {
+                colors.push_back(ColorRecord{ uint32_t(indexOf(color->EntityId)), color->GetColor() });
+            });
+
+        // drawables share one table, only the shapes are plain data
+        std::vector<ShapeRecord> shapes;
+        ForEachComponent<Drawable3DComponent>(only, [&](Drawable3DComponent* drawable)
+            {
+                ShapeComponent* shape = dynamic_cast<ShapeComponent*>(drawable);
+                if (shape != nullptr)
+                    shapes.push_back(ShapeRecord{ uint32_t(indexOf(shape->EntityId)), uint32_t(shape->ObjectShape), shape->ObjectSize, shape->Offset.GetOffset(), shape->Offset.GetRotation() });
+            });
+
+        std::vector<AutoMoverRecord> movers;
+        ForEachComponent<AutoMoverComponent>(only, [&](AutoMoverComponent* mover)
+            {
+                movers.push_back(AutoMoverRecord{ uint32_t(indexOf(mover->EntityId)), mover->UseHeading ? 1u : 0u, mover->LinearSpeed, mover->AngularSpeed });
+            });
+
+        std::vector<LookAtRecord> lookAts;
+        ForEachComponent<LookAtComponent>(only, [&](LookAtComponent* lookAt)
+            {
+                lookAts.push_back(LookAtRecord{ uint32_t(indexOf(lookAt->EntityId)), indexOf(lookAt->TargetEntityId), lookAt->TargetEntityId });
+            });
+
+        std::vector<CameraRecord> cameras;
+        ForEachComponent<CameraComponent>(only, [&](CameraComponent* camera)
+            {
+                cameras.push_back(CameraRecord{ uint32_t(indexOf(camera->EntityId)), camera->FOVY });
+            });
+
+        std::vector<FlightDataRecord> flightData;
+        ForEachComponent<FlightDataComponent>(only, [&](FlightDataComponent* flight)
+            {
+                flightData.push_back(FlightDataRecord{ uint32_t(indexOf(flight->EntityId)), flight->Speed, flight->RotationSpeed, uint8_t(flight->UseMouseButton), uint8_t(flight->UseHeading), { 0, 0 } });
+            });
+
+        std::vector<MarkerRecord> occluders;
+        ForEachComponent<OccluderComponent>(only, [&](OccluderComponent* occluder)
+            {
+                occluders.push_back(MarkerRecord{ uint32_t(indexOf(occluder->EntityId)) });
+            });
+
+        std::vector<MarkerRecord> staticBatches;
+        ForEachComponent<StaticBatchComponent>(only, [&](StaticBatchComponent* batch)
+            {
+                staticBatches.push_back(MarkerRecord{ uint32_t(indexOf(batch->EntityId)) });
+            });
+
+        std::vector<PendingBlock> blocks;
+        AddBlock(blocks, EntityStage, entities);
+        AddBlock(blocks, TransformStage, transforms);
+        AddBlock(blocks, ColorStage, colors);
+        AddBlock(blocks, ShapeStage, shapes);
+        AddBlock(blocks, AutoMoverStage, movers);
+        AddBlock(blocks, LookAtStage, lookAts);
+        AddBlock(blocks, CameraStage, cameras);
+        AddBlock(blocks, FlightDataStage, flightData);
+        AddBlock(blocks, OccluderStage, occluders);
+        AddBlock(blocks, StaticBatchStage, staticBatches);
+
+        size_t bytes = 0;
+        if (!WriteBlocks(fileName, blocks, uint32_t(entities.size()), bytes))
+            return false;
+
+        if (stats != nullptr)
+        {
+            stats->Entities = entities.size();
+            stats->Components = transforms.size() + colors.size() + shapes.size() + movers.size() + lookAts.size() + cameras.size() + flightData.size() + occluders.size() + staticBatches.size();
+            stats->Bytes = bytes;
+        }
+
+        return true;
+    }
+
+    bool Save(const char* fileName, Stats* stats)
+    {
+        return Save(fileName, nullptr, stats);
+    }
+
+    bool Save(const char* fileName, const std::vector<uint64_t>& entities, Stats* stats)
+    {
+        return Save(fileName, &entities, stats);
+    }
+
+    bool Loader::Open(const char* fileName)
+    {
+        Close();
+
+        if (!File.Open(fileName) || File.GetSize() < sizeof(FileHeader))
+        {
+            Close();
+            return false;
+        }
+
+        FileHeader header;
+        memcpy(&header, File.GetData(), sizeof(header));
+
+        if (memcmp(header.Magic, FileMagic, sizeof(FileMagic)) != 0 || header.Version != Version ||
+            sizeof(FileHeader) + uint64_t(header.BlockCount) * sizeof(BlockEntry) > File.GetSize())
+        {
+            Close();
+            return false;
+        }
+
+        const BlockEntry* entries = reinterpret_cast<const BlockEntry*>(File.GetData() + sizeof(FileHeader));
+        for (uint32_t i = 0; i < header.BlockCount; i++)
+        {
+            BlockEntry entry;
+            memcpy(&entry, entries + i, sizeof(entry));
+
+            // every block has to be a known type with the record layout this build writes, and fit in the file
+            bool valid = entry.Type < StageCount && RecordSizes[entry.Type] != 0 && entry.RecordSize == RecordSizes[entry.Type] &&
+                entry.Offset % BlockAlignment == 0 && entry.Offset <= File.GetSize() &&
+                entry.Count <= (File.GetSize() - entry.Offset) / entry.RecordSize;
+
+            if (!valid)
+            {
+                Close();
+                return false;
+            }
+
+            Blocks[entry.Type] = File.GetData() + entry.Offset;
+            Counts[entry.Type] = size_t(entry.Count);
+        }
+
+        if (Counts[EntityStage] != header.EntityCount)
+        {
+            Close();
+            return false;
+        }
+
+        // the links are made in a second pass over the transforms, once every parent exists
+        Blocks[HierarchyStage] = Blocks[TransformStage];
+        Counts[HierarchyStage] = Counts[TransformStage];
+
+        Stage = EntityStage;
+        Cursor = 0;
+        EntityIds.clear();
+        EntityIds.reserve(Counts[EntityStage]);
+        LoadStats = Stats();
+        LoadStats.Bytes = File.GetSize();
+
+        return true;
+    }
+
+    void Loader::Close()
+    {
+        File.Close();
+
+        for (int stage = 0; stage < StageCount; stage++)
+        {
+            Blocks[stage] = nullptr;
+            Counts[stage] = 0;
+        }
+
+        Stage = StageCount;
+        Cursor = 0;
+    }
+
+    size_t Loader::GetEntityCount() const
+    {
+        return Counts[EntityStage];
+    }
+
+    size_t Loader::GetRemainingRecords() const
+    {
+        size_t remaining = 0;
+        for (int stage = Stage; stage < StageCount; stage++)
+            remaining += Counts[stage];
+
+        return remaining - ((Stage < StageCount) ? Cursor : 0);
+    }
+
+    uint64_t Loader::MapEntity(int32_t index, uint64_t fallback) const
+    {
+        if (index < 0 || size_t(index) >= EntityIds.size())
+            return fallback;
+
+        return EntityIds[index];
+    }
+
+    template<class R>
+    inline const R* GetRecords(const uint8_t* block)
+    {
+        return reinterpret_cast<const R*>(block);
+    }
+
+    void Loader::RunStage(size_t first, size_t count)
+    {
+        const uint8_t* block = Blocks[Stage];
+        size_t entityCount = Counts[EntityStage];
+
+        for (size_t i = first; i < first + count; i++)
+        {
+            switch (Stage)
+            {
+            case EntityStage:
+                EntityIds.push_back(EntityManger::CreateEntity());
+                LoadStats.Entities++;
+                continue;
+
+            case TransformStage:
+            {
+                const TransformRecord& record = GetRecords<TransformRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                TransformComponent* transform = ComponentManager::AddComponent<TransformComponent>(EntityIds[record.Entity]);
+                transform->SetLocalFrame(record.Position, record.Forward, record.Up);
+                break;
+            }
+
+            case HierarchyStage:
+            {
+                const TransformRecord& record = GetRecords<TransformRecord>(block)[i];
+                uint64_t parentId = MapEntity(record.Parent, record.ParentId);
+                if (record.Entity >= entityCount || parentId == uint64_t(-1))
+                    continue;
+
+                // a parent outside the snapshot is only linked while it still exists
+                TransformComponent* parent = ComponentManager::GetComponent<TransformComponent>(parentId);
+                TransformComponent* child = ComponentManager::GetComponent<TransformComponent>(EntityIds[record.Entity]);
+                if (parent != nullptr && child != nullptr)
+                    parent->AddChild(child);
+
+                // links are not components
+                continue;
+            }
+
+            case ColorStage:
+            {
+                const ColorRecord& record = GetRecords<ColorRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                ComponentManager::MustGetComponent<ColorComponent>(EntityIds[record.Entity])->SetColor(record.Value);
+                break;
+            }
+
+            case ShapeStage:
+            {
+                const ShapeRecord& record = GetRecords<ShapeRecord>(block)[i];
+                if (record.Entity >= entityCount || record.Shape > uint32_t(DrawShape::Plane))
+                    continue;
+
+                ShapeComponent* shape = ComponentManager::AddComponent<ShapeComponent>(EntityIds[record.Entity]);
+                shape->ObjectShape = DrawShape(record.Shape);
+                shape->ObjectSize = record.Size;
+                shape->Offset.SetOffset(record.Offset.x, record.Offset.y, record.Offset.z);
+                shape->Offset.SetRotation(record.Rotation.x, record.Rotation.y, record.Rotation.z);
+                break;
+            }
+
+            case AutoMoverStage:
+            {
+                const AutoMoverRecord& record = GetRecords<AutoMoverRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                AutoMoverComponent* mover = ComponentManager::AddComponent<AutoMoverComponent>(EntityIds[record.Entity]);
+                mover->UseHeading = record.UseHeading != 0;
+                mover->LinearSpeed = record.LinearSpeed;
+                mover->AngularSpeed = record.AngularSpeed;
+                break;
+            }
+
+            case LookAtStage:
+            {
+                const LookAtRecord& record = GetRecords<LookAtRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                ComponentManager::AddComponent<LookAtComponent>(EntityIds[record.Entity])->TargetEntityId = MapEntity(record.Target, record.TargetId);
+                break;
+            }
+
+            case CameraStage:
+            {
+                const CameraRecord& record = GetRecords<CameraRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                ComponentManager::AddComponent<CameraComponent>(EntityIds[record.Entity])->FOVY = record.FOVY;
+                break;
+            }
+
+            case FlightDataStage:
+            {
+                const FlightDataRecord& record = GetRecords<FlightDataRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                FlightDataComponent* flight = ComponentManager::AddComponent<FlightDataComponent>(EntityIds[record.Entity]);
+                flight->Speed = record.Speed;
+                flight->RotationSpeed = record.RotationSpeed;
+                flight->UseMouseButton = record.UseMouseButton != 0;
+                flight->UseHeading = record.UseHeading != 0;
+                break;
+            }
+
+            case OccluderStage:
+            {
+                const MarkerRecord& record = GetRecords<MarkerRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                ComponentManager::AddComponent<OccluderComponent>(EntityIds[record.Entity]);
+                break;
+            }
+
+            case StaticBatchStage:
+            {
+                const MarkerRecord& record = GetRecords<MarkerRecord>(block)[i];
+                if (record.Entity >= entityCount)
+                    continue;
+
+                ComponentManager::AddComponent<StaticBatchComponent>(EntityIds[record.Entity]);
+                break;
+            }
+            }
+
+            LoadStats.Components++;
+        }
+    }
+
+    bool Loader::Instantiate(size_t maxRecords)
+    {
+        while (Stage < StageCount && maxRecords > 0)
+        {
+            size_t remaining = Counts[Stage] - Cursor;
+            size_t count = (remaining < maxRecords) ? remaining : maxRecords;
+
+            RunStage(Cursor, count);
+
+            Cursor += count;
+            maxRecords -= count;
+
+            if (Cursor >= Counts[Stage])
+            {
+                Stage++;
+                Cursor = 0;
+            }
+        }
+
+        return IsDone();
+    }
+
+    bool Load(const char* fileName, Stats* stats, std::vector<uint64_t>* entityIds)
+    {
+        Loader loader;
+        if (!loader.Open(fileName))
+            return false;
+
+        loader.Instantiate();
+
+        if (stats != nullptr)
+            *stats = loader.GetStats();
+
+        if (entityIds != nullptr)
+            *entityIds = loader.GetEntityIds();
+
+        return true;
+    }
+}
@@ -0,0 +1,118 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+#pragma once
+
+#include "mapped_file.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// saves the components of a world into one versioned binary file and loads them back
+// every component type is one contiguous block of fixed size records, entities are referenced by their index in the snapshot
+// loading maps the file and builds components straight from the records, new entity ids are handed out as it goes
+namespace WorldSnapshot
+{
+    constexpr uint32_t Version = 2;
+
+    // the blocks in the order loading builds them, the hierarchy links are a second pass over the transform block
+    enum Stages
+    {
+        EntityStage = 0,
+        TransformStage,
+        HierarchyStage,
+        ColorStage,
+        ShapeStage,
+        AutoMoverStage,
+        LookAtStage,
+        CameraStage,
+        FlightDataStage,
+        OccluderStage,
+        StaticBatchStage,
+        StageCount
+    };
+
+    struct Stats
+    {
+        size_t Entities = 0;
+        size_t Components = 0;
+        size_t Bytes = 0;
+    };
+
+    // every entity that has a component type the snapshot knows about
+    // mesh and light components hold GPU resources and are not saved
+    bool Save(const char* fileName, Stats* stats = nullptr);
+
+    // only the listed entities, references to entities outside the list keep their original ids
+    // so a parent or look at target that still exists when loading is linked again
+    bool Save(const char* fileName, const std::vector<uint64_t>& entities, Stats* stats = nullptr);
+
+    // a mapped snapshot being turned into entities, the work can be split over several calls
+    class Loader
+    {
+    public:
+        // maps and validates the file, touches nothing in the world so it can run on any thread
+        bool Open(const char* fileName);
+        void Close();
+
+        inline bool IsOpen() const { return File.IsOpen(); }
+
+        size_t GetEntityCount() const;
+
+        // creates up to maxRecords entities and components on the main thread, true once everything is built
+        bool Instantiate(size_t maxRecords = size_t(-1));
+
+        inline bool IsDone() const { return Stage >= StageCount; }
+
+        // records Instantiate still has to build, the hierarchy pass counts the transforms a second time
+        size_t GetRemainingRecords() const;
+
+        // the new id of every saved entity in snapshot order, filled in by the first records Instantiate creates
+        inline const std::vector<uint64_t>& GetEntityIds() const { return EntityIds; }
+
+        inline const Stats& GetStats() const { return LoadStats; }
+
+    private:
+        MappedFile File;
+        const uint8_t* Blocks[StageCount] = { nullptr };
+        size_t Counts[StageCount] = { 0 };
+
+        int Stage = StageCount;
+        size_t Cursor = 0;
+
+        std::vector<uint64_t> EntityIds;
+        Stats LoadStats;
+
+        uint64_t MapEntity(int32_t index, uint64_t fallback) const;
+        void RunStage(size_t first, size_t count);
+    };
+
+    // Open and Instantiate in one go
+    bool Load(const char* fileName, Stats* stats = nullptr, std::vector<uint64_t>* entityIds = nullptr);
+}
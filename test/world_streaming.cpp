@@ -0,0 +1,409 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#include "world_streaming.h"
+
+#include "async_loader.h"
+#include "transform_component.h"
+#include "world_snapshot.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace WorldStreaming
+{
+    const char IndexMagic[4] = { 'R', 'C', 'E', 'L' };
+
+    struct IndexHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        float CellSize;
+        uint32_t CellCount;
+    };
+
+    struct CellCoord
+    {
+        int32_t X;
+        int32_t Y;
+    };
+
+    enum class CellState
+    {
+        Unloaded,
+        Opening,
+        Instantiating,
+        Loaded,
+        Unloading,
+    };
+
+    struct Cell
+    {
+        CellCoord Coord = { 0, 0 };
+        CellState State = CellState::Unloaded;
+
+        // shared with the worker that opens it
+        std::shared_ptr<WorldSnapshot::Loader> Loader;
+        AsyncLoader::RequestId Request = AsyncLoader::InvalidRequest;
+
+        // everything this cell created, in snapshot order
+        std::vector<uint64_t> Entities;
+    };
+
+    std::string BasePath;
+    float CellSize = 0;
+    int LoadRadius = DefaultLoadRadius;
+    int UnloadRadius = DefaultUnloadRadius;
+    size_t FrameBudget = DefaultFrameBudget;
+
+    // only the cells in the index, empty ones are never asked for
+    std::unordered_map<uint64_t, Cell> Cells;
+
+    // cells in any state but Unloaded
+    std::vector<uint64_t> ActiveCells;
+
+    Stats StreamStats;
+
+    inline uint64_t GetCellKey(int32_t x, int32_t y)
+    {
+        return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+    }
+
+    inline CellCoord GetCellCoord(const Vector3& position, float cellSize)
+    {
+        return CellCoord{ int32_t(floorf(position.x / cellSize)), int32_t(floorf(position.y / cellSize)) };
+    }
+
+    std::string GetIndexPath(const std::string& basePath)
+    {
+        return basePath + ".cells";
+    }
+
+    std::string GetCellPath(const std::string& basePath, const CellCoord& coord)
+    {
+        return basePath + "_" + std::to_string(coord.X) + "_" + std::to_string(coord.Y) + ".snapshot";
+    }
+
+    bool SaveCells(const char* basePath, float cellSize, const std::vector<uint64_t>& roots)
+    {
+        if (cellSize <= 0)
+            return false;
+
+        std::unordered_map<uint64_t, std::vector<uint64_t>> cellEntities;
+        std::vector<CellCoord> coords;
+
+        for (uint64_t root : roots)
+        {
+            TransformComponent* transform = ComponentManager::GetComponent<TransformComponent>(root);
+            if (transform == nullptr)
+                continue;
+
+            CellCoord coord = GetCellCoord(transform->GetWorldPosition(), cellSize);
+            std::vector<uint64_t>& entities = cellEntities[GetCellKey(coord.X, coord.Y)];
+            if (entities.empty())
+                coords.push_back(coord);
+
+            // parents ahead of their children, the order the cell is torn down in reverse
+            for (TransformComponent* node : transform->GetSubtree())
+                entities.push_back(node->EntityId);
+        }
+
+        for (const CellCoord& coord : coords)
+        {
+            if (!WorldSnapshot::Save(GetCellPath(basePath, coord).c_str(), cellEntities[GetCellKey(coord.X, coord.Y)]))
+                return false;
+        }
+
+        std::string indexPath = GetIndexPath(basePath);
+        FILE* file = fopen(indexPath.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        IndexHeader header;
+        memcpy(header.Magic, IndexMagic, sizeof(IndexMagic));
+        header.Version = Version;
+        header.CellSize = cellSize;
+        header.CellCount = uint32_t(coords.size());
+
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            (coords.empty() || fwrite(coords.data(), sizeof(CellCoord), coords.size(), file) == coords.size());
+
+        return fclose(file) == 0 && written;
+    }
+
+    bool Setup(const char* basePath)
+    {
+        Shutdown();
+
+        unsigned int size = 0;
+        unsigned char* data = LoadFileData(GetIndexPath(basePath).c_str(), &size);
+        if (data == nullptr)
+            return false;
+
+        IndexHeader header;
+        bool valid = size >= sizeof(header);
+        if (valid)
+        {
+            memcpy(&header, data, sizeof(header));
+            valid = memcmp(header.Magic, IndexMagic, sizeof(IndexMagic)) == 0 && header.Version == Version && header.CellSize > 0 &&
+                header.CellCount <= (size - sizeof(header)) / sizeof(CellCoord);
+        }
+
+        if (valid)
+        {
+            BasePath = basePath;
+            CellSize = header.CellSize;
+
+            for (uint32_t i = 0; i < header.CellCount; i++)
+            {
+                CellCoord coord;
+                memcpy(&coord, data + sizeof(header) + i * sizeof(CellCoord), sizeof(coord));
+
+                Cells[GetCellKey(coord.X, coord.Y)].Coord = coord;
+            }
+        }
+
+        UnloadFileData(data);
+
+        StreamStats = Stats();
+        StreamStats.Cells = Cells.size();
+        return valid;
+    }
+
+    void SetRadius(int loadRadius, int unloadRadius)
+    {
+        LoadRadius = std::max(0, loadRadius);
+
+        // a gap between the two keeps a camera on a cell border from loading and unloading the same cells every frame
+        UnloadRadius = std::max(LoadRadius + 1, unloadRadius);
+    }
+
+    void SetFrameBudget(size_t records)
+    {
+        FrameBudget = std::max<size_t>(1, records);
+    }
+
+    void DestroyEntities(const std::vector<uint64_t>& entities)
+    {
+        for (auto itr = entities.rbegin(); itr != entities.rend(); ++itr)
+        {
+            ComponentManager::RemoveEntity(*itr);
+            EntityManger::ReleaseEntity(*itr);
+        }
+    }
+
+    void RequestLoad(uint64_t key, Cell& cell)
+    {
+        std::string path = GetCellPath(BasePath, cell.Coord);
+        auto loader = std::make_shared<WorldSnapshot::Loader>();
+
+        cell.State = CellState::Opening;
+        cell.Loader = loader;
+        ActiveCells.push_back(key);
+
+        // mapping and validating the file is the only part that is safe off the main thread
+        cell.Request = AsyncLoader::LoadTask(path, [loader, path]() { return loader->Open(path.c_str()); },
+            [key](bool loaded)
+            {
+                auto itr = Cells.find(key);
+                if (itr == Cells.end() || itr->second.State != CellState::Opening)
+                    return;
+
+                Cell& cell = itr->second;
+                cell.Request = AsyncLoader::InvalidRequest;
+
+                if (loaded)
+                {
+                    cell.State = CellState::Instantiating;
+                }
+                else
+                {
+                    // counted as loaded and empty, so a broken file isn't retried every frame
+                    TraceLog(LOG_WARNING, "STREAMING: Could not open cell %d, %d", cell.Coord.X, cell.Coord.Y);
+                    cell.Loader.reset();
+                    cell.State = CellState::Loaded;
+                }
+            });
+    }
+
+    void RequestUnload(Cell& cell)
+    {
+        switch (cell.State)
+        {
+        case CellState::Opening:
+            // nothing exists in the world yet, the worker skips the open if it hasn't started it
+            AsyncLoader::Cancel(cell.Request);
+            cell.Request = AsyncLoader::InvalidRequest;
+            cell.Loader.reset();
+            cell.State = CellState::Unloaded;
+            break;
+
+        case CellState::Instantiating:
+            // tear down whatever part of it was built
+            cell.Entities = cell.Loader->GetEntityIds();
+            cell.Loader.reset();
+            cell.State = CellState::Unloading;
+            break;
+
+        case CellState::Loaded:
+            cell.State = CellState::Unloading;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    inline int GetCellDistance(const CellCoord& a, const CellCoord& b)
+    {
+        return std::max(abs(a.X - b.X), abs(a.Y - b.Y));
+    }
+
+    void Update(uint64_t cameraEntity)
+    {
+        StreamStats.FrameRecords = 0;
+
+        TransformComponent* camera = ComponentManager::GetComponent<TransformComponent>(cameraEntity);
+        if (Cells.empty() || camera == nullptr)
+            return;
+
+        CellCoord center = GetCellCoord(camera->GetWorldPosition(), CellSize);
+
+        for (uint64_t key : ActiveCells)
+        {
+            Cell& cell = Cells[key];
+            if (GetCellDistance(cell.Coord, center) > UnloadRadius)
+                RequestUnload(cell);
+        }
+
+        for (int32_t y = center.Y - LoadRadius; y <= center.Y + LoadRadius; y++)
+        {
+            for (int32_t x = center.X - LoadRadius; x <= center.X + LoadRadius; x++)
+            {
+                uint64_t key = GetCellKey(x, y);
+                auto itr = Cells.find(key);
+                if (itr != Cells.end() && itr->second.State == CellState::Unloaded)
+                    RequestLoad(key, itr->second);
+            }
+        }
+
+        // nearest cells first, so what is around the camera fills in before the edges
+        std::sort(ActiveCells.begin(), ActiveCells.end(), [center](uint64_t a, uint64_t b)
+            {
+                return GetCellDistance(Cells[a].Coord, center) < GetCellDistance(Cells[b].Coord, center);
+            });
+
+        // teardown goes ahead of building so memory is freed before more is taken
+        size_t budget = FrameBudget;
+        for (uint64_t key : ActiveCells)
+        {
+            Cell& cell = Cells[key];
+            if (cell.State != CellState::Unloading || budget == 0)
+                continue;
+
+            size_t count = std::min(budget, cell.Entities.size());
+            std::vector<uint64_t> batch(cell.Entities.end() - count, cell.Entities.end());
+            cell.Entities.resize(cell.Entities.size() - count);
+
+            DestroyEntities(batch);
+            budget -= count;
+
+            if (cell.Entities.empty())
+                cell.State = CellState::Unloaded;
+        }
+
+        for (uint64_t key : ActiveCells)
+        {
+            Cell& cell = Cells[key];
+            if (cell.State != CellState::Instantiating || budget == 0)
+                continue;
+
+            size_t remaining = cell.Loader->GetRemainingRecords();
+            cell.Loader->Instantiate(budget);
+            budget -= remaining - cell.Loader->GetRemainingRecords();
+
+            if (cell.Loader->IsDone())
+            {
+                cell.Entities = cell.Loader->GetEntityIds();
+                cell.Loader.reset();
+                cell.State = CellState::Loaded;
+            }
+        }
+
+        StreamStats.FrameRecords = FrameBudget - budget;
+
+        ActiveCells.erase(std::remove_if(ActiveCells.begin(), ActiveCells.end(), [](uint64_t key) { return Cells[key].State == CellState::Unloaded; }), ActiveCells.end());
+
+        StreamStats.LoadedCells = 0;
+        StreamStats.PendingCells = 0;
+        StreamStats.UnloadingCells = 0;
+        StreamStats.Entities = 0;
+        for (uint64_t key : ActiveCells)
+        {
+            const Cell& cell = Cells[key];
+            if (cell.State == CellState::Loaded)
+                StreamStats.LoadedCells++;
+            else if (cell.State == CellState::Unloading)
+                StreamStats.UnloadingCells++;
+            else
+                StreamStats.PendingCells++;
+
+            StreamStats.Entities += cell.Entities.size();
+        }
+    }
+
+    void Shutdown()
+    {
+        for (uint64_t key : ActiveCells)
+        {
+            Cell& cell = Cells[key];
+            RequestUnload(cell);
+
+            if (cell.State == CellState::Unloading)
+                DestroyEntities(cell.Entities);
+        }
+
+        ActiveCells.clear();
+        Cells.clear();
+        BasePath.clear();
+        CellSize = 0;
+        StreamStats = Stats();
+    }
+
+    const Stats& GetStats()
+    {
+        return StreamStats;
+    }
+}
@@ -0,0 +1,86 @@
+/**********************************************************************************************
+*
+*   raylib_ECS_sample * a sample Entity Component System using raylib
+*
+*   LICENSE: ZLIB
+*
+*   Copyright (c) 2021 Jeffery Myers
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy
+*   of this software and associated documentation files (the "Software"), to deal
+*   in the Software without restriction, including without limitation the rights
+*   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*   copies of the Software, and to permit persons to whom the Software is
+*   furnished to do so, subject to the following conditions:
+*
+*   The above copyright notice and this permission notice shall be included in all
+*   copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*   SOFTWARE.
+*
+**********************************************************************************************/
+
+
+#pragma once
+
+#include "entity.h"
+#include "components.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// splits the world into square cells on the ground plane, each saved as its own WorldSnapshot
+// cells near the camera are opened on loader threads and built a few records per frame, cells that fall behind are torn down the same way
+// loaded entities get fresh ids from the entity manager, so cells never collide with each other or with the rest of the world
+namespace WorldStreaming
+{
+    constexpr uint32_t Version = 1;
+
+    constexpr int DefaultLoadRadius = 2;
+    constexpr int DefaultUnloadRadius = 3;
+
+    // records built plus entities destroyed per Update
+    constexpr size_t DefaultFrameBudget = 2000;
+
+    struct Stats
+    {
+        size_t Cells = 0;
+        size_t LoadedCells = 0;
+        size_t PendingCells = 0;
+        size_t UnloadingCells = 0;
+        size_t Entities = 0;
+
+        // structural changes made by the last Update
+        size_t FrameRecords = 0;
+    };
+
+    // saves each root and everything parented under it into the cell its world position falls in
+    // writes basePath.cells as the index and basePath_x_y.snapshot per non empty cell
+    bool SaveCells(const char* basePath, float cellSize, const std::vector<uint64_t>& roots);
+
+    // reads the index, nothing is loaded until Update
+    bool Setup(const char* basePath);
+
+    // cancels pending loads and destroys everything that was streamed in
+    void Shutdown();
+
+    // cells within loadRadius of the camera's cell are loaded, cells beyond unloadRadius are unloaded
+    void SetRadius(int loadRadius, int unloadRadius);
+    void SetFrameBudget(size_t records);
+
+    // main thread, after AsyncLoader::Update so opened cells start building the same frame
+    void Update(uint64_t cameraEntity);
+
+    // removes every component of the entities and releases their ids
+    // goes last to first, so a list with parents ahead of their children (like a snapshot) tears down leaves first
+    void DestroyEntities(const std::vector<uint64_t>& entities);
+
+    const Stats& GetStats();
+}